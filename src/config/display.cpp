@@ -13,7 +13,10 @@
 
 namespace bd {
   DisplayConfig::DisplayConfig(QObject* parent)
-      : QObject(parent), m_preferences({.automatic_attach_outputs_relative_position = DisplayRelativePosition::none}), m_groups({}) {}
+      : QObject(parent), m_preferences({
+            .automatic_attach_outputs_relative_position = DisplayRelativePosition::none,
+            .automatic_mode_policy                      = ConfigurationModePolicy::Native,
+        }), m_groups({}) {}
 
   DisplayConfig& DisplayConfig::instance() {
     static DisplayConfig _instance(nullptr);
@@ -177,17 +180,18 @@ namespace bd {
 
     for (const auto& head : heads) {
       if (head->getIdentifier() == nullptr) continue;
-      auto head_mode_ptr = head->getCurrentMode();
 
-      if (!head_mode_ptr) {
+      // Rather than whatever the compositor happened to start the output in, which is often a lower refresh than the panel is capable of
+      auto head_mode = head->getBestMode(m_preferences.automatic_mode_policy);
+      if (!head_mode) head_mode = head->getCurrentMode();
+
+      if (!head_mode) {
         qWarning() << "Head " << head->getIdentifier() << " has no current mode, skipping.";
         continue;
       }
 
-      auto head_mode = head_mode_ptr.get();
-
-      auto mode_size_opt    = head_mode->getSize();
-      auto mode_refresh_opt = head_mode->getRefresh();
+      auto mode_size_opt    = head_mode.getSize();
+      auto mode_refresh_opt = head_mode.getRefresh();
       if (!mode_size_opt.has_value() || !mode_refresh_opt.has_value()) {
         qWarning() << "Head " << head->getIdentifier() << " has no size or refresh value set, skipping.";
         continue;
@@ -264,16 +268,7 @@ namespace bd {
 
       bool match = true;
       for (const auto& qIdentifier : group->getOutputIdentifiers()) {
-        bool found = false;
-        for (const auto& head : heads) {
-          if (head->getIdentifier() == nullptr) continue;
-          if (head->getIdentifier() == qIdentifier) {
-            found = true;
-            break;
-          }
-        }
-
-        if (!found) {
+        if (manager->getOutputHead(qIdentifier).isNull()) {
           match = false;
           break;
         }
@@ -310,6 +305,12 @@ namespace bd {
           auto pos                                                       = std::string_view {position.as_string()};
           this->m_preferences.automatic_attach_outputs_relative_position = DisplayConfigurationUtils::getDisplayRelativePositionFromString(pos);
         }
+
+        auto preferences = data.at("preferences");
+        if (preferences.contains("automatic_mode_policy") && preferences.at("automatic_mode_policy").is_string()) {
+          this->m_preferences.automatic_mode_policy =
+              DisplayConfigurationUtils::getModePolicyFromString(preferences.at("automatic_mode_policy").as_string());
+        }
       }
 
       for (const auto& group : toml::find<std::vector<toml::value>>(data, "group")) { this->m_groups.append(new DisplayGroup(group)); }
@@ -326,6 +327,7 @@ namespace bd {
     toml::ordered_value preferences_table(toml::ordered_table {});
     preferences_table["automatic_attach_outputs_relative_position"] =
         DisplayConfigurationUtils::getDisplayRelativePositionString(this->m_preferences.automatic_attach_outputs_relative_position);
+    preferences_table["automatic_mode_policy"] = DisplayConfigurationUtils::getModePolicyString(this->m_preferences.automatic_mode_policy);
 
     // Create our toml table for each group
     toml::ordered_value groups(toml::ordered_array {});
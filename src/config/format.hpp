@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include "displays/batch-system/enums.hpp"
+
 enum DisplayRelativePosition {
   none = 0,
   left,
@@ -15,5 +17,6 @@ enum DisplayRelativePosition {
 };
 
 struct DisplayGlobalPreferences {
-    DisplayRelativePosition automatic_attach_outputs_relative_position;
+    DisplayRelativePosition     automatic_attach_outputs_relative_position;
+    bd::ConfigurationModePolicy automatic_mode_policy;
 };
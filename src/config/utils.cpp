@@ -99,3 +99,20 @@ std::string bd::DisplayConfigurationUtils::getVerticalAnchorString(bd::Configura
       return "none";
   }
 }
+
+bd::ConfigurationModePolicy bd::DisplayConfigurationUtils::getModePolicyFromString(const std::string& str) {
+  if (str == "preferred") return bd::ConfigurationModePolicy::Preferred;
+  if (str == "highest_refresh") return bd::ConfigurationModePolicy::HighestRefresh;
+  return bd::ConfigurationModePolicy::Native;
+}
+
+std::string bd::DisplayConfigurationUtils::getModePolicyString(bd::ConfigurationModePolicy policy) {
+  switch (policy) {
+    case bd::ConfigurationModePolicy::Preferred:
+      return "preferred";
+    case bd::ConfigurationModePolicy::HighestRefresh:
+      return "highest_refresh";
+    default:
+      return "native";
+  }
+}
@@ -21,4 +21,7 @@ namespace bd::DisplayConfigurationUtils {
   std::string                   getHorizontalAnchorString(ConfigurationHorizontalAnchor anchor);
   ConfigurationVerticalAnchor   getVerticalAnchorFromString(const std::string& str);
   std::string                   getVerticalAnchorString(ConfigurationVerticalAnchor anchor);
+
+  ConfigurationModePolicy getModePolicyFromString(const std::string& str);
+  std::string             getModePolicyString(ConfigurationModePolicy policy);
 }
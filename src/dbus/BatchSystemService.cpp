@@ -75,6 +75,12 @@ namespace bd {
     return QVariantMap {};
   }
 
+  // GetFingerprint is cheap to call, clients can compare it with the "fingerprint" of their last CalculateConfiguration result and only
+  // calculate again when it differs
+  qulonglong BatchSystemService::GetFingerprint() {
+    return ConfigurationBatchSystem::instance().getFingerprint();
+  }
+
   bool BatchSystemService::ApplyConfiguration() {
     ConfigurationBatchSystem::instance().apply();
     // The result will be emitted via ConfigurationApplied signal
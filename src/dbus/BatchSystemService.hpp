@@ -25,6 +25,7 @@ namespace bd {
       void         SetOutputPrimary(const QString& serial);
       void         SetOutputMirrorOf(const QString& serial, const QString& mirrorSerial);
       QVariantMap  CalculateConfiguration();
+      qulonglong   GetFingerprint();
       bool         ApplyConfiguration();
       QVariantList GetActions();
 
@@ -25,28 +25,81 @@ namespace bd {
       qCritical() << "Failed to acquire DBus service name org.buddiesofbudgie.BudgieDaemon";
     }
 
+    registerOutputs();
+
+    if (!QDBusConnection::sessionBus().registerObject(DISPLAY_SERVICE_PATH, DisplayService::instance().GetAdaptor(), QDBusConnection::ExportAllContents)) {
+      qCritical() << "Failed to register DBus object at path" << DISPLAY_SERVICE_PATH;
+    }
+
+    if (!QDBusConnection::sessionBus().registerObject(
+            BATCH_SYSTEM_SERVICE_PATH, BatchSystemService::instance().GetAdaptor(), QDBusConnection::ExportAllContents)) {
+      qCritical() << "Failed to register DBus object at path" << BATCH_SYSTEM_SERVICE_PATH;
+    }
+  }
+
+  // onOutputsChanged exports any outputs (and their modes) that were connected after we first registered our objects
+  void DisplayObjectManager::onOutputsChanged() {
+    registerOutputs();
+  }
+
+  void DisplayObjectManager::registerOutputs() {
+    auto manager = WaylandOrchestrator::instance().getManager();
+    if (!manager) return;
+
+    // Stop exporting outputs that were disconnected (or forgotten and since replaced by a new head with the same identifier)
+    for (const auto& outputId : m_outputServices.keys()) {
+      auto output = manager->getOutputHead(outputId);
+      if (output.isNull() || output != m_outputServices.value(outputId)->getOutput()) unregisterOutput(outputId);
+    }
+
     for (const auto& output : manager->getHeads()) {
       if (!output) continue;
       QString outputId = output->getIdentifier();
-      if (m_outputServices.contains(outputId)) continue;
-      auto* outputService        = new OutputService(output, this);
-      m_outputServices[outputId] = outputService;
+      if (!m_outputServices.contains(outputId)) {
+        auto* outputService        = new OutputService(output, this);
+        m_outputServices[outputId] = outputService;
+
+        // The compositor finished one of this output's modes, stop exporting it. A mode with the same key advertised later gets a fresh service.
+        auto weak_output = output.toWeakRef();
+        connect(output.data(), &WaylandOutputMetaHead::modeRemoved, this, [this, weak_output](const QString& modeId) {
+          auto output = weak_output.toStrongRef();
+          if (!output) return;
+          auto* modeService = m_modeServices.take(output->getIdentifier() + ":" + modeId);
+          if (!modeService) return;
+          modeService->unregister();
+          modeService->deleteLater();
+        });
+      }
+
+      // Outputs we already export may have come back with modes we pruned when they were disconnected
       for (const auto& mode : output->getModes()) {
         if (!mode) continue;
-        QString modeKey = outputId + ":" + mode->getId();
+        QString modeKey = outputId + ":" + mode.getId();
         if (m_modeServices.contains(modeKey)) continue;
-        auto* modeService       = new OutputModeService(mode, outputId, this);
-        m_modeServices[modeKey] = modeService;
+        m_modeServices[modeKey] = new OutputModeService(mode, outputId, this);
       }
     }
+  }
 
-    if (!QDBusConnection::sessionBus().registerObject(DISPLAY_SERVICE_PATH, DisplayService::instance().GetAdaptor(), QDBusConnection::ExportAllContents)) {
-      qCritical() << "Failed to register DBus object at path" << DISPLAY_SERVICE_PATH;
-    }
+  // unregisterOutput stops exporting an output and all of its modes
+  void DisplayObjectManager::unregisterOutput(const QString& outputId) {
+    auto* outputService = m_outputServices.take(outputId);
+    if (!outputService) return;
 
-    if (!QDBusConnection::sessionBus().registerObject(
-            BATCH_SYSTEM_SERVICE_PATH, BatchSystemService::instance().GetAdaptor(), QDBusConnection::ExportAllContents)) {
-      qCritical() << "Failed to register DBus object at path" << BATCH_SYSTEM_SERVICE_PATH;
+    auto output = outputService->getOutput();
+    if (output) output->disconnect(this);
+    outputService->unregister();
+    outputService->deleteLater();
+
+    auto prefix = outputId + ":";
+    for (auto it = m_modeServices.begin(); it != m_modeServices.end();) {
+      if (!it.key().startsWith(prefix)) {
+        ++it;
+        continue;
+      }
+      it.value()->unregister();
+      it.value()->deleteLater();
+      it = m_modeServices.erase(it);
     }
   }
 
@@ -14,11 +14,15 @@ namespace bd {
 
     public slots:
       void onOutputManagerReady();
+      void onOutputsChanged();
 
     private:
       explicit DisplayObjectManager(QObject* parent = nullptr);
       Q_DISABLE_COPY(DisplayObjectManager)
 
+      void registerOutputs();
+      void unregisterOutput(const QString& outputId);
+
       QMap<QString, OutputService*>     m_outputServices;
       QMap<QString, OutputModeService*> m_modeServices;
   };
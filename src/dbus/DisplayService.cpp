@@ -1,5 +1,8 @@
 #include "DisplayService.hpp"
 
+#include <algorithm>
+#include <limits>
+
 #include "displays/batch-system/ConfigurationBatchSystem.hpp"
 #include "displays/output-manager/WaylandOutputManager.hpp"
 
@@ -13,53 +16,50 @@ namespace bd {
     return _instance;
   }
 
-  QStringList DisplayService::GetAvailableOutputs() {
-    auto outputs = QStringList {};
-    for (const auto& output : WaylandOrchestrator::instance().getManager()->getHeads()) { outputs.append(output->getIdentifier()); }
-    return outputs;
-  }
-
-  static QSharedPointer<WaylandOutputMetaHead> getPrimaryOrFirstHead() {
+  // Outputs are read from the manager's most recently published topology, so a single call never sees a half applied change
+  static std::shared_ptr<const WaylandOutputTopology> getTopology() {
     auto manager = WaylandOrchestrator::instance().getManager();
     if (!manager) return nullptr;
-    const auto heads = manager->getHeads();
-    if (heads.isEmpty()) return nullptr;
+    return manager->getTopology();
+  }
 
-    for (const auto& head : heads) {
-      if (head && head->isPrimary()) return head;
+  QStringList DisplayService::GetAvailableOutputs() {
+    auto outputs  = QStringList {};
+    auto topology = getTopology();
+    if (!topology) return outputs;
+    for (const auto& output : topology->getHeads()) {
+      if (output.available) outputs.append(output.identifier);
     }
-    return heads.first();
+    return outputs;
+  }
+
+  // GetGeneration returns the generation of the published topology, which goes up every time any output changes
+  qulonglong DisplayService::GetGeneration() {
+    auto topology = getTopology();
+    if (!topology) return 0;
+    return topology->getGeneration();
   }
 
   QString DisplayService::GetPrimaryOutput() {
-    auto head = getPrimaryOrFirstHead();
+    auto topology = getTopology();
+    if (!topology) return QString();
+    auto head = topology->getPrimaryOrFirstHead();
     if (!head) return QString();
-    return head->getIdentifier();
+    return head->identifier;
   }
 
   QVariantMap DisplayService::GetPrimaryOutputRect() {
     QVariantMap rect;
-    auto        head = getPrimaryOrFirstHead();
+    auto        topology = getTopology();
+    if (!topology) return rect;
+    auto head = topology->getPrimaryOrFirstHead();
     if (!head) return rect;
 
     // Populate QRect-like map similar to GetModeInfo pattern
-    int  x    = head->getPosition().x();
-    int  y    = head->getPosition().y();
-    int  w    = 0;
-    int  h    = 0;
-    auto mode = head->getCurrentMode();
-    if (mode) {
-      auto sizeOpt = mode->getSize();
-      if (sizeOpt.has_value()) {
-        w = sizeOpt->width();
-        h = sizeOpt->height();
-      }
-    }
-
-    rect["X"]      = x;
-    rect["Y"]      = y;
-    rect["Width"]  = w;
-    rect["Height"] = h;
+    rect["X"]      = head->position.x();
+    rect["Y"]      = head->position.y();
+    rect["Width"]  = head->size.width();
+    rect["Height"] = head->size.height();
     return rect;
   }
 
@@ -69,15 +69,34 @@ namespace bd {
     if (!calculationResult) return rect;
 
     auto globalSpace = calculationResult->getGlobalSpace();
-    if (!globalSpace) return rect;
-
-    rect["X"]      = globalSpace->x();
-    rect["Y"]      = globalSpace->y();
-    rect["Width"]  = globalSpace->width();
-    rect["Height"] = globalSpace->height();
+    rect["X"]      = globalSpace.x();
+    rect["Y"]      = globalSpace.y();
+    rect["Width"]  = globalSpace.width();
+    rect["Height"] = globalSpace.height();
     return rect;
   }
 
+  QString DisplayService::OutputAtPoint(int x, int y) {
+    auto topology = getTopology();
+    if (!topology) return QString();
+    auto head = topology->getHeadAt(QPoint {x, y});
+    if (!head) return QString();
+    return head->identifier;
+  }
+
+  // OutputsInRect returns nothing for a rect without an area. One reaching past the edge of the coordinate space is cut off there.
+  QStringList DisplayService::OutputsInRect(int x, int y, int width, int height) {
+    auto outputs  = QStringList {};
+    auto topology = getTopology();
+    if (!topology || width <= 0 || height <= 0) return outputs;
+
+    auto right  = std::min<qint64>(qint64 {x} + width - 1, std::numeric_limits<int>::max());
+    auto bottom = std::min<qint64>(qint64 {y} + height - 1, std::numeric_limits<int>::max());
+    auto rect   = QRect {QPoint {x, y}, QPoint {static_cast<int>(right), static_cast<int>(bottom)}};
+    for (const auto& head : topology->getHeadsIn(rect)) outputs.append(head->identifier);
+    return outputs;
+  }
+
   DisplaysAdaptor* DisplayService::GetAdaptor() {
     return m_adaptor;
   }
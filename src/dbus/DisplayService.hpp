@@ -16,9 +16,12 @@ namespace bd {
 
     public slots:
       QStringList GetAvailableOutputs();
+      qulonglong  GetGeneration();
       QVariantMap GetGlobalRect();
       QString     GetPrimaryOutput();
       QVariantMap GetPrimaryOutputRect();
+      QString     OutputAtPoint(int x, int y);
+      QStringList OutputsInRect(int x, int y, int width, int height);
 
     private:
       DisplaysAdaptor* m_adaptor;
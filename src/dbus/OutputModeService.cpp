@@ -3,61 +3,53 @@
 #include <QDBusConnection>
 #include <QString>
 
-#include "displays/output-manager/WaylandOutputManager.hpp"
-#include "displays/output-manager/head/WaylandOutputMetaHead.hpp"
 #include "displays/output-manager/mode/WaylandOutputMetaMode.hpp"
 
 namespace bd {
-  OutputModeService::OutputModeService(QSharedPointer<WaylandOutputMetaMode> mode, const QString& outputId, QObject* parent)
+  OutputModeService::OutputModeService(const WaylandOutputMetaMode& mode, const QString& outputId, QObject* parent)
       : QObject(parent), m_mode(mode), m_outputId(outputId) {
-    QString objectPath = QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1/Modes/%2").arg(outputId).arg(mode->getId());
-    m_adaptor          = new OutputModeAdaptor(this);
-    QDBusConnection::sessionBus().registerObject(objectPath, this, QDBusConnection::ExportAdaptors);
+    m_objectPath = QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1/Modes/%2").arg(outputId).arg(mode.getId());
+    m_adaptor    = new OutputModeAdaptor(this);
+    QDBusConnection::sessionBus().registerObject(m_objectPath, this, QDBusConnection::ExportAdaptors);
   }
 
   OutputModeService::~OutputModeService() {}
 
+  // unregister frees up our object path right away, rather than whenever this service ends up being deleted
+  void OutputModeService::unregister() {
+    QDBusConnection::sessionBus().unregisterObject(m_objectPath);
+  }
+
   int OutputModeService::Width() const {
-    auto size = m_mode->getSize();
+    auto size = m_mode.getSize();
     if (size) return size->width();
     return 0;
   }
   int OutputModeService::Height() const {
-    auto size = m_mode->getSize();
+    auto size = m_mode.getSize();
     if (size) return size->height();
     return 0;
   }
   qulonglong OutputModeService::RefreshRate() const {
-    auto refresh = m_mode->getRefresh();
-    if (refresh) return static_cast<qulonglong>(refresh.value());
-    return 0;
+    return m_mode.getRefresh().value_or(0);
   }
   bool OutputModeService::Preferred() const {
-    auto preferred = m_mode->isPreferred();
-    if (preferred) return preferred.value();
-    return false;
+    return m_mode.isPreferred();
   }
   bool OutputModeService::Current() const {
     return isCurrentMode();
   }
   bool OutputModeService::isCurrentMode() const {
-    auto head = qobject_cast<WaylandOutputMetaHead*>(m_mode->parent());
-    if (!head) return false;
-    auto currentMode = head->getCurrentMode();
-    if (!currentMode) return false;
-    // Compare pointer identity
-    return currentMode.data() == m_mode.data();
+    return m_mode.isCurrent();
   }
 
   QVariantMap OutputModeService::GetModeInfo() {
     QVariantMap info;
-    auto        size      = m_mode->getSize();
-    auto        refresh   = m_mode->getRefresh();
-    auto        preferred = m_mode->isPreferred();
+    auto        size      = m_mode.getSize();
     info["Width"]         = size ? size->width() : 0;
     info["Height"]        = size ? size->height() : 0;
-    info["RefreshRate"]   = refresh ? static_cast<qulonglong>(refresh.value()) : static_cast<qulonglong>(0);
-    info["Preferred"]     = preferred ? preferred.value() : false;
+    info["RefreshRate"]   = m_mode.getRefresh().value_or(0);
+    info["Preferred"]     = m_mode.isPreferred();
     info["Current"]       = Current();
     return info;
   }
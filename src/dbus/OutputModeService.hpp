@@ -1,5 +1,4 @@
 #pragma once
-#include <QSharedPointer>
 
 #include "displays/output-manager/mode/WaylandOutputMetaMode.hpp"
 #include "generated/OutputModeAdaptorGen.h"
@@ -13,7 +12,7 @@ namespace bd {
       Q_PROPERTY(bool Preferred READ Preferred)
       Q_PROPERTY(bool Current READ Current)
     public:
-      OutputModeService(QSharedPointer<WaylandOutputMetaMode> mode, const QString& outputId, QObject* parent = nullptr);
+      OutputModeService(const WaylandOutputMetaMode& mode, const QString& outputId, QObject* parent = nullptr);
       ~OutputModeService();
 
       // Property getters
@@ -26,10 +25,13 @@ namespace bd {
       // D-Bus methods
       Q_INVOKABLE QVariantMap GetModeInfo();
 
+      void unregister();
+
     private:
-      QSharedPointer<WaylandOutputMetaMode> m_mode;
-      OutputModeAdaptor*                    m_adaptor;
-      QString                               m_outputId;
-      bool                                  isCurrentMode() const;
+      WaylandOutputMetaMode m_mode;
+      OutputModeAdaptor*    m_adaptor;
+      QString               m_outputId;
+      QString               m_objectPath;
+      bool                  isCurrentMode() const;
   };
 }
@@ -3,53 +3,111 @@
 #include <QDBusConnection>
 #include <QString>
 
+#include "displays/output-manager/WaylandOutputManager.hpp"
+
 namespace bd {
-  OutputService::OutputService(QSharedPointer<WaylandOutputMetaHead> output, QObject* parent) : QObject(parent), m_output(output) {
-    QString objectPath = QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1").arg(output->getIdentifier());
+  OutputService::OutputService(QSharedPointer<WaylandOutputMetaHead> output, QObject* parent)
+      : QObject(parent), m_output(output), m_output_id(output->getOutputId()), m_identifier(output->getIdentifier()) {
+    QString objectPath = QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1").arg(m_identifier);
     m_adaptor          = new OutputAdaptor(this);
+    m_mode_path        = GetCurrentMode();
     QDBusConnection::sessionBus().registerObject(objectPath, this, QDBusConnection::ExportAdaptors);
+    // Queued, the topology we read from is only published once the whole transaction has been committed
+    connect(output.data(), &WaylandOutputMetaHead::stateCommitted, this, &OutputService::onStateCommitted, Qt::QueuedConnection);
   }
 
   OutputService::~OutputService() {}
 
+  QSharedPointer<WaylandOutputMetaHead> OutputService::getOutput() const {
+    return m_output;
+  }
+
+  // unregister frees up our object path right away, rather than whenever this service ends up being deleted
+  void OutputService::unregister() {
+    QDBusConnection::sessionBus().unregisterObject(QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1").arg(m_identifier));
+  }
+
+  // onStateCommitted notifies D-Bus clients once per compositor transaction, only for what that transaction actually changed
+  void OutputService::onStateCommitted(quint32 changed) {
+    auto has = [changed](WaylandOutputMetaHeadProperty property) { return (changed & (1u << property)) != 0; };
+
+    if (has(WaylandOutputMetaHeadProperty::Enabled)) emit EnabledChanged(Enabled());
+    if (has(WaylandOutputMetaHeadProperty::Position)) emit PositionChanged(X(), Y());
+    if (has(WaylandOutputMetaHeadProperty::Scale)) emit ScaleChanged(Scale());
+    if (has(WaylandOutputMetaHeadProperty::Transform)) emit TransformChanged(Transform());
+    if (has(WaylandOutputMetaHeadProperty::AdaptiveSync)) emit PropertyChanged("AdaptiveSync", QDBusVariant(AdaptiveSync()));
+    if (has(WaylandOutputMetaHeadProperty::Description)) emit PropertyChanged("Description", QDBusVariant(Description()));
+
+    if (has(WaylandOutputMetaHeadProperty::CurrentMode)) {
+      auto mode_path = GetCurrentMode();
+      if (mode_path != m_mode_path) {
+        emit ModeChanged(m_mode_path, mode_path);
+        m_mode_path = mode_path;
+      }
+    }
+  }
+
+  // snapshot is our head as of the most recently published topology. Properties are read from it rather than the live meta head so they are
+  // consistent with each other, and so they can be read from any thread.
+  std::shared_ptr<const WaylandOutputTopologyHead> OutputService::snapshot() const {
+    auto manager = WaylandOrchestrator::instance().getManager();
+    if (!manager) return nullptr;
+    return manager->getTopology()->getHead(m_output_id);
+  }
+
+  QString OutputService::modePath(const QString& mode_id) const {
+    if (mode_id.isEmpty()) return QString();
+    return QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1/Modes/%2").arg(m_identifier).arg(mode_id);
+  }
+
   uint OutputService::AdaptiveSync() const {
-    return static_cast<uint>(m_output->getAdaptiveSync());
+    auto head = snapshot();
+    return head ? static_cast<uint>(head->adaptive_sync) : 0;
   }
 
   QString OutputService::Description() const {
-    return m_output->getDescription();
+    auto head = snapshot();
+    return head ? head->description : QString();
   }
 
   bool OutputService::Enabled() const {
-    return m_output->isEnabled();
+    auto head = snapshot();
+    return head && head->enabled;
+  }
+
+  qulonglong OutputService::Generation() const {
+    auto head = snapshot();
+    return head ? head->generation : 0;
   }
 
   QStringList OutputService::GetAvailableModes() {
     QStringList modePaths;
-    for (const auto& mode : m_output->getModes()) {
-      modePaths << QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1/Modes/%2").arg(m_output->getIdentifier()).arg(mode->getId());
-    }
+    auto        head = snapshot();
+    if (!head) return modePaths;
+
+    modePaths.reserve(head->mode_ids.size());
+    for (const auto& mode_id : head->mode_ids) modePaths << modePath(mode_id);
     return modePaths;
   }
 
   QString OutputService::GetCurrentMode() {
-    auto mode = m_output->getCurrentMode();
-    if (mode) { return QString("/org/buddiesofbudgie/BudgieDaemon/Displays/Outputs/%1/Modes/%2").arg(m_output->getIdentifier()).arg(mode->getId()); }
-    return QString();
+    auto head = snapshot();
+    return head ? modePath(head->mode_id) : QString();
   }
 
   int OutputService::Height() const {
-    auto mode = m_output->getCurrentMode();
-    if (mode) return mode->getSize().value_or(QSize(0, 0)).height();
-    return 0;
+    auto head = snapshot();
+    return head ? head->size.height() : 0;
   }
 
   int OutputService::HorizontalAnchor() const {
-    return static_cast<int>(m_output->getHorizontalAnchor());
+    auto head = snapshot();
+    return static_cast<int>(head ? head->horizontal_anchor : ConfigurationHorizontalAnchor::NoHorizontalAnchor);
   }
 
   QString OutputService::Make() const {
-    return m_output->getMake();
+    auto head = snapshot();
+    return head ? head->make : QString();
   }
 
   QString OutputService::MirrorOf() const {
@@ -57,55 +115,63 @@ namespace bd {
   }
 
   QString OutputService::Model() const {
-    return m_output->getModel();
+    auto head = snapshot();
+    return head ? head->model : QString();
   }
 
   QString OutputService::Name() const {
-    return m_output->getName();
+    auto head = snapshot();
+    return head ? head->name : QString();
   }
 
   bool OutputService::Primary() const {
-    return m_output->isPrimary();
+    auto head = snapshot();
+    return head && head->primary;
   }
 
   qulonglong OutputService::RefreshRate() const {
-    auto mode = m_output->getCurrentMode();
-    if (mode) return static_cast<qulonglong>(mode->getRefresh().value_or(0.0));
-    return 0;
+    auto head = snapshot();
+    return head ? head->refresh : 0;
   }
 
   QString OutputService::RelativeTo() const {
-    return m_output->getRelativeOutput();
+    auto head = snapshot();
+    return head ? head->relative_output : QString();
   }
 
   double OutputService::Scale() const {
-    return m_output->getScale();
+    auto head = snapshot();
+    return head ? head->scale : 1.0;
   }
 
   QString OutputService::Serial() const {
-    return m_output->getIdentifier();
+    auto head = snapshot();
+    return head ? head->identifier : m_identifier;
   }
 
   quint8 OutputService::Transform() const {
-    return static_cast<quint8>(m_output->getTransform());
+    auto head = snapshot();
+    return head ? static_cast<quint8>(head->transform) : 0;
   }
 
   int OutputService::VerticalAnchor() const {
-    return static_cast<int>(m_output->getVerticalAnchor());
+    auto head = snapshot();
+    return static_cast<int>(head ? head->vertical_anchor : ConfigurationVerticalAnchor::NoVerticalAnchor);
   }
 
   int OutputService::Width() const {
-    auto mode = m_output->getCurrentMode();
-    if (mode) return mode->getSize().value_or(QSize(0, 0)).width();
-    return 0;
+    auto head = snapshot();
+    return head ? head->size.width() : 0;
   }
 
   int OutputService::X() const {
-    return m_output->getPosition().x();
+    auto head = snapshot();
+    return head ? head->position.x() : 0;
   }
 
   int OutputService::Y() const {
-    return m_output->getPosition().y();
+    auto head = snapshot();
+    return head ? head->position.y() : 0;
   }
 
 }  // namespace bd
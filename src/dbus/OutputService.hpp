@@ -2,6 +2,7 @@
 #include <QSharedPointer>
 
 #include "DisplaySchemaTypes.hpp"
+#include "displays/output-manager/WaylandOutputTopology.hpp"
 #include "displays/output-manager/head/WaylandOutputMetaHead.hpp"
 #include "generated/OutputAdaptorGen.h"
 
@@ -27,10 +28,14 @@ namespace bd {
       Q_PROPERTY(int HorizontalAnchor READ HorizontalAnchor)
       Q_PROPERTY(int VerticalAnchor READ VerticalAnchor)
       Q_PROPERTY(QString RelativeTo READ RelativeTo)
+      Q_PROPERTY(qulonglong Generation READ Generation)
     public:
       OutputService(QSharedPointer<WaylandOutputMetaHead> output, QObject* parent = nullptr);
       ~OutputService();
 
+      QSharedPointer<WaylandOutputMetaHead> getOutput() const;
+      void                                  unregister();
+
       // Property getters
       QString    Serial() const;
       QString    Name() const;
@@ -51,13 +56,32 @@ namespace bd {
       int        HorizontalAnchor() const;
       int        VerticalAnchor() const;
       QString    RelativeTo() const;
+      qulonglong Generation() const;
 
       // D-Bus methods
       Q_INVOKABLE QStringList GetAvailableModes();
       Q_INVOKABLE QString     GetCurrentMode();
 
+    signals:
+      // Relayed by OutputAdaptor, so these must match its signatures
+      void EnabledChanged(bool enabled);
+      void ModeChanged(const QString& oldModePath, const QString& newModePath);
+      void PositionChanged(int x, int y);
+      void PropertyChanged(const QString& property, const QDBusVariant& value);
+      void ScaleChanged(double scale);
+      void TransformChanged(uchar transform);
+
+    private slots:
+      void onStateCommitted(quint32 changed);
+
     private:
+      std::shared_ptr<const WaylandOutputTopologyHead> snapshot() const;
+      QString                                          modePath(const QString& mode_id) const;
+
       QSharedPointer<WaylandOutputMetaHead> m_output;
+      OutputId                              m_output_id;
+      QString                               m_identifier;
       OutputAdaptor*                        m_adaptor;
+      QString                               m_mode_path;
   };
 }
@@ -57,6 +57,14 @@ QVariantList BatchSystemAdaptor::GetActions()
     return actions;
 }
 
+qulonglong BatchSystemAdaptor::GetFingerprint()
+{
+    // handle method call org.buddiesofbudgie.BudgieDaemon.BatchSystem.GetFingerprint
+    qulonglong fingerprint{};
+    QMetaObject::invokeMethod(parent(), "GetFingerprint", Q_RETURN_ARG(qulonglong, fingerprint));
+    return fingerprint;
+}
+
 void BatchSystemAdaptor::ResetConfiguration()
 {
     // handle method call org.buddiesofbudgie.BudgieDaemon.BatchSystem.ResetConfiguration
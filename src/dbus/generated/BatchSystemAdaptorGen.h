@@ -66,6 +66,9 @@ class BatchSystemAdaptor: public QDBusAbstractAdaptor
 "      <annotation value=\"QVariantMap\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "      <arg direction=\"out\" type=\"a{sv}\" name=\"calculationResult\"/>\n"
 "    </method>\n"
+"    <method name=\"GetFingerprint\">\n"
+"      <arg direction=\"out\" type=\"t\" name=\"fingerprint\"/>\n"
+"    </method>\n"
 "    <method name=\"ApplyConfiguration\">\n"
 "      <arg direction=\"out\" type=\"b\" name=\"success\"/>\n"
 "    </method>\n"
@@ -87,6 +90,7 @@ public Q_SLOTS: // METHODS
     bool ApplyConfiguration();
     QVariantMap CalculateConfiguration();
     QVariantList GetActions();
+    qulonglong GetFingerprint();
     void ResetConfiguration();
     void SetOutputAdaptiveSync(const QString &serial, uint adaptiveSync);
     void SetOutputEnabled(const QString &serial, bool enabled);
@@ -41,6 +41,14 @@ QStringList DisplaysAdaptor::GetAvailableOutputs()
     return outputSerials;
 }
 
+qulonglong DisplaysAdaptor::GetGeneration()
+{
+    // handle method call org.buddiesofbudgie.BudgieDaemon.Displays.GetGeneration
+    qulonglong generation{};
+    QMetaObject::invokeMethod(parent(), "GetGeneration", Q_RETURN_ARG(qulonglong, generation));
+    return generation;
+}
+
 QVariantMap DisplaysAdaptor::GetGlobalRect()
 {
     // handle method call org.buddiesofbudgie.BudgieDaemon.Displays.GetGlobalRect
@@ -65,3 +73,19 @@ QVariantMap DisplaysAdaptor::GetPrimaryOutputRect()
     return rect;
 }
 
+QString DisplaysAdaptor::OutputAtPoint(int x, int y)
+{
+    // handle method call org.buddiesofbudgie.BudgieDaemon.Displays.OutputAtPoint
+    QString outputSerial{};
+    QMetaObject::invokeMethod(parent(), "OutputAtPoint", Q_RETURN_ARG(QString, outputSerial), Q_ARG(int, x), Q_ARG(int, y));
+    return outputSerial;
+}
+
+QStringList DisplaysAdaptor::OutputsInRect(int x, int y, int width, int height)
+{
+    // handle method call org.buddiesofbudgie.BudgieDaemon.Displays.OutputsInRect
+    QStringList outputSerials{};
+    QMetaObject::invokeMethod(parent(), "OutputsInRect", Q_RETURN_ARG(QStringList, outputSerials), Q_ARG(int, x), Q_ARG(int, y), Q_ARG(int, width), Q_ARG(int, height));
+    return outputSerials;
+}
+
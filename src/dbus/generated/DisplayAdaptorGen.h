@@ -37,10 +37,26 @@ class DisplaysAdaptor: public QDBusAbstractAdaptor
 "      <annotation value=\"QVariantMap\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "      <arg direction=\"out\" type=\"a{sv}\" name=\"rect\"/>\n"
 "    </method>\n"
+"    <method name=\"GetGeneration\">\n"
+"      <arg direction=\"out\" type=\"t\" name=\"generation\"/>\n"
+"    </method>\n"
 "    <method name=\"GetGlobalRect\">\n"
 "      <annotation value=\"QVariantMap\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "      <arg direction=\"out\" type=\"a{sv}\" name=\"rect\"/>\n"
 "    </method>\n"
+"    <method name=\"OutputAtPoint\">\n"
+"      <arg direction=\"in\" type=\"i\" name=\"x\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"y\"/>\n"
+"      <arg direction=\"out\" type=\"s\" name=\"outputSerial\"/>\n"
+"    </method>\n"
+"    <method name=\"OutputsInRect\">\n"
+"      <annotation value=\"QStringList\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"x\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"y\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"width\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"height\"/>\n"
+"      <arg direction=\"out\" type=\"as\" name=\"outputSerials\"/>\n"
+"    </method>\n"
 "  </interface>\n"
         "")
 public:
@@ -50,9 +66,12 @@ public:
 public: // PROPERTIES
 public Q_SLOTS: // METHODS
     QStringList GetAvailableOutputs();
+    qulonglong GetGeneration();
     QVariantMap GetGlobalRect();
     QString GetPrimaryOutput();
     QVariantMap GetPrimaryOutputRect();
+    QString OutputAtPoint(int x, int y);
+    QStringList OutputsInRect(int x, int y, int width, int height);
 Q_SIGNALS: // SIGNALS
 };
 
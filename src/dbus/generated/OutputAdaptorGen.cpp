@@ -51,6 +51,12 @@ bool OutputAdaptor::enabled() const
     return qvariant_cast< bool >(parent()->property("Enabled"));
 }
 
+qulonglong OutputAdaptor::generation() const
+{
+    // get the value of property Generation
+    return qvariant_cast< qulonglong >(parent()->property("Generation"));
+}
+
 int OutputAdaptor::height() const
 {
     // get the value of property Height
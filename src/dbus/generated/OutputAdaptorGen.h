@@ -45,6 +45,7 @@ class OutputAdaptor: public QDBusAbstractAdaptor
 "    <property access=\"read\" type=\"i\" name=\"HorizontalAnchor\"/>\n"
 "    <property access=\"read\" type=\"i\" name=\"VerticalAnchor\"/>\n"
 "    <property access=\"read\" type=\"s\" name=\"RelativeTo\"/>\n"
+"    <property access=\"read\" type=\"t\" name=\"Generation\"/>\n"
 "    <method name=\"GetAvailableModes\">\n"
 "      <annotation value=\"QStringList\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "      <arg direction=\"out\" type=\"as\" name=\"modePaths\"/>\n"
@@ -89,6 +90,9 @@ public: // PROPERTIES
     Q_PROPERTY(bool Enabled READ enabled)
     bool enabled() const;
 
+    Q_PROPERTY(qulonglong Generation READ generation)
+    qulonglong generation() const;
+
     Q_PROPERTY(int Height READ height)
     int height() const;
 
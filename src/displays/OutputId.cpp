@@ -0,0 +1,36 @@
+#include "OutputId.hpp"
+
+namespace bd {
+  OutputIdTable& OutputIdTable::instance() {
+    static OutputIdTable _instance;
+    return _instance;
+  }
+
+  // intern returns the id for an identifier, handing out the next one if we have not seen it before. Empty identifiers are never interned.
+  OutputId OutputIdTable::intern(const QString& identifier) {
+    if (identifier.isEmpty()) return OutputId::Invalid;
+
+    auto it = m_ids.constFind(identifier);
+    if (it != m_ids.constEnd()) return it.value();
+
+    m_identifiers.append(identifier);
+    auto id = static_cast<OutputId>(m_identifiers.size());
+    m_ids.insert(identifier, id);
+    return id;
+  }
+
+  // find returns the id for an identifier we have already interned, without interning it
+  OutputId OutputIdTable::find(const QString& identifier) const {
+    return m_ids.value(identifier, OutputId::Invalid);
+  }
+
+  QString OutputIdTable::identifier(OutputId id) const {
+    auto index = static_cast<qsizetype>(id) - 1;
+    if (index < 0 || index >= m_identifiers.size()) return QString();
+    return m_identifiers.at(index);
+  }
+
+  QDebug operator<<(QDebug debug, OutputId id) {
+    return debug << OutputIdTable::instance().identifier(id);
+  }
+}
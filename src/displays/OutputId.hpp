@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QDebug>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+namespace bd {
+  // OutputId is a small integer standing in for an output identifier. Ids are handed out by OutputIdTable and stay the same for the lifetime of
+  // the daemon, so they can key maps and sets internally while identifier strings are only produced for config files and D-Bus.
+  // Only outputs that have been connected are interned, identifiers from clients are looked up with find. Only used from the main thread.
+  enum class OutputId : quint32 { Invalid = 0 };
+
+  inline size_t qHash(OutputId id, size_t seed = 0) {
+    return ::qHash(static_cast<quint32>(id), seed);
+  }
+
+  class OutputIdTable {
+    public:
+      static OutputIdTable& instance();
+
+      OutputId intern(const QString& identifier);
+      OutputId find(const QString& identifier) const;
+      QString  identifier(OutputId id) const;
+
+    private:
+      OutputIdTable() = default;
+      Q_DISABLE_COPY(OutputIdTable)
+
+      QHash<QString, OutputId> m_ids;
+      QList<QString>           m_identifiers;  // Indexed by id - 1
+  };
+
+  QDebug operator<<(QDebug debug, OutputId id);
+}
@@ -1,55 +1,93 @@
 #include "CalculationResult.hpp"
+#include "ConfigurationLayout.hpp"
 #include <QVariantMap>
 #include <QVariant>
+#include <QStringList>
 
 namespace bd {
-    CalculationResult::CalculationResult(QObject *parent) : QObject(parent),
-        m_global_space(QSharedPointer<QRect>(new QRect(0, 0, 0, 0))),
-        m_output_states(QMap<QString, QSharedPointer<OutputTargetState>>()) {
+    CalculationResult::CalculationResult(const ConfigurationLayout *layout, QObject *parent) : QObject(parent), m_layout(layout) {
     }
 
-    QSharedPointer<QRect> CalculationResult::getGlobalSpace() const {
-        return m_global_space;
+    QRect CalculationResult::getGlobalSpace() const {
+        return m_layout->getGlobalSpace();
     }
 
-    QMap<QString, QSharedPointer<OutputTargetState>> CalculationResult::getOutputStates() const {
-        return m_output_states;
+    const QList<OutputTargetState> &CalculationResult::getOutputStates() const {
+        return m_layout->getOutputStates();
     }
 
-    void CalculationResult::setOutputState(QString serial, QSharedPointer<OutputTargetState> output_state) {
-        m_output_states.insert(serial, output_state);
+    const OutputTargetState *CalculationResult::getOutputState(OutputId output_id) const {
+        return m_layout->getOutputState(output_id);
+    }
+
+    const QList<CalculationError> &CalculationResult::getErrors() const {
+        return m_layout->getErrors();
+    }
+
+    bool CalculationResult::hasErrors() const {
+        return !m_layout->getErrors().isEmpty();
+    }
+
+    quint64 CalculationResult::getFingerprint() const {
+        return m_fingerprint;
+    }
+
+    void CalculationResult::setFingerprint(quint64 fingerprint) {
+        m_fingerprint = fingerprint;
     }
 
     QVariantMap CalculationResult::toVariantMap() const {
         QVariantMap map;
         // Serialize globalSpace
-        if (m_global_space) {
-            QVariantMap gs;
-            gs["x"] = m_global_space->x();
-            gs["y"] = m_global_space->y();
-            gs["width"] = m_global_space->width();
-            gs["height"] = m_global_space->height();
-            map["globalSpace"] = gs;
-        }
+        auto globalSpace = getGlobalSpace();
+        QVariantMap gs;
+        gs["x"] = globalSpace.x();
+        gs["y"] = globalSpace.y();
+        gs["width"] = globalSpace.width();
+        gs["height"] = globalSpace.height();
+        map["globalSpace"] = gs;
         // Serialize outputs
         QVariantMap outputs;
-        for (auto it = m_output_states.begin(); it != m_output_states.end(); ++it) {
+        for (const auto &state : getOutputStates()) {
             QVariantMap out;
-            auto state = it.value();
-            out["on"] = state->isOn();
-            out["dimensions"] = QVariant::fromValue(state->getDimensions());
-            out["refresh"] = state->getRefresh();
-            out["horizontalAnchor"] = static_cast<int>(state->getHorizontalAnchor());
-            out["verticalAnchor"] = static_cast<int>(state->getVerticalAnchor());
-            out["position"] = QVariant::fromValue(state->getPosition());
-            out["primary"] = state->isPrimary();
-            out["scale"] = state->getScale();
-            out["transform"] = state->getTransform();
-            out["resultingDimensions"] = QVariant::fromValue(state->getResultingDimensions());
-            out["adaptiveSync"] = state->getAdaptiveSync();
-            outputs[it.key()] = out;
+            out["on"] = state.isOn();
+            out["dimensions"] = QVariant::fromValue(state.getDimensions());
+            out["refresh"] = state.getRefresh();
+            out["horizontalAnchor"] = static_cast<int>(state.getHorizontalAnchor());
+            out["verticalAnchor"] = static_cast<int>(state.getVerticalAnchor());
+            out["position"] = QVariant::fromValue(state.getPosition());
+            out["primary"] = state.isPrimary();
+            out["scale"] = state.getScale();
+            out["transform"] = state.getTransform();
+            out["resultingDimensions"] = QVariant::fromValue(state.getResultingDimensions());
+            out["adaptiveSync"] = state.getAdaptiveSync();
+            outputs[state.getSerial()] = out;
         }
         map["outputs"] = outputs;
+
+        // Serialize errors
+        auto toIdentifiers = [](const QList<OutputId> &output_ids) {
+            QStringList identifiers;
+            for (auto output_id : output_ids) identifiers.append(OutputIdTable::instance().identifier(output_id));
+            return identifiers;
+        };
+        QVariantList errors;
+        for (const auto &error : getErrors()) {
+            QVariantMap err;
+            switch (error.type) {
+                case CalculationError::Type::AnchorCycle:
+                    err["type"] = QString("AnchorCycle");
+                    break;
+                case CalculationError::Type::PlacementCycle:
+                    err["type"] = QString("PlacementCycle");
+                    break;
+            }
+            err["outputs"] = toIdentifiers(error.outputs);
+            err["dependents"] = toIdentifiers(error.dependents);
+            errors.append(err);
+        }
+        map["errors"] = errors;
+        map["fingerprint"] = QVariant::fromValue(m_fingerprint);
         return map;
     }
 }
\ No newline at end of file
@@ -1,26 +1,48 @@
 #pragma once
 
 #include <QObject>
-#include <QSharedPointer>
-#include <QMap>
+#include <QList>
 #include <QRect>
 #include "OutputTargetState.hpp"
 
 namespace bd {
+    // CalculationError is a problem found while calculating a configuration, along with the outputs involved
+    struct CalculationError {
+        enum class Type {
+            AnchorCycle, // outputs are anchored to one another in a loop, so none of them can be placed relative to the others
+            PlacementCycle, // outputs are anchored to and mirror one another in a loop, so they are left where their heads are
+        };
+
+        Type type;
+        QList<OutputId> outputs; // The outputs making up the cycle
+        QList<OutputId> dependents; // Outputs anchored (directly or not) to the cycle, which couldn't be placed either
+
+        bool operator==(const CalculationError &) const = default;
+    };
+
+    class ConfigurationLayout;
+
+    // CalculationResult is a read-only view over the layout a calculation produced, rather than a copy of it. It always reflects the most recent
+    // calculation, and must not outlive the layout.
     class CalculationResult : public QObject {
         Q_OBJECT
 
     public:
-        CalculationResult(QObject *parent = nullptr);
+        CalculationResult(const ConfigurationLayout *layout, QObject *parent = nullptr);
 
-        QSharedPointer<QRect> getGlobalSpace() const;
-        QMap<QString, QSharedPointer<OutputTargetState>> getOutputStates() const;
+        QRect getGlobalSpace() const;
+        // getOutputStates returns the state of every output, ordered by OutputId
+        const QList<OutputTargetState> &getOutputStates() const;
+        const OutputTargetState *getOutputState(OutputId output_id) const;
+        const QList<CalculationError> &getErrors() const;
+        quint64 getFingerprint() const;
+        bool hasErrors() const;
         QVariantMap toVariantMap() const;
 
-        void setOutputState(QString serial, QSharedPointer<OutputTargetState> output_state);
+        void setFingerprint(quint64 fingerprint);
 
     private:
-        QSharedPointer<QRect> m_global_space;
-        QMap<QString, QSharedPointer<OutputTargetState>> m_output_states;
+        const ConfigurationLayout *m_layout;
+        quint64 m_fingerprint = 0;
     };
 }
\ No newline at end of file
@@ -1,35 +1,54 @@
 #include "ConfigurationAction.hpp"
 #include <qdebug.h>
+#include <QHashFunctions>
 #include "utils.hpp"
 
 namespace bd {
-    ConfigurationAction::ConfigurationAction(ConfigurationActionType action_type, QString serial, QObject *parent) : QObject(parent), m_action_type(action_type), m_serial(QString {serial}),
-        m_on(false), m_dimensions(QSize()), m_refresh(0), m_horizontal_anchor(ConfigurationHorizontalAnchor::NoHorizontalAnchor),
+    ConfigurationAction::ConfigurationAction(ConfigurationActionType action_type, OutputId output_id, QObject *parent) : QObject(parent), m_action_type(action_type),
+        m_output_id(output_id), m_on(false), m_relative(OutputId::Invalid), m_dimensions(QSize()), m_refresh(0), m_horizontal_anchor(ConfigurationHorizontalAnchor::NoHorizontalAnchor),
         m_vertical_anchor(ConfigurationVerticalAnchor::NoVerticalAnchor), m_scale(1.0), m_transform(0), m_adaptive_sync(0), m_primary(false) {
     }
 
+    // create makes an action for the output identified by serial, or returns null if no such output has ever been connected. Identifiers come
+    // from D-Bus clients and config files, so they are only looked up: interning them would let a client grow the id table without bound.
+    QSharedPointer<ConfigurationAction> ConfigurationAction::create(ConfigurationActionType action_type, const QString &serial, QObject *parent) {
+        auto output_id = OutputIdTable::instance().find(serial);
+        if (output_id == OutputId::Invalid) {
+            qWarning() << "Ignoring action for unknown output" << serial;
+            return nullptr;
+        }
+        return QSharedPointer<ConfigurationAction>(new ConfigurationAction(action_type, output_id, parent));
+    }
+
     QSharedPointer<ConfigurationAction> ConfigurationAction::explicitOn(const QString& serial, QObject *parent) {
         qDebug() << "ConfigurationAction::explicitOn" << serial;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetOnOff, serial, parent));
+        auto action = create(ConfigurationActionType::SetOnOff, serial, parent);
+        if (action.isNull()) return action;
         action->m_on = true;
         return action;
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::explicitOff(const QString& serial, QObject *parent) {
         qDebug() << "ConfigurationAction::explicitOff" << serial;
-        return QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetOnOff, serial, parent));
+        return create(ConfigurationActionType::SetOnOff, serial, parent);
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::mirrorOf(const QString& serial, QString relative, QObject *parent) {
         qDebug() << "ConfigurationAction::mirrorOf" << serial << relative;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetMirrorOf, serial, parent));
-        action->m_relative = QString { relative };
+        auto action = create(ConfigurationActionType::SetMirrorOf, serial, parent);
+        if (action.isNull()) return action;
+        action->m_relative = OutputIdTable::instance().find(relative);
+        if (action->m_relative == OutputId::Invalid) {
+            qWarning() << "Ignoring action for output" << serial << "relative to unknown output" << relative;
+            return nullptr;
+        }
         return action;
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::mode(const QString& serial, QSize dimensions, qulonglong refresh, QObject *parent) {
         qDebug() << "ConfigurationAction::mode" << serial << dimensions << refresh;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetMode, serial, parent));
+        auto action = create(ConfigurationActionType::SetMode, serial, parent);
+        if (action.isNull()) return action;
         action->m_dimensions = QSize {dimensions};
         action->m_refresh = refresh;
         return action;
@@ -38,8 +57,13 @@ namespace bd {
     QSharedPointer<ConfigurationAction> ConfigurationAction::setPositionAnchor(const QString& serial, QString relative, ConfigurationHorizontalAnchor horizontal,
                                                                                  ConfigurationVerticalAnchor vertical, QObject *parent) {
         qDebug() << "ConfigurationAction::setPositionAnchor" << serial << relative << bd::DisplayConfigurationUtils::getHorizontalAnchorString(horizontal) << bd::DisplayConfigurationUtils::getVerticalAnchorString(vertical);
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetPositionAnchor, serial, parent));
-        action->m_relative = QString { relative };
+        auto action = create(ConfigurationActionType::SetPositionAnchor, serial, parent);
+        if (action.isNull()) return action;
+        action->m_relative = OutputIdTable::instance().find(relative);
+        if (action->m_relative == OutputId::Invalid) {
+            qWarning() << "Ignoring action for output" << serial << "relative to unknown output" << relative;
+            return nullptr;
+        }
         action->m_horizontal_anchor = horizontal;
         action->m_vertical_anchor = vertical;
         return action;
@@ -47,28 +71,32 @@ namespace bd {
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::scale(const QString& serial, qreal scale, QObject *parent) {
         qDebug() << "ConfigurationAction::scale" << serial << scale;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetScale, serial, parent));
+        auto action = create(ConfigurationActionType::SetScale, serial, parent);
+        if (action.isNull()) return action;
         action->m_scale = scale;
         return action;
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::transform(const QString& serial, quint8 transform, QObject *parent) {
         qDebug() << "ConfigurationAction::transform" << serial << transform;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetTransform, serial, parent));
+        auto action = create(ConfigurationActionType::SetTransform, serial, parent);
+        if (action.isNull()) return action;
         action->m_transform = transform;
         return action;
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::adaptiveSync(const QString& serial, uint32_t adaptiveSync, QObject *parent) {
         qDebug() << "ConfigurationAction::adaptiveSync" << serial << adaptiveSync;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetAdaptiveSync, serial, parent));
+        auto action = create(ConfigurationActionType::SetAdaptiveSync, serial, parent);
+        if (action.isNull()) return action;
         action->m_adaptive_sync = adaptiveSync;
         return action;
     }
 
     QSharedPointer<ConfigurationAction> ConfigurationAction::primary(const QString& serial, QObject *parent) {
         qDebug() << "ConfigurationAction::primary" << serial;
-        auto action = QSharedPointer<ConfigurationAction>(new ConfigurationAction(ConfigurationActionType::SetPrimary, serial, parent));
+        auto action = create(ConfigurationActionType::SetPrimary, serial, parent);
+        if (action.isNull()) return action;
         action->m_primary = true;
         return action;
     }
@@ -77,8 +105,12 @@ namespace bd {
         return m_action_type;
     }
 
+    OutputId ConfigurationAction::getOutputId() const {
+        return m_output_id;
+    }
+
     QString ConfigurationAction::getSerial() const {
-        return m_serial;
+        return OutputIdTable::instance().identifier(m_output_id);
     }
 
     bool ConfigurationAction::isOn() const {
@@ -89,10 +121,14 @@ namespace bd {
         return m_primary;
     }
 
-    QString ConfigurationAction::getRelative() const {
+    OutputId ConfigurationAction::getRelativeOutputId() const {
         return m_relative;
     }
 
+    QString ConfigurationAction::getRelative() const {
+        return OutputIdTable::instance().identifier(m_relative);
+    }
+
     QSize ConfigurationAction::getDimensions() const {
         return m_dimensions;
     }
@@ -120,4 +156,19 @@ namespace bd {
     uint32_t ConfigurationAction::getAdaptiveSync() const {
         return m_adaptive_sync;
     }
+
+    bool ConfigurationAction::isSameAs(const ConfigurationAction &other) const {
+        return m_action_type == other.m_action_type && m_output_id == other.m_output_id && m_on == other.m_on && m_relative == other.m_relative &&
+               m_dimensions == other.m_dimensions && m_refresh == other.m_refresh && m_horizontal_anchor == other.m_horizontal_anchor &&
+               m_vertical_anchor == other.m_vertical_anchor && m_scale == other.m_scale && m_transform == other.m_transform &&
+               m_adaptive_sync == other.m_adaptive_sync && m_primary == other.m_primary;
+    }
+
+    size_t qHash(const ConfigurationAction &action, size_t seed) {
+        auto dimensions = action.getDimensions();
+        return qHashMulti(seed, static_cast<int>(action.getActionType()), action.getOutputId(), action.isOn(), action.getRelativeOutputId(),
+                          dimensions.width(), dimensions.height(), action.getRefresh(), static_cast<int>(action.getHorizontalAnchor()),
+                          static_cast<int>(action.getVerticalAnchor()), action.getScale(), action.getTransform(), action.getAdaptiveSync(),
+                          action.isPrimary());
+    }
 }
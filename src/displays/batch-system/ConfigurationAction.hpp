@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QSize>
 #include <QSharedPointer>
+#include "displays/OutputId.hpp"
 #include "enums.hpp"
 
 namespace bd {
@@ -11,6 +12,7 @@ namespace bd {
         Q_OBJECT
 
     public:
+        // Every factory returns null for an output (or relative) that has never been connected
         static QSharedPointer<ConfigurationAction> explicitOn(const QString& serial, QObject *parent = nullptr);
         static QSharedPointer<ConfigurationAction> explicitOff(const QString& serial, QObject *parent = nullptr);
 
@@ -31,9 +33,11 @@ namespace bd {
         static QSharedPointer<ConfigurationAction> primary(const QString& serial, QObject *parent = nullptr);
 
         ConfigurationActionType getActionType() const;
+        OutputId getOutputId() const;
         QString getSerial() const;
         bool isOn() const;
         bool isPrimary() const;
+        OutputId getRelativeOutputId() const;
         QString getRelative() const;
         QSize getDimensions() const;
         qulonglong getRefresh() const;
@@ -43,19 +47,24 @@ namespace bd {
         quint8 getTransform() const;
         uint32_t getAdaptiveSync() const;
 
+        // isSameAs is whether other does exactly what we do, to the same output. Actions never change once made, so this holds for good.
+        bool isSameAs(const ConfigurationAction &other) const;
+
     protected:
-        explicit ConfigurationAction(ConfigurationActionType action_type, QString serial,
+        explicit ConfigurationAction(ConfigurationActionType action_type, OutputId output_id,
                                      QObject *parent = nullptr);
 
+        static QSharedPointer<ConfigurationAction> create(ConfigurationActionType action_type, const QString &serial, QObject *parent);
+
     private:
         ConfigurationActionType m_action_type;
-        QString m_serial;
+        OutputId m_output_id;
 
         // Explicit On/Off (otherwise uses whatever current state of WaylandOutputMetaHead is)
         bool m_on;
 
         // Shared by mirrorOf and setAnchorTo
-        QString m_relative;
+        OutputId m_relative;
 
         // Mode
         QSize m_dimensions;
@@ -78,4 +87,7 @@ namespace bd {
         bool m_primary;
     };
 
+    // qHash hashes what action does rather than its identity, so two actions that are isSameAs one another hash the same
+    size_t qHash(const ConfigurationAction &action, size_t seed = 0);
+
 } // bd
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "ConfigurationActionStore.hpp"
+
+#include <algorithm>
+
+namespace bd {
+    void ConfigurationActionStore::insert(const QSharedPointer<ConfigurationAction> &action) {
+        if (action.isNull()) return;
+
+        remove(action->getOutputId(), action->getActionType());
+        m_index.insert(keyFor(action->getOutputId(), action->getActionType()), m_slots.size());
+        m_slots.append(action);
+    }
+
+    QSharedPointer<ConfigurationAction> ConfigurationActionStore::find(OutputId output_id, ConfigurationActionType action_type) const {
+        auto it = m_index.constFind(keyFor(output_id, action_type));
+        if (it == m_index.constEnd()) return nullptr;
+        return m_slots.at(it.value());
+    }
+
+    bool ConfigurationActionStore::remove(OutputId output_id, ConfigurationActionType action_type) {
+        auto it = m_index.find(keyFor(output_id, action_type));
+        if (it == m_index.end()) return false;
+
+        m_slots[it.value()].clear();
+        m_index.erase(it);
+        m_holes++;
+        if (m_holes > m_index.size()) compact();
+        return true;
+    }
+
+    // removeOutput drops every action for output_id, there are only as many of those as there are action types
+    void ConfigurationActionStore::removeOutput(OutputId output_id) {
+        for (auto action_type: ActionTypes) remove(output_id, action_type);
+    }
+
+    QList<QSharedPointer<ConfigurationAction>> ConfigurationActionStore::actions() const {
+        if (m_holes == 0) return m_slots;
+
+        auto actions = QList<QSharedPointer<ConfigurationAction>>();
+        actions.reserve(m_index.size());
+        for (const auto &action: m_slots) {
+            if (!action.isNull()) actions.append(action);
+        }
+        return actions;
+    }
+
+    void ConfigurationActionStore::copyTo(QList<QSharedPointer<ConfigurationAction>> &actions) const {
+        actions.clear();
+        for (const auto &action: m_slots) {
+            if (!action.isNull()) actions.append(action);
+        }
+    }
+
+    bool ConfigurationActionStore::isEmpty() const {
+        return m_index.isEmpty();
+    }
+
+    qsizetype ConfigurationActionStore::size() const {
+        return m_index.size();
+    }
+
+    void ConfigurationActionStore::clear() {
+        m_slots.clear();
+        m_index.clear();
+        m_holes = 0;
+    }
+
+    quint64 ConfigurationActionStore::keyFor(OutputId output_id, ConfigurationActionType action_type) {
+        return (quint64{static_cast<quint32>(output_id)} << 8) | static_cast<quint8>(action_type);
+    }
+
+    // compact closes up the holes left by removed actions, keeping the order of those that remain
+    void ConfigurationActionStore::compact() {
+        m_slots.removeIf([](const QSharedPointer<ConfigurationAction> &action) { return action.isNull(); });
+        m_holes = 0;
+
+        for (qsizetype slot = 0; slot < m_slots.size(); ++slot) {
+            const auto &action = m_slots.at(slot);
+            m_index.insert(keyFor(action->getOutputId(), action->getActionType()), slot);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <algorithm>
+#include <array>
+#include "ConfigurationAction.hpp"
+
+namespace bd {
+    // ConfigurationActionStore holds at most one action per (output, action type), in the order they were last set. Actions live in slots
+    // indexed by their key, so replacing or removing one never scans the others. Removed actions leave a hole behind that is compacted once
+    // holes outnumber actions.
+    class ConfigurationActionStore {
+    public:
+        // insert stores action, replacing (and moving to the back) any action of the same type for the same output
+        void insert(const QSharedPointer<ConfigurationAction> &action);
+
+        QSharedPointer<ConfigurationAction> find(OutputId output_id, ConfigurationActionType action_type) const;
+        bool remove(OutputId output_id, ConfigurationActionType action_type);
+        void removeOutput(OutputId output_id);
+
+        // actions returns every action in the order they were set
+        QList<QSharedPointer<ConfigurationAction>> actions() const;
+        // copyTo replaces what is in actions with every action in the order they were set. It reuses the list's storage, so it doesn't allocate
+        // once the list has held as many actions before.
+        void copyTo(QList<QSharedPointer<ConfigurationAction>> &actions) const;
+        // forEach calls visit with every action in the order they were set, without allocating
+        template <typename Visitor>
+        void forEach(Visitor &&visit) const {
+            for (const auto &action: m_slots) {
+                if (!action.isNull()) visit(*action);
+            }
+        }
+        // forEachFor calls visit with each action for output_id in the order they were set, without allocating
+        template <typename Visitor>
+        void forEachFor(OutputId output_id, Visitor &&visit) const {
+            auto positions = std::array<qsizetype, ActionTypes.size()>();
+            auto count = size_t{0};
+            for (auto action_type: ActionTypes) {
+                auto it = m_index.constFind(keyFor(output_id, action_type));
+                if (it != m_index.constEnd()) positions[count++] = it.value();
+            }
+            std::sort(positions.begin(), positions.begin() + count);
+            for (size_t i = 0; i < count; ++i) visit(*m_slots.at(positions[i]));
+        }
+        bool isEmpty() const;
+        qsizetype size() const;
+
+        void clear();
+
+    private:
+        static constexpr std::array<ConfigurationActionType, 9> ActionTypes = {
+            ConfigurationActionType::SetAdaptiveSync, ConfigurationActionType::SetGamma, ConfigurationActionType::SetMirrorOf,
+            ConfigurationActionType::SetMode, ConfigurationActionType::SetOnOff, ConfigurationActionType::SetPrimary,
+            ConfigurationActionType::SetPositionAnchor, ConfigurationActionType::SetScale, ConfigurationActionType::SetTransform,
+        };
+
+        static quint64 keyFor(OutputId output_id, ConfigurationActionType action_type);
+
+        void compact();
+
+        QList<QSharedPointer<ConfigurationAction>> m_slots;
+        QHash<quint64, qsizetype> m_index;
+        qsizetype m_holes = 0;
+    };
+}
@@ -9,7 +9,9 @@
 namespace bd {
     ConfigurationBatchSystem::ConfigurationBatchSystem(QObject *parent) : QObject(parent),
         m_calculation_result(QSharedPointer<CalculationResult>()),
-        m_actions(QList<QSharedPointer<ConfigurationAction>>()) {
+        m_calculation_fingerprint(0),
+        m_actions(),
+        m_primary_output(OutputId::Invalid) {
     }
 
     ConfigurationBatchSystem& ConfigurationBatchSystem::instance() {
@@ -18,38 +20,28 @@ namespace bd {
     }
 
     void ConfigurationBatchSystem::addAction(QSharedPointer<ConfigurationAction> action) {
+        if (action.isNull()) return;
+        m_layout.markDirty(action->getOutputId());
 
-        // If the action is to turn off the head, remove any actions related to the head
-        if (action->getActionType() == ConfigurationActionType::SetOnOff && !action->isOn()) {
-            for (auto action : m_actions) {
-                if (action->getSerial() == action->getSerial()) {
-                    removeAction(action->getSerial(), action->getActionType());
-                }
-            }
-        } else { // Remove any identical action for the action's serial
-            removeAction(action->getSerial(), action->getActionType());
-        }
+        // If the action is to turn off the head, remove any actions related to the head. Any identical action for the action's serial is
+        // replaced when it is stored.
+        if (action->getActionType() == ConfigurationActionType::SetOnOff && !action->isOn()) m_actions.removeOutput(action->getOutputId());
 
         // If the action is to set the primary head, remove any other primary head actions
         if (action->getActionType() == ConfigurationActionType::SetPrimary) {
-            for (auto action : m_actions) {
-                if (action->getActionType() == ConfigurationActionType::SetPrimary) {
-                    m_actions.removeOne(action);
-                    break;
-                }
+            if (m_primary_output != OutputId::Invalid && m_actions.remove(m_primary_output, ConfigurationActionType::SetPrimary)) {
+                m_layout.markDirty(m_primary_output);
             }
+            m_primary_output = action->getOutputId();
         }
 
-        m_actions.append(action);
+        m_actions.insert(action);
     }
 
-    void ConfigurationBatchSystem::removeAction(QString serial, ConfigurationActionType action_type) {
-        for (auto action : m_actions) {
-            if (action->getSerial() == serial && action->getActionType() == action_type) {
-                m_actions.removeOne(action);
-                break;
-            }
-        }
+    void ConfigurationBatchSystem::removeAction(OutputId output_id, ConfigurationActionType action_type) {
+        if (!m_actions.remove(output_id, action_type)) return;
+        m_layout.markDirty(output_id);
+        if (action_type == ConfigurationActionType::SetPrimary && output_id == m_primary_output) m_primary_output = OutputId::Invalid;
     }
 
     void ConfigurationBatchSystem::apply() {
@@ -72,16 +64,16 @@ namespace bd {
         }
 
         // Get all output states from calculation result
-        auto outputStates = m_calculation_result->getOutputStates();
+        const auto &outputStates = m_calculation_result->getOutputStates();
         
         // Validate that all heads have corresponding output target states
         auto allHeads = manager->getHeads();
         for (auto const& headPtr : allHeads) {
             if (headPtr.isNull()) continue;
             auto head = headPtr.data();
-            auto serial = head->getIdentifier();
+            auto serial = head->getOutputId();
             
-            if (!outputStates.contains(serial)) {
+            if (m_calculation_result->getOutputState(serial) == nullptr) {
                 qWarning() << "ConfigurationBatchSystem error: Head" << serial 
                           << "does not have a corresponding OutputTargetState. This indicates a bug in the calculation logic.";
                 return;
@@ -91,9 +83,8 @@ namespace bd {
         }
 
         // Process each output state
-        for (auto serial : outputStates.keys()) {
-            auto outputState = outputStates[serial];
-            if (outputState.isNull()) continue;
+        for (const auto &outputState : outputStates) {
+            auto serial = outputState.getOutputId();
 
             // Get the corresponding head
             auto head = manager->getOutputHead(serial);
@@ -102,9 +93,9 @@ namespace bd {
                 continue;
             }
 
-            qDebug() << "Processing output" << serial << "on:" << outputState->isOn();
+            qDebug() << "Processing output" << serial << "on:" << outputState.isOn();
 
-            if (outputState->isOn()) {
+            if (outputState.isOn()) {
                 // Enable the output and configure it
                 auto configHead = config->enable(head.data());
                 if (configHead.isNull()) {
@@ -115,32 +106,32 @@ namespace bd {
                 qDebug() << "Enabled output" << serial;
 
                 // Set position
-                auto position = outputState->getPosition();
+                auto position = outputState.getPosition();
                 configHead->setPosition(position.x(), position.y());
 
                 qDebug() << "Set position for output" << serial << "to:" << position;
 
                 // Set scale
-                auto scale = outputState->getScale();
+                auto scale = outputState.getScale();
                 configHead->setScale(scale);
 
                 qDebug() << "Set scale for output" << serial << "to:" << scale;
 
                 // Set transform
-                auto transform = outputState->getTransform();
+                auto transform = outputState.getTransform();
                 configHead->setTransform(transform);
 
                 qDebug() << "Set transform for output" << serial << "to:" << transform;
 
                 // Set adaptive sync
-                auto adaptiveSync = outputState->getAdaptiveSync();
+                auto adaptiveSync = outputState.getAdaptiveSync();
                 configHead->setAdaptiveSync(adaptiveSync);
 
                 qDebug() << "Set adaptive sync for output" << serial << "to:" << adaptiveSync;
 
                 // Set mode (dimensions and refresh rate)
-                auto dimensions = outputState->getDimensions();
-                auto refresh = outputState->getRefresh();
+                auto dimensions = outputState.getDimensions();
+                auto refresh = outputState.getRefresh();
                 
                 if (!dimensions.isEmpty() && refresh > 0) {
                     qDebug() << "Setting mode for output" << serial << "Dimensions:" << dimensions << "Refresh:" << refresh;
@@ -148,7 +139,7 @@ namespace bd {
                     auto mode = head->getModeForOutputHead(dimensions.width(), dimensions.height(), refresh);
                     if (!mode.isNull()) {
                         qDebug() << "Found existing mode for output" << serial << "Setting mode";
-                        configHead->setMode(mode.data());
+                        configHead->setMode(mode);
                     } else {
                         qDebug() << "No existing mode found for output" << serial << "Setting custom mode";
                         // Use custom mode if no existing mode matches
@@ -181,11 +172,11 @@ namespace bd {
                 auto &orchestrator = bd::WaylandOrchestrator::instance();
                 auto manager = orchestrator.getManager();
                 auto heads = manager->getHeads();
-                auto primary = activeGroup->getPrimaryOutput();
-                if (!primary.isEmpty()) {
+                auto primary = OutputIdTable::instance().find(activeGroup->getPrimaryOutput());
+                if (primary != OutputId::Invalid) {
                     for (const auto &head : heads) {
                         if (head.isNull()) continue;
-                        head->setPrimary(head->getIdentifier() == primary);
+                        head->setPrimary(head->getOutputId() == primary);
                     }
                 }
                 displayConfig.saveState();
@@ -216,332 +207,87 @@ namespace bd {
     }
 
     void ConfigurationBatchSystem::calculate() {
-        m_calculation_result = QSharedPointer<CalculationResult>(new CalculationResult(this));
-
-        // Create our output target states for each serial first
-        auto &orchestrator = bd::WaylandOrchestrator::instance();
-        auto manager = orchestrator.getManager();
-
-        auto pendingOutputStates = QMap<QString, QSharedPointer<OutputTargetState>>();
-
-        for (auto const& headPtr : manager->getHeads()) {
-            // Skip null heads
-            if (headPtr.isNull()) continue;
-            auto head = headPtr.data();
-
-            auto outputState = new OutputTargetState(head->getIdentifier());
-            outputState->setDefaultValues(headPtr); // Set some default values for the head
-            
-            auto outputStatePtr = QSharedPointer<OutputTargetState>(outputState);
-            pendingOutputStates.insert(head->getIdentifier(), outputStatePtr);
-        }
-
-        auto actionsBySerial = QMap<QString, QList<QSharedPointer<ConfigurationAction>>>();
-        // Group actions by serial
-        for (auto action : m_actions) {
-            if (actionsBySerial.contains(action->getSerial())) {
-                actionsBySerial[action->getSerial()].append(action);
-            } else {
-                actionsBySerial.insert(action->getSerial(), QList<QSharedPointer<ConfigurationAction>>{action});
-            }
-        }
-
-        // Apply all configuration actions to output states
-        for (auto serial : actionsBySerial.keys()) {
-            auto actions = actionsBySerial[serial];
-            auto outputState = pendingOutputStates[serial];
-            if (outputState.isNull()) continue;
-
-            for (auto action : actions) {
-                switch (action->getActionType()) {
-                    case ConfigurationActionType::SetOnOff:
-                        outputState->setOn(action->isOn());
-                        break;
-                    case ConfigurationActionType::SetMode:
-                        outputState->setDimensions(action->getDimensions());
-                        outputState->setRefresh(action->getRefresh());
-                        break;
-                    case ConfigurationActionType::SetScale:
-                        outputState->setScale(action->getScale());
-                        break;
-                    case ConfigurationActionType::SetTransform:
-                        outputState->setTransform(action->getTransform());
-                        break;
-                    case ConfigurationActionType::SetAdaptiveSync:
-                        outputState->setAdaptiveSync(action->getAdaptiveSync());
-                        break;
-                    case ConfigurationActionType::SetPrimary:
-                        outputState->setPrimary(true);
-                        break;
-                    case ConfigurationActionType::SetPositionAnchor:
-                        outputState->setRelative(action->getRelative());
-                        outputState->setHorizontalAnchor(action->getHorizontalAnchor());
-                        outputState->setVerticalAnchor(action->getVerticalAnchor());
-                        break;
-                    case ConfigurationActionType::SetMirrorOf:
-                        outputState->setMirrorOf(action->getRelative());
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
-
-        // Update resulting dimensions for all outputs
-        for (auto outputState : pendingOutputStates.values()) {
-            if (!outputState.isNull()) {
-                outputState->updateResultingDimensions();
-            }
-        }
-
-        // Identify mirroring relationships - mirrored outputs only share position, not configuration
-        auto mirrorActions = QMap<QString, QString>(); // serial -> mirrored_serial
-        for (auto action : m_actions) {
-            if (action->getActionType() == ConfigurationActionType::SetMirrorOf) {
-                mirrorActions.insert(action->getSerial(), action->getRelative());
-            }
-        }
-
-        // Build anchor relationships
-        auto anchorMap = QMap<QString, QString>(); // serial -> relative_serial
-        auto unanchoredOutputs = QList<QString>();
-
-        for (auto action : m_actions) {
-            if (action->getActionType() == ConfigurationActionType::SetPositionAnchor) {
-                anchorMap.insert(action->getSerial(), action->getRelative());
-            }
-        }
-
-        for (auto serial : pendingOutputStates.keys()) {
-            auto outputState = pendingOutputStates[serial];
-            if (!outputState.isNull() && outputState->isOn() && !anchorMap.contains(serial)) {
-                unanchoredOutputs.append(serial);
-            }
-        }
-
-        // Build horizontal chain for positioning
-        QList<QString> horizontalChain = buildHorizontalChain(pendingOutputStates, m_actions);
-        qDebug() << "Horizontal output chain order:" << horizontalChain;
-
-        // Position outputs in horizontal chain from left to right
-        auto positionedOutputs = QSet<QString>();
-        QPoint nextPosition(0, 0);
-        for (const auto& serial : horizontalChain) {
-            auto outputState = pendingOutputStates[serial];
-            // If the output is enabled and not mirroring, position it in the chain
-            if (!outputState.isNull() && outputState->isOn() && !outputState->isMirroring()) {
-                outputState->setPosition(nextPosition);
-                positionedOutputs.insert(serial);
-                // Move next position to the right
-                auto dimensions = outputState->getResultingDimensions();
-                nextPosition.setX(nextPosition.x() + dimensions.width());
-            }
-        }
-
-        // Position anchored outputs iteratively (vertical and other anchors)
-        bool progressMade = true;
-        while (progressMade && positionedOutputs.size() < pendingOutputStates.size()) {
-            progressMade = false;
-            for (auto serial : anchorMap.keys()) {
-                if (positionedOutputs.contains(serial)) continue;
-                auto relativeSerial = anchorMap[serial];
-                if (!positionedOutputs.contains(relativeSerial)) continue;
-                auto outputState = pendingOutputStates[serial];
-                auto relativeState = pendingOutputStates[relativeSerial];
-                if (outputState.isNull() || relativeState.isNull() || !outputState->isOn() || outputState->isMirroring()) continue;
-                // Calculate position based on anchor (mirrored outputs will be handled separately)
-                QPoint newPosition = calculateAnchoredPosition(outputState, relativeState);
-                outputState->setPosition(newPosition);
-                positionedOutputs.insert(serial);
-                progressMade = true;
-            }
-        }
-        // Position mirrored outputs
-        for (auto serial : mirrorActions.keys()) {
-            auto mirroredSerial = mirrorActions[serial];
-            auto outputState = pendingOutputStates[serial];
-            auto mirroredState = pendingOutputStates[mirroredSerial];
-            
-            if (!outputState.isNull() && !mirroredState.isNull() && outputState->isOn() && outputState->isMirroring()) {
-                // Only inherit position if this output has no explicit anchoring and hasn't been positioned yet
-                if (!positionedOutputs.contains(serial) && !anchorMap.contains(serial)) {
-                    QPoint newPosition = calculateAnchoredPosition(outputState, mirroredState);
-                    outputState->setPosition(newPosition);
-                    positionedOutputs.insert(serial);
-                }
-            }
-        }
-
-        // Calculate global bounding rectangle
-        QRect globalRect;
-        bool firstOutput = true;
-        
-        for (auto outputState : pendingOutputStates.values()) {
-            if (!outputState.isNull() && outputState->isOn()) {
-                auto position = outputState->getPosition();
-                auto dimensions = outputState->getResultingDimensions();
-                QRect outputRect(position, dimensions);
-                
-                if (firstOutput) {
-                    globalRect = outputRect;
-                    firstOutput = false;
-                } else {
-                    globalRect = globalRect.united(outputRect);
-                }
-            }
-        }
-
-        // Store results
-        m_calculation_result->getOutputStates().clear();
-        for (auto serial : pendingOutputStates.keys()) {
-            auto outputState = pendingOutputStates[serial];
-            m_calculation_result->setOutputState(serial, outputState);
-        }
-
-        // Update global space
-        if (!globalRect.isEmpty()) {
-            auto globalSpace = m_calculation_result->getGlobalSpace();
-            *globalSpace = globalRect;
-        }
+        auto manager = bd::WaylandOrchestrator::instance().getManager();
+        calculate(manager.isNull() ? QList<QSharedPointer<WaylandOutputMetaHead>>() : manager->getHeads());
     }
 
-    QPoint ConfigurationBatchSystem::calculateAnchoredPosition(QSharedPointer<OutputTargetState> outputState, QSharedPointer<OutputTargetState> relativeState) {
-        if (outputState.isNull() || relativeState.isNull()) return QPoint(0, 0);
-        
-        auto relativePos = relativeState->getPosition();
-        auto relativeDimensions = relativeState->getResultingDimensions();
-        auto outputDimensions = outputState->getResultingDimensions();
-        
-        QPoint newPosition = relativePos;
-        
-        // Calculate horizontal position
-        switch (outputState->getHorizontalAnchor()) {
-            case ConfigurationHorizontalAnchor::Left:
-                // Left edge of output aligns with left edge of relative
-                newPosition.setX(relativePos.x());
-                break;
-            case ConfigurationHorizontalAnchor::Right:
-                // Right edge of output aligns with right edge of relative
-                newPosition.setX(relativePos.x() + relativeDimensions.width() - outputDimensions.width());
-                break;
-            case ConfigurationHorizontalAnchor::Center:
-                // Center of output aligns with center of relative
-                newPosition.setX(relativePos.x() + (relativeDimensions.width() - outputDimensions.width()) / 2);
-                break;
-            default:
-                // Default behavior: for mirrors, align left; otherwise place to the right
-                newPosition.setX(outputState->isMirroring() ? relativePos.x() : relativePos.x() + relativeDimensions.width());
-                break;
+    // calculate brings the resulting state up to date with our actions. Only outputs whose actions or heads changed since the last calculation
+    // (and the outputs positioned relative to them) are recomputed, see ConfigurationLayout. This runs on every change a client makes, so like
+    // the layout it neither logs nor allocates once warmed up.
+    bool ConfigurationBatchSystem::calculate(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads) {
+        auto fingerprint = getFingerprint(heads);
+        if (!m_calculation_result.isNull() && fingerprint == m_calculation_fingerprint && isCalculatedFrom(heads)) return false;
+
+        m_layout.update(heads, m_actions);
+
+        // The result is a view over the layout, so it only needs making once. The shared pointer is its only owner, it has no QObject parent.
+        if (m_calculation_result.isNull()) m_calculation_result = QSharedPointer<CalculationResult>(new CalculationResult(&m_layout));
+        m_calculation_result->setFingerprint(fingerprint);
+        m_calculation_fingerprint = fingerprint;
+
+        // Both are refilled in place rather than rebuilt, so once they have grown to fit a calculation doesn't allocate
+        m_actions.copyTo(m_calculated_actions);
+        m_calculated_heads.clear();
+        for (const auto &head : heads) {
+            if (!head.isNull()) m_calculated_heads.append(CalculatedHead{head, head->getGeneration()});
         }
-        
-        // Calculate vertical position
-        switch (outputState->getVerticalAnchor()) {
-            case ConfigurationVerticalAnchor::Above:
-                // Bottom edge of output is at top edge of relative
-                newPosition.setY(relativePos.y() - outputDimensions.height());
-                break;
-            case ConfigurationVerticalAnchor::Top:
-                // Top edge of output aligns with top edge of relative
-                newPosition.setY(relativePos.y());
-                break;
-            case ConfigurationVerticalAnchor::Middle:
-                // Middle of output aligns with middle of relative
-                newPosition.setY(relativePos.y() + (relativeDimensions.height() - outputDimensions.height()) / 2);
-                break;
-            case ConfigurationVerticalAnchor::Bottom:
-                // Bottom edge of output aligns with bottom edge of relative
-                newPosition.setY(relativePos.y() + relativeDimensions.height() - outputDimensions.height());
-                break;
-            case ConfigurationVerticalAnchor::Below:
-                // Top edge of output is at bottom edge of relative
-                newPosition.setY(relativePos.y() + relativeDimensions.height());
-                break;
-            default:
-                // Default behavior: for mirrors, align top; otherwise keep same Y
-                newPosition.setY(outputState->isMirroring() ? relativePos.y() : relativePos.y());
-                break;
-        }
-        
-        return newPosition;
+        return true;
     }
 
     void ConfigurationBatchSystem::reset() {
         m_calculation_result.clear(); // Clear the calculation result
         m_actions.clear(); // Clear the actions
+        m_calculated_actions.clear();
+        m_calculated_heads.clear();
+        m_primary_output = OutputId::Invalid;
+        m_layout.invalidate();
     }
     
     QList<QSharedPointer<ConfigurationAction>> ConfigurationBatchSystem::getActions() const {
-        return m_actions;
+        return m_actions.actions();
     }
 
     QSharedPointer<CalculationResult> ConfigurationBatchSystem::getCalculationResult() const {
         return m_calculation_result;
     }
-}
 
-QList<QString> bd::ConfigurationBatchSystem::buildHorizontalChain(const QMap<QString, QSharedPointer<OutputTargetState>>& pendingOutputStates, const QList<QSharedPointer<ConfigurationAction>>& actions) const {
-    // Map: serial -> relative_serial (for Right anchors only, not Above/Below)
-    QMap<QString, QString> rightOfMap;
-    // Reverse map: relative_serial -> serial
-    QMap<QString, QString> referencedByMap;
-    QSet<QString> allSerials;
-    QSet<QString> allRelatives;
-
-    for (const auto& action : actions) {
-        if (action->getActionType() == ConfigurationActionType::SetPositionAnchor &&
-            action->getHorizontalAnchor() == ConfigurationHorizontalAnchor::Right &&
-            action->getVerticalAnchor() != ConfigurationVerticalAnchor::Above &&
-            action->getVerticalAnchor() != ConfigurationVerticalAnchor::Below) {
-            rightOfMap.insert(action->getSerial(), action->getRelative());
-            referencedByMap.insert(action->getRelative(), action->getSerial());
-            allSerials.insert(action->getSerial());
-            allRelatives.insert(action->getRelative());
-        }
-    }
-    // All outputs
-    for (const auto& serial : pendingOutputStates.keys()) {
-        allSerials.insert(serial);
+    quint64 ConfigurationBatchSystem::getFingerprint() const {
+        auto manager = bd::WaylandOrchestrator::instance().getManager();
+        return getFingerprint(manager.isNull() ? QList<QSharedPointer<WaylandOutputMetaHead>>() : manager->getHeads());
     }
 
-    // Find the leftmost output: one that is referenced as a relative, but is not a serial in rightOfMap
-    // (i.e., appears as a relative, but not as a serial)
-    QString leftmost;
-    for (const auto& rel : allRelatives) {
-        if (!rightOfMap.contains(rel)) {
-            leftmost = rel;
-            break;
-        }
-    }
-    // If not found, fallback: pick any output not a serial in rightOfMap
-    if (leftmost.isEmpty()) {
-        for (const auto& serial : pendingOutputStates.keys()) {
-            if (!rightOfMap.contains(serial)) {
-                leftmost = serial;
-                break;
-            }
-        }
-    }
+    // getFingerprint hashes what each of our actions does, in the order they were set, with the id and generation of every connected head,
+    // which is all a calculation reads
+    quint64 ConfigurationBatchSystem::getFingerprint(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads) const {
+        auto fingerprint = size_t{0};
+        m_actions.forEach([&fingerprint](const ConfigurationAction &action) { fingerprint = qHash(action, fingerprint); });
 
-    QList<QString> chain;
-    QSet<QString> visited;
-    // Walk the chain from leftmost to rightmost
-    QString current = leftmost;
-    while (!current.isEmpty() && !visited.contains(current)) {
-        chain.append(current);
-        visited.insert(current);
-        // Find who is right of current
-        if (referencedByMap.contains(current)) {
-            current = referencedByMap[current];
-        } else {
-            break;
+        for (const auto &head : heads) {
+            if (head.isNull()) continue;
+            fingerprint = qHashMulti(fingerprint, head->getOutputId(), head->getGeneration());
         }
+        return fingerprint;
     }
 
-    // Append unanchored outputs (not in chain)
-    for (const auto& serial : pendingOutputStates.keys()) {
-        if (!visited.contains(serial)) {
-            chain.append(serial);
+    // isCalculatedFrom is whether the last calculation was made from exactly these heads and our current actions. Matching fingerprints make
+    // that very likely, this makes sure a hash collision can't hand back a stale result.
+    bool ConfigurationBatchSystem::isCalculatedFrom(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads) const {
+        if (m_calculated_actions.size() != m_actions.size()) return false;
+
+        auto index = qsizetype{0};
+        auto same = true;
+        m_actions.forEach([this, &index, &same](const ConfigurationAction &action) {
+            same = same && action.isSameAs(*m_calculated_actions.at(index++));
+        });
+        if (!same) return false;
+
+        index = 0;
+        for (const auto &head : heads) {
+            if (head.isNull()) continue;
+            if (index >= m_calculated_heads.size()) return false;
+            const auto &calculated = m_calculated_heads.at(index++);
+            if (calculated.head != head || calculated.generation != head->getGeneration()) return false;
         }
+        return index == m_calculated_heads.size();
     }
-    return chain;
-}
\ No newline at end of file
+}
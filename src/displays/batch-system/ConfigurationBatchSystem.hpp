@@ -5,9 +5,13 @@
 #include <QMap>
 #include <QList>
 #include "ConfigurationAction.hpp"
+#include "ConfigurationActionStore.hpp"
 #include "CalculationResult.hpp"
+#include "ConfigurationLayout.hpp"
 
 namespace bd {
+    class WaylandOutputMetaHead;
+
     class ConfigurationBatchSystem : public QObject {
     Q_OBJECT
 
@@ -17,7 +21,7 @@ namespace bd {
         static ConfigurationBatchSystem* create() { return &instance(); }
 
         void addAction(QSharedPointer<ConfigurationAction> action);
-        void removeAction(QString serial, ConfigurationActionType action_type);
+        void removeAction(OutputId output_id, ConfigurationActionType action_type);
 
         // Performs a calculation if necessary and applies them
         void apply();
@@ -25,8 +29,16 @@ namespace bd {
         // Calculate potential resulting state from all actions
         // This does not apply the actions.
         void calculate();
+        // calculate does the same for heads rather than the output manager's, returning false if the last result could be reused as is
+        bool calculate(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads);
 
+        // getCalculationResult returns a view over our layout, null until the first calculate(). It is not a snapshot: the next calculate()
+        // changes what it reports, so copy out anything that has to survive one.
         QSharedPointer<CalculationResult> getCalculationResult() const;
+        // getFingerprint identifies our actions along with the committed state of the heads they apply to. Calculating twice with the same
+        // fingerprint gives the same result, so the last one is reused.
+        quint64 getFingerprint() const;
+        quint64 getFingerprint(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads) const;
         QList<QSharedPointer<ConfigurationAction>> getActions() const;
 
         // Clears any actions, resets any state
@@ -36,13 +48,24 @@ namespace bd {
         void configurationApplied(bool success);
 
     private:
-        QSharedPointer<CalculationResult> m_calculation_result;
-        QList<QSharedPointer<ConfigurationAction>> m_actions;
+        // CalculatedHead is a head as it was when the last calculation read it
+        struct CalculatedHead {
+            QWeakPointer<WaylandOutputMetaHead> head;
+            quint64 generation;
+        };
 
-        // Helper method for calculating anchored positions
-        QPoint calculateAnchoredPosition(QSharedPointer<OutputTargetState> outputState, QSharedPointer<OutputTargetState> relativeState);
+        bool isCalculatedFrom(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads) const;
+
+        QSharedPointer<CalculationResult> m_calculation_result;
+        quint64 m_calculation_fingerprint; // The fingerprint m_calculation_result was calculated for
+        // What m_calculation_result was calculated from, compared when the fingerprint matches
+        QList<QSharedPointer<ConfigurationAction>> m_calculated_actions;
+        QList<CalculatedHead> m_calculated_heads;
+        ConfigurationActionStore m_actions;
+        // Only one output can be made primary, this is the one with a SetPrimary action (if any)
+        OutputId m_primary_output;
 
-        // Helper to build the horizontal chain for output positioning
-        QList<QString> buildHorizontalChain(const QMap<QString, QSharedPointer<OutputTargetState>>& pendingOutputStates, const QList<QSharedPointer<ConfigurationAction>>& actions) const;
+        // Kept between calculations so only what changed is recomputed
+        ConfigurationLayout m_layout;
     };
 }
\ No newline at end of file
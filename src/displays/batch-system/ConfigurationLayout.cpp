@@ -0,0 +1,560 @@
+#include "ConfigurationLayout.hpp"
+#include <output-manager/head/WaylandOutputMetaHead.hpp>
+#include <QDebug>
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+#include <utility>
+
+namespace bd {
+    qsizetype ConfigurationLayout::update(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads, const ConfigurationActionStore &actions) {
+        clearFlag(Seen);
+
+        // Rebuild the target state of every output whose head the compositor changed since the last update, or whose actions changed
+        auto recomputed = qsizetype{0};
+        for (const auto &head : heads) {
+            if (head.isNull()) continue;
+            auto output_id = head->getOutputId();
+            auto slot = slotFor(output_id);
+            if (slot < 0) slot = insertSlot(output_id);
+            m_flags[slot] |= Seen;
+
+            auto generation = head->getGeneration();
+            if (m_head_generations.at(slot) != generation) m_flags[slot] |= Dirty;
+            m_head_generations[slot] = generation;
+            if ((m_flags.at(slot) & Dirty) == 0) continue;
+
+            auto previous = m_output_states.at(slot);
+            buildOutputState(m_output_states[slot], head, actions);
+            if (!hasSameRelationships(previous, m_output_states.at(slot))) m_relationships_dirty = true;
+            recomputed++;
+        }
+
+        // Heads that were disconnected since the last update
+        for (auto slot = m_flags.size() - 1; slot >= 0; --slot) {
+            if ((m_flags.at(slot) & Seen) == 0) removeSlot(slot);
+        }
+
+        if (m_relationships_dirty) {
+            rebuildRelationships(actions);
+            for (auto &flags : m_flags) flags |= Dirty;
+        }
+
+        // Position outputs in horizontal chain from left to right, starting at the first one that could have moved
+        clearFlag(Positioned);
+        auto first = qsizetype{0};
+        while (first < m_chain.size() && (m_flags.at(m_chain.at(first)) & Dirty) == 0) first++;
+
+        auto nextPosition = first < m_chain.size() ? m_chain_offsets.at(first) : QPoint(0, 0);
+        for (auto index = first; index < m_chain.size(); ++index) {
+            m_chain_offsets[index] = nextPosition;
+            auto slot = m_chain.at(index);
+            auto &outputState = m_output_states[slot];
+            // If the output is enabled and not mirroring, position it in the chain
+            if (outputState.isOn() && !outputState.isMirroring()) {
+                outputState.setPosition(nextPosition);
+                m_flags[slot] |= Positioned;
+                // Move next position to the right
+                nextPosition.setX(nextPosition.x() + outputState.getResultingDimensions().width());
+            }
+        }
+
+        // Position anchored and mirroring outputs in topological order, so whatever an output is placed relative to has always been placed by
+        // the time we get to it. Only those that changed, or whose relative or mirrored output changed or moved, need placing again.
+        for (auto slot : std::as_const(m_placement_order)) {
+            auto relativeSlot = m_anchor_slots.at(slot);
+            auto mirroredSlot = m_mirror_slots.at(slot);
+            auto relativeMoved = relativeSlot >= 0 && (m_flags.at(relativeSlot) & (Dirty | Positioned)) != 0;
+            auto mirroredMoved = mirroredSlot >= 0 && (m_flags.at(mirroredSlot) & (Dirty | Positioned)) != 0;
+            if ((m_flags.at(slot) & Dirty) == 0 && !relativeMoved && !mirroredMoved) continue;
+
+            auto &outputState = m_output_states[slot];
+            if (!outputState.isOn()) continue;
+
+            if (!outputState.isMirroring()) {
+                if (relativeSlot < 0) continue;
+                outputState.setPosition(calculateAnchoredPosition(outputState, m_output_states.at(relativeSlot)));
+                m_flags[slot] |= Positioned;
+            } else if (mirroredSlot >= 0 && (m_flags.at(slot) & Anchored) == 0) {
+                // Only inherit position if this output has no explicit anchoring
+                outputState.setPosition(calculateAnchoredPosition(outputState, m_output_states.at(mirroredSlot)));
+                m_flags[slot] |= Positioned;
+            }
+        }
+
+        clearFlag(Dirty);
+        updateGlobalSpace();
+        return recomputed;
+    }
+
+    void ConfigurationLayout::markDirty(OutputId output_id) {
+        // Outputs we don't have a slot for yet are dirty as soon as they get one
+        auto slot = slotFor(output_id);
+        if (slot >= 0) m_flags[slot] |= Dirty;
+    }
+
+    void ConfigurationLayout::invalidate() {
+        m_output_states.clear();
+        m_head_generations.clear();
+        m_flags.clear();
+        m_mirror_slots.clear();
+        m_anchor_slots.clear();
+        m_chain.clear();
+        m_chain_offsets.clear();
+        m_placement_order.clear();
+        m_errors.clear();
+        m_relationships_dirty = true;
+    }
+
+    QRect ConfigurationLayout::getGlobalSpace() const {
+        return m_global_space;
+    }
+
+    const QList<OutputTargetState> &ConfigurationLayout::getOutputStates() const {
+        return m_output_states;
+    }
+
+    const OutputTargetState *ConfigurationLayout::getOutputState(OutputId output_id) const {
+        auto slot = slotFor(output_id);
+        if (slot < 0) return nullptr;
+        return &m_output_states.at(slot);
+    }
+
+    const QList<CalculationError> &ConfigurationLayout::getErrors() const {
+        return m_errors;
+    }
+
+    bool ConfigurationLayout::isEquivalentTo(const ConfigurationLayout &other) const {
+        if (m_global_space != other.m_global_space || m_output_states.size() != other.m_output_states.size() || m_errors != other.m_errors) return false;
+
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            const auto &state = m_output_states.at(slot);
+            const auto &other_state = other.m_output_states.at(slot);
+            if (state.getOutputId() != other_state.getOutputId() || state.isOn() != other_state.isOn() ||
+                state.getPosition() != other_state.getPosition() || state.getResultingDimensions() != other_state.getResultingDimensions() ||
+                state.getRefresh() != other_state.getRefresh() || state.getScale() != other_state.getScale() ||
+                state.getTransform() != other_state.getTransform() || state.isPrimary() != other_state.isPrimary() ||
+                state.getMirrorOf() != other_state.getMirrorOf()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // buildOutputState resets outputState to the committed state of head, then applies the actions for it in the order they were set
+    void ConfigurationLayout::buildOutputState(OutputTargetState &outputState, const QSharedPointer<WaylandOutputMetaHead> &head,
+                                               const ConfigurationActionStore &actions) {
+        outputState = OutputTargetState(head->getOutputId());
+        outputState.setDefaultValues(head); // Set some default values for the head
+
+        actions.forEachFor(head->getOutputId(), [&outputState](const ConfigurationAction &action) {
+            switch (action.getActionType()) {
+                case ConfigurationActionType::SetOnOff:
+                    outputState.setOn(action.isOn());
+                    break;
+                case ConfigurationActionType::SetMode:
+                    outputState.setDimensions(action.getDimensions());
+                    outputState.setRefresh(action.getRefresh());
+                    break;
+                case ConfigurationActionType::SetScale:
+                    outputState.setScale(action.getScale());
+                    break;
+                case ConfigurationActionType::SetTransform:
+                    outputState.setTransform(action.getTransform());
+                    break;
+                case ConfigurationActionType::SetAdaptiveSync:
+                    outputState.setAdaptiveSync(action.getAdaptiveSync());
+                    break;
+                case ConfigurationActionType::SetPrimary:
+                    outputState.setPrimary(true);
+                    break;
+                case ConfigurationActionType::SetPositionAnchor:
+                    outputState.setRelative(action.getRelativeOutputId());
+                    outputState.setHorizontalAnchor(action.getHorizontalAnchor());
+                    outputState.setVerticalAnchor(action.getVerticalAnchor());
+                    break;
+                case ConfigurationActionType::SetMirrorOf:
+                    outputState.setMirrorOf(action.getRelativeOutputId());
+                    break;
+                default:
+                    break;
+            }
+        });
+
+        outputState.updateResultingDimensions();
+    }
+
+    // hasSameRelationships is whether an output is anchored and mirrored the same way in both states, if so the chain doesn't need rebuilding
+    bool ConfigurationLayout::hasSameRelationships(const OutputTargetState &a, const OutputTargetState &b) {
+        return a.getRelative() == b.getRelative() && a.getHorizontalAnchor() == b.getHorizontalAnchor() &&
+               a.getVerticalAnchor() == b.getVerticalAnchor() && a.getMirrorOf() == b.getMirrorOf();
+    }
+
+    // isChainAnchor is whether action places its output to the right of its relative, which the horizontal chain takes care of
+    bool ConfigurationLayout::isChainAnchor(const QSharedPointer<ConfigurationAction> &action) {
+        return action->getActionType() == ConfigurationActionType::SetPositionAnchor &&
+               action->getHorizontalAnchor() == ConfigurationHorizontalAnchor::Right &&
+               action->getVerticalAnchor() != ConfigurationVerticalAnchor::Above && action->getVerticalAnchor() != ConfigurationVerticalAnchor::Below;
+    }
+
+    // slotFor returns the slot of output_id, or -1 if it doesn't have one. Slots are in OutputId order, so this is a binary search.
+    qsizetype ConfigurationLayout::slotFor(OutputId output_id) const {
+        auto it = std::lower_bound(m_output_states.cbegin(), m_output_states.cend(), output_id,
+                                   [](const OutputTargetState &state, OutputId id) { return state.getOutputId() < id; });
+        if (it == m_output_states.cend() || it->getOutputId() != output_id) return -1;
+        return it - m_output_states.cbegin();
+    }
+
+    // insertSlot makes room for a new output. Slots after it shift along, so relationships (which refer to slots) have to be rebuilt.
+    qsizetype ConfigurationLayout::insertSlot(OutputId output_id) {
+        auto slot = std::lower_bound(m_output_states.cbegin(), m_output_states.cend(), output_id,
+                                     [](const OutputTargetState &state, OutputId id) { return state.getOutputId() < id; }) -
+                    m_output_states.cbegin();
+        m_output_states.insert(slot, OutputTargetState(output_id));
+        m_head_generations.insert(slot, 0);
+        m_flags.insert(slot, Dirty);
+        m_mirror_slots.insert(slot, -1);
+        m_anchor_slots.insert(slot, -1);
+        m_relationships_dirty = true;
+        return slot;
+    }
+
+    void ConfigurationLayout::removeSlot(qsizetype slot) {
+        m_output_states.removeAt(slot);
+        m_head_generations.removeAt(slot);
+        m_flags.removeAt(slot);
+        m_mirror_slots.removeAt(slot);
+        m_anchor_slots.removeAt(slot);
+        m_relationships_dirty = true;
+    }
+
+    void ConfigurationLayout::clearFlag(Flag flag) {
+        for (auto &flags : m_flags) flags &= ~flag;
+    }
+
+    // rebuildRelationships works out the horizontal chain and the mirroring and anchor relationships between our outputs. This only happens when
+    // outputs come and go or are anchored differently, so unlike update it doesn't mind allocating.
+    void ConfigurationLayout::rebuildRelationships(const ConfigurationActionStore &actions) {
+        auto allActions = actions.actions();
+
+        m_mirror_slots.fill(-1);
+        clearFlag(Anchored);
+        for (const auto &action : allActions) {
+            auto slot = slotFor(action->getOutputId());
+            if (slot < 0) continue;
+            if (action->getActionType() == ConfigurationActionType::SetMirrorOf) m_mirror_slots[slot] = slotFor(action->getRelativeOutputId());
+            if (action->getActionType() == ConfigurationActionType::SetPositionAnchor) m_flags[slot] |= Anchored;
+        }
+
+        // Outputs placed by their anchor are left out of the chain
+        resolveAnchors(allActions);
+        auto chainedOutputs = QList<OutputId>();
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            if (m_anchor_slots.at(slot) < 0) chainedOutputs.append(m_output_states.at(slot).getOutputId());
+        }
+
+        auto chain = buildHorizontalChain(chainedOutputs, allActions);
+        qDebug() << "Horizontal output chain order:" << chain;
+
+        // The chain can pass through relatives we have no head for, those don't get a slot
+        m_chain.clear();
+        for (auto output_id : chain) {
+            auto slot = slotFor(output_id);
+            if (slot >= 0 && m_anchor_slots.at(slot) < 0) m_chain.append(slot);
+        }
+        m_chain_offsets = QList<QPoint>(m_chain.size(), QPoint(0, 0));
+        orderPlacements();
+        m_relationships_dirty = false;
+    }
+
+    // orderPlacements orders every output placed relative to another one, by its anchor or as a mirror, so each comes after whatever it is
+    // placed relative to. An anchored mirror depends on two outputs, so unlike resolveAnchors this goes by slot rather than by relative. Outputs
+    // left over depend on one another through a mix of anchors and mirrors; they are reported and not placed at all, so where they end up never
+    // depends on which of them happened to be placed first.
+    void ConfigurationLayout::orderPlacements() {
+        m_placement_order.clear();
+
+        auto isPlaced = [this](qsizetype slot) { return slot >= 0 && (m_anchor_slots.at(slot) >= 0 || m_mirror_slots.at(slot) >= 0); };
+        auto waitingOn = QList<quint8>(m_output_states.size(), 0);
+        auto dependents = QHash<qsizetype, QList<qsizetype>>();
+        auto queue = QQueue<qsizetype>();
+        auto placed = qsizetype{0};
+
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            if (!isPlaced(slot)) continue;
+            placed++;
+            for (auto relativeSlot : {m_anchor_slots.at(slot), m_mirror_slots.at(slot)}) {
+                if (!isPlaced(relativeSlot)) continue;
+                waitingOn[slot]++;
+                dependents[relativeSlot].append(slot);
+            }
+            if (waitingOn.at(slot) == 0) queue.enqueue(slot);
+        }
+
+        while (!queue.isEmpty()) {
+            auto slot = queue.dequeue();
+            m_placement_order.append(slot);
+            for (auto dependent : dependents.value(slot)) {
+                if (--waitingOn[dependent] == 0) queue.enqueue(dependent);
+            }
+        }
+
+        if (m_placement_order.size() == placed) return;
+
+        // Whatever is still waiting on something is in a cycle or placed relative to one. Peel off the outputs nothing else left over is placed
+        // relative to, and whatever remains makes up the cycles.
+        auto isLeftOver = [&waitingOn](qsizetype slot) { return slot >= 0 && waitingOn.at(slot) > 0; };
+        auto waitedOnBy = QList<quint8>(m_output_states.size(), 0);
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            if (!isLeftOver(slot)) continue;
+            for (auto relativeSlot : {m_anchor_slots.at(slot), m_mirror_slots.at(slot)}) {
+                if (isLeftOver(relativeSlot)) waitedOnBy[relativeSlot]++;
+            }
+        }
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            if (isLeftOver(slot) && waitedOnBy.at(slot) == 0) queue.enqueue(slot);
+        }
+        auto peeled = QList<bool>(m_output_states.size(), false);
+        while (!queue.isEmpty()) {
+            auto slot = queue.dequeue();
+            peeled[slot] = true;
+            for (auto relativeSlot : {m_anchor_slots.at(slot), m_mirror_slots.at(slot)}) {
+                if (isLeftOver(relativeSlot) && --waitedOnBy[relativeSlot] == 0) queue.enqueue(relativeSlot);
+            }
+        }
+
+        auto error = CalculationError{.type = CalculationError::Type::PlacementCycle, .outputs = {}, .dependents = {}};
+        auto cycle = QStringList();
+        auto dependents = QStringList();
+        for (qsizetype slot = 0; slot < m_output_states.size(); ++slot) {
+            if (!isLeftOver(slot)) continue;
+            const auto &outputState = m_output_states.at(slot);
+            (peeled.at(slot) ? error.dependents : error.outputs).append(outputState.getOutputId());
+            (peeled.at(slot) ? dependents : cycle).append(outputState.getSerial());
+        }
+        m_errors.append(error);
+        qWarning() << "Outputs" << cycle << "are anchored to and mirror one another in a cycle, leaving them (and" << dependents
+                   << ") where they are";
+    }
+
+    // resolveAnchors orders the outputs anchored to another output (other than to its right) with Kahn's algorithm. Each output has at most
+    // one relative, so this is linear in the number of anchored outputs. Outputs that are left over are anchored in a cycle, or to one; they
+    // are reported and left in the chain so they still get a sensible place.
+    void ConfigurationLayout::resolveAnchors(const QList<QSharedPointer<ConfigurationAction>> &actions) {
+        m_anchor_slots.fill(-1);
+        m_errors.clear();
+
+        auto relatives = QMap<OutputId, OutputId>(); // Ordered, so the resulting order doesn't depend on hashing
+        for (const auto &action : actions) {
+            if (action->getActionType() != ConfigurationActionType::SetPositionAnchor || isChainAnchor(action)) continue;
+            if (slotFor(action->getOutputId()) < 0 || slotFor(action->getRelativeOutputId()) < 0) continue;
+            relatives.insert(action->getOutputId(), action->getRelativeOutputId());
+        }
+
+        auto dependents = QHash<OutputId, QList<OutputId>>(); // relative_serial -> serials anchored to it
+        auto queue = QQueue<OutputId>();
+        for (auto it = relatives.constBegin(); it != relatives.constEnd(); ++it) {
+            dependents[it.value()].append(it.key());
+            if (!relatives.contains(it.value())) queue.enqueue(it.key()); // Anchored to an output the chain places
+        }
+
+        auto resolved = qsizetype{0};
+        while (!queue.isEmpty()) {
+            auto serial = queue.dequeue();
+            auto slot = slotFor(serial);
+            resolved++;
+            m_anchor_slots[slot] = slotFor(relatives.value(serial));
+            for (auto dependent : dependents.value(serial)) queue.enqueue(dependent);
+        }
+
+        if (resolved == relatives.size()) return;
+
+        // Whatever is left follows its relatives into a cycle. Walk each until we reach an output we have seen: if it was seen on this walk
+        // we found a new cycle, otherwise we joined the walk to one we already know about.
+        auto cycleOf = QHash<OutputId, qsizetype>();
+        for (auto it = relatives.constBegin(); it != relatives.constEnd(); ++it) {
+            if (m_anchor_slots.at(slotFor(it.key())) >= 0 || cycleOf.contains(it.key())) continue;
+
+            auto path = QList<OutputId>();
+            auto onPath = QHash<OutputId, qsizetype>();
+            auto current = it.key();
+            while (!cycleOf.contains(current) && !onPath.contains(current)) {
+                onPath.insert(current, path.size());
+                path.append(current);
+                current = relatives.value(current);
+            }
+
+            auto cycle = qsizetype{0};
+            auto tail = path.size();
+            if (onPath.contains(current)) {
+                tail = onPath.value(current);
+                cycle = m_errors.size();
+                m_errors.append(CalculationError{.type = CalculationError::Type::AnchorCycle, .outputs = path.mid(tail), .dependents = {}});
+                for (auto serial : path.mid(tail)) cycleOf.insert(serial, cycle);
+            } else {
+                cycle = cycleOf.value(current);
+            }
+
+            for (auto serial : path.first(tail)) {
+                cycleOf.insert(serial, cycle);
+                m_errors[cycle].dependents.append(serial);
+            }
+        }
+
+        auto toIdentifiers = [](const QList<OutputId> &serials) {
+            QStringList identifiers;
+            for (auto serial : serials) identifiers.append(OutputIdTable::instance().identifier(serial));
+            return identifiers;
+        };
+        for (const auto &error : m_errors) {
+            qWarning() << "Outputs" << toIdentifiers(error.outputs) << "are anchored to one another in a cycle, placing them (and"
+                       << toIdentifiers(error.dependents) << ") in the horizontal chain instead";
+        }
+    }
+
+    void ConfigurationLayout::updateGlobalSpace() {
+        // Calculate global bounding rectangle
+        QRect globalRect;
+        bool firstOutput = true;
+
+        for (const auto &outputState : std::as_const(m_output_states)) {
+            if (outputState.isOn()) {
+                QRect outputRect(outputState.getPosition(), outputState.getResultingDimensions());
+
+                if (firstOutput) {
+                    globalRect = outputRect;
+                    firstOutput = false;
+                } else {
+                    globalRect = globalRect.united(outputRect);
+                }
+            }
+        }
+
+        m_global_space = globalRect;
+    }
+
+    QPoint ConfigurationLayout::calculateAnchoredPosition(const OutputTargetState &outputState, const OutputTargetState &relativeState) {
+        auto relativePos = relativeState.getPosition();
+        auto relativeDimensions = relativeState.getResultingDimensions();
+        auto outputDimensions = outputState.getResultingDimensions();
+        
+        QPoint newPosition = relativePos;
+        
+        // Calculate horizontal position
+        switch (outputState.getHorizontalAnchor()) {
+            case ConfigurationHorizontalAnchor::Left:
+                // Left edge of output aligns with left edge of relative
+                newPosition.setX(relativePos.x());
+                break;
+            case ConfigurationHorizontalAnchor::Right:
+                // Right edge of output aligns with right edge of relative
+                newPosition.setX(relativePos.x() + relativeDimensions.width() - outputDimensions.width());
+                break;
+            case ConfigurationHorizontalAnchor::Center:
+                // Center of output aligns with center of relative
+                newPosition.setX(relativePos.x() + (relativeDimensions.width() - outputDimensions.width()) / 2);
+                break;
+            default:
+                // Default behavior: for mirrors, align left; otherwise place to the right
+                newPosition.setX(outputState.isMirroring() ? relativePos.x() : relativePos.x() + relativeDimensions.width());
+                break;
+        }
+        
+        // Calculate vertical position
+        switch (outputState.getVerticalAnchor()) {
+            case ConfigurationVerticalAnchor::Above:
+                // Bottom edge of output is at top edge of relative
+                newPosition.setY(relativePos.y() - outputDimensions.height());
+                break;
+            case ConfigurationVerticalAnchor::Top:
+                // Top edge of output aligns with top edge of relative
+                newPosition.setY(relativePos.y());
+                break;
+            case ConfigurationVerticalAnchor::Middle:
+                // Middle of output aligns with middle of relative
+                newPosition.setY(relativePos.y() + (relativeDimensions.height() - outputDimensions.height()) / 2);
+                break;
+            case ConfigurationVerticalAnchor::Bottom:
+                // Bottom edge of output aligns with bottom edge of relative
+                newPosition.setY(relativePos.y() + relativeDimensions.height() - outputDimensions.height());
+                break;
+            case ConfigurationVerticalAnchor::Below:
+                // Top edge of output is at bottom edge of relative
+                newPosition.setY(relativePos.y() + relativeDimensions.height());
+                break;
+            default:
+                // Default behavior: for mirrors, align top; otherwise keep same Y
+                newPosition.setY(outputState.isMirroring() ? relativePos.y() : relativePos.y());
+                break;
+        }
+        
+        return newPosition;
+    }
+
+    QList<OutputId> ConfigurationLayout::buildHorizontalChain(const QList<OutputId> &outputs, const QList<QSharedPointer<ConfigurationAction>> &actions) {
+        // Map: serial -> relative_serial (for Right anchors only, not Above/Below)
+        QMap<OutputId, OutputId> rightOfMap;
+        // Reverse map: relative_serial -> serial
+        QMap<OutputId, OutputId> referencedByMap;
+        QSet<OutputId> allSerials;
+        QSet<OutputId> allRelatives;
+
+        for (const auto& action : actions) {
+            if (isChainAnchor(action)) {
+                rightOfMap.insert(action->getOutputId(), action->getRelativeOutputId());
+                referencedByMap.insert(action->getRelativeOutputId(), action->getOutputId());
+                allSerials.insert(action->getOutputId());
+                allRelatives.insert(action->getRelativeOutputId());
+            }
+        }
+        // All outputs
+        for (const auto& serial : outputs) {
+            allSerials.insert(serial);
+        }
+
+        // Find the leftmost output: one that is referenced as a relative, but is not a serial in rightOfMap
+        // (i.e., appears as a relative, but not as a serial)
+        OutputId leftmost = OutputId::Invalid;
+        for (const auto& rel : allRelatives) {
+            if (!rightOfMap.contains(rel)) {
+                leftmost = rel;
+                break;
+            }
+        }
+        // If not found, fallback: pick any output not a serial in rightOfMap
+        if (leftmost == OutputId::Invalid) {
+            for (const auto& serial : outputs) {
+                if (!rightOfMap.contains(serial)) {
+                    leftmost = serial;
+                    break;
+                }
+            }
+        }
+
+        QList<OutputId> chain;
+        QSet<OutputId> visited;
+        // Walk the chain from leftmost to rightmost
+        OutputId current = leftmost;
+        while (current != OutputId::Invalid && !visited.contains(current)) {
+            chain.append(current);
+            visited.insert(current);
+            // Find who is right of current
+            if (referencedByMap.contains(current)) {
+                current = referencedByMap[current];
+            } else {
+                break;
+            }
+        }
+
+        // Append unanchored outputs (not in chain)
+        for (const auto& serial : outputs) {
+            if (!visited.contains(serial)) {
+                chain.append(serial);
+            }
+        }
+        return chain;
+    }
+}
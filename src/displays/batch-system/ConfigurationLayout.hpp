@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSharedPointer>
+#include "CalculationResult.hpp"
+#include "ConfigurationActionStore.hpp"
+#include "OutputTargetState.hpp"
+
+namespace bd {
+    class WaylandOutputMetaHead;
+
+    // ConfigurationLayout works out where every output ends up given the batch system's actions. It is kept between calculations: an output's
+    // target state is only rebuilt when it is marked dirty (an action for it changed) or its head changed, and only the outputs that depend on
+    // those (the rest of the horizontal chain, and their mirrors) are repositioned. Changing which outputs exist or how they are anchored to one
+    // another rebuilds the chain and repositions everything.
+    //
+    // Outputs live in slots, one per output in OutputId order, and everything we know about them is kept as columns indexed by slot. Once the
+    // outputs and their relationships are settled an update only rewrites those columns in place, so it doesn't allocate.
+    class ConfigurationLayout {
+    public:
+        // update brings the layout up to date with heads and actions, returning how many output states had to be recomputed
+        qsizetype update(const QList<QSharedPointer<WaylandOutputMetaHead>> &heads, const ConfigurationActionStore &actions);
+
+        void markDirty(OutputId output_id);
+        // invalidate throws away everything, the next update computes the layout from scratch
+        void invalidate();
+
+        QRect getGlobalSpace() const;
+        // getOutputStates returns the state of every output, ordered by OutputId
+        const QList<OutputTargetState> &getOutputStates() const;
+        // getOutputState returns the state of output_id, or nullptr if we have no head for it
+        const OutputTargetState *getOutputState(OutputId output_id) const;
+        // getErrors returns the problems found the last time our relationships were rebuilt
+        const QList<CalculationError> &getErrors() const;
+
+        // isEquivalentTo is whether both layouts resolved every output to the same place, used by the tests to check incremental updates
+        bool isEquivalentTo(const ConfigurationLayout &other) const;
+
+    private:
+        enum Flag : quint8 {
+            Dirty = 1 << 0, // The state has to be rebuilt from its head and actions, and repositioned
+            Seen = 1 << 1, // The head was passed to the current update
+            Positioned = 1 << 2, // The output moved during the current update
+            Anchored = 1 << 3, // The output has a position anchor action
+        };
+
+        static QPoint calculateAnchoredPosition(const OutputTargetState &outputState, const OutputTargetState &relativeState);
+        static QList<OutputId> buildHorizontalChain(const QList<OutputId> &outputs, const QList<QSharedPointer<ConfigurationAction>> &actions);
+        static bool isChainAnchor(const QSharedPointer<ConfigurationAction> &action);
+        static bool hasSameRelationships(const OutputTargetState &a, const OutputTargetState &b);
+        static void buildOutputState(OutputTargetState &outputState, const QSharedPointer<WaylandOutputMetaHead> &head,
+                                     const ConfigurationActionStore &actions);
+
+        qsizetype slotFor(OutputId output_id) const;
+        qsizetype insertSlot(OutputId output_id);
+        void removeSlot(qsizetype slot);
+        void clearFlag(Flag flag);
+
+        void rebuildRelationships(const ConfigurationActionStore &actions);
+        void resolveAnchors(const QList<QSharedPointer<ConfigurationAction>> &actions);
+        void orderPlacements();
+        void updateGlobalSpace();
+
+        // Columns, indexed by slot
+        QList<OutputTargetState> m_output_states;
+        QList<quint64> m_head_generations;
+        QList<quint8> m_flags;
+        QList<qsizetype> m_mirror_slots; // The slot this output mirrors, -1 if none
+        QList<qsizetype> m_anchor_slots; // The slot this output is placed relative to (outside of the chain), -1 if none
+        bool m_relationships_dirty = true;
+
+        // Slots in chain order, where each enabled output that isn't mirroring starts at m_chain_offsets (the sum of the widths before it)
+        QList<qsizetype> m_chain;
+        QList<QPoint> m_chain_offsets;
+
+        QList<CalculationError> m_errors;
+        // Slots placed by their anchor or as a mirror, ordered so every output comes after the ones it is placed relative to
+        QList<qsizetype> m_placement_order;
+
+        QRect m_global_space;
+    };
+}
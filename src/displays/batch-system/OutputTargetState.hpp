@@ -1,27 +1,28 @@
 #pragma once
 
-#include <QObject>
 #include <QSize>
 #include <QPoint>
 #include <QRect>
 #include <QSharedPointer>
 #include <output-manager/head/WaylandOutputMetaHead.hpp>
+#include "displays/OutputId.hpp"
 
 #include "enums.hpp"
 
 namespace bd {
-    class OutputTargetState : public QObject {
-        Q_OBJECT
-
+    // OutputTargetState is what a calculation resolved an output to. It is a plain value so the layout can keep them all in one contiguous
+    // list and rebuild them in place.
+    class OutputTargetState {
     public:
-        OutputTargetState(QString serial, QObject *parent = nullptr);
+        explicit OutputTargetState(OutputId output_id = OutputId::Invalid);
 
+        OutputId getOutputId() const;
         QString getSerial() const;
         bool isOn() const;
         QSize getDimensions() const;
-        QString getMirrorOf() const;
+        OutputId getMirrorOf() const;
         qulonglong getRefresh() const;
-        QString getRelative() const;
+        OutputId getRelative() const;
         ConfigurationHorizontalAnchor getHorizontalAnchor() const;
         ConfigurationVerticalAnchor getVerticalAnchor() const;
         QPoint getPosition() const;
@@ -32,13 +33,13 @@ namespace bd {
         QSize getResultingDimensions() const;
         uint32_t getAdaptiveSync() const;
 
-        void setDefaultValues(QSharedPointer<WaylandOutputMetaHead> head);
+        void setDefaultValues(const QSharedPointer<WaylandOutputMetaHead> &head);
 
         void setOn(bool on);
         void setDimensions(QSize dimensions);
         void setRefresh(qulonglong refresh);
-        void setMirrorOf(const QString& mirrorOf);
-        void setRelative(const QString& relative);
+        void setMirrorOf(OutputId mirrorOf);
+        void setRelative(OutputId relative);
         void setHorizontalAnchor(ConfigurationHorizontalAnchor horizontal_anchor);
         void setVerticalAnchor(ConfigurationVerticalAnchor vertical_anchor);
         void setPosition(QPoint position);
@@ -50,19 +51,19 @@ namespace bd {
         void updateResultingDimensions();
 
     private:
-        QString m_serial;
-        bool m_on;
-        QSize m_dimensions;
+        OutputId m_output_id;
+        bool m_on = false;
+        QSize m_dimensions = QSize(0, 0);
         QSize m_resulting_dimensions;
-        qulonglong m_refresh;
-        QString m_mirrorOf;
-        QString m_relative;
-        ConfigurationHorizontalAnchor m_horizontal_anchor;
-        ConfigurationVerticalAnchor m_vertical_anchor;
-        bool m_primary;
-        QPoint m_position;
-        qreal m_scale;
-        quint8 m_transform;
-        uint32_t m_adaptive_sync;
+        qulonglong m_refresh = 0;
+        OutputId m_mirrorOf = OutputId::Invalid;
+        OutputId m_relative = OutputId::Invalid;
+        ConfigurationHorizontalAnchor m_horizontal_anchor = ConfigurationHorizontalAnchor::NoHorizontalAnchor;
+        ConfigurationVerticalAnchor m_vertical_anchor = ConfigurationVerticalAnchor::NoVerticalAnchor;
+        bool m_primary = false;
+        QPoint m_position = QPoint(0, 0);
+        qreal m_scale = 1.0;
+        quint8 m_transform = 0;
+        uint32_t m_adaptive_sync = 0;
     };
 }
\ No newline at end of file
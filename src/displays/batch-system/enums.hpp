@@ -28,4 +28,11 @@ namespace bd {
         Right, // Right edge of serial is at the right edge of relative
         Center, // Center of serial is at the center of relative
     };
+
+    // ConfigurationModePolicy is how we pick a mode for an output we have no configuration for
+    enum class ConfigurationModePolicy {
+        Native, // Highest refresh at the output's native size
+        Preferred, // Whatever mode the output says it prefers
+        HighestRefresh, // Highest refresh at any size, largest size among those
+    };
 }
\ No newline at end of file
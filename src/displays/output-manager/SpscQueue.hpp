@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace bd {
+  // SpscQueue is a bounded, lock-free ring buffer for handing values from exactly one producer thread to exactly one consumer thread.
+  template <typename T, std::size_t Capacity>
+  class SpscQueue {
+      static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+      // push moves value into the queue. Returns false (leaving value untouched) when the queue is full.
+      bool push(T&& value) {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+
+        m_slots[tail & (Capacity - 1)] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+      }
+
+      // pop moves the oldest value into value. Returns false when the queue is empty.
+      bool pop(T& value) {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        auto& slot = m_slots[head & (Capacity - 1)];
+        value      = std::move(slot);
+        slot       = T {};  // Drop anything the moved-from slot still references
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+      }
+
+      bool isEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+    private:
+      std::array<T, Capacity>              m_slots {};
+      alignas(64) std::atomic<std::size_t> m_head {0};
+      alignas(64) std::atomic<std::size_t> m_tail {0};
+  };
+}
@@ -0,0 +1,79 @@
+#include "WaylandEventThread.hpp"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <cerrno>
+
+namespace bd {
+  WaylandEventThread::WaylandEventThread(wl_display* display, wl_event_queue* queue, QObject* parent)
+      : QThread(parent), m_display(display), m_queue(queue), m_wake_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), m_running(true) {
+    setObjectName("WaylandEventThread");
+  }
+
+  WaylandEventThread::~WaylandEventThread() {
+    stop();
+    if (m_wake_fd >= 0) close(m_wake_fd);
+  }
+
+  void WaylandEventThread::stop() {
+    m_running.store(false);
+    if (!isRunning()) return;
+
+    // Kick the thread out of poll()
+    uint64_t one = 1;
+    if (write(m_wake_fd, &one, sizeof(one)) < 0) qWarning() << "Failed to wake Wayland event thread, errno:" << errno;
+    wait();
+  }
+
+  bool WaylandEventThread::isStopRequested() const {
+    return !m_running.load();
+  }
+
+  void WaylandEventThread::run() {
+    while (m_running.load()) {
+      // Dispatch anything already queued, prepare_read_queue only succeeds once our queue is empty
+      while (wl_display_prepare_read_queue(m_display, m_queue) != 0) {
+        if (wl_display_dispatch_queue_pending(m_display, m_queue) < 0) {
+          qCritical() << "Failed to dispatch Wayland event queue, error:" << wl_display_get_error(m_display);
+          return;
+        }
+      }
+
+      wl_display_flush(m_display);
+
+      pollfd fds[2] = {
+          {wl_display_get_fd(m_display), POLLIN, 0},
+          {m_wake_fd, POLLIN, 0},
+      };
+
+      if (poll(fds, 2, -1) < 0) {
+        wl_display_cancel_read(m_display);
+        if (errno == EINTR) continue;
+        qCritical() << "Failed to poll Wayland display, errno:" << errno;
+        return;
+      }
+
+      if (fds[0].revents & POLLIN) {
+        if (wl_display_read_events(m_display) < 0) {
+          qCritical() << "Failed to read Wayland events, error:" << wl_display_get_error(m_display);
+          return;
+        }
+      } else {
+        wl_display_cancel_read(m_display);
+      }
+
+      if (fds[0].revents & (POLLERR | POLLHUP)) {
+        qCritical() << "Wayland display hung up, stopping event thread";
+        return;
+      }
+
+      if (wl_display_dispatch_queue_pending(m_display, m_queue) < 0) {
+        qCritical() << "Failed to dispatch Wayland event queue, error:" << wl_display_get_error(m_display);
+        return;
+      }
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <QThread>
+#include <atomic>
+
+namespace bd {
+  // WaylandEventThread drains a private wl_event_queue off the main thread. Proxies assigned to that queue have their listeners invoked on this thread.
+  class WaylandEventThread : public QThread {
+      Q_OBJECT
+
+    public:
+      WaylandEventThread(wl_display* display, wl_event_queue* queue, QObject* parent = nullptr);
+      ~WaylandEventThread() override;
+
+      void stop();
+      bool isStopRequested() const;
+
+    protected:
+      void run() override;
+
+    private:
+      wl_display*       m_display;
+      wl_event_queue*   m_queue;
+      int               m_wake_fd;
+      std::atomic<bool> m_running;
+  };
+}
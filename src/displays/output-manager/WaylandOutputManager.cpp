@@ -1,14 +1,21 @@
 #include "WaylandOutputManager.hpp"
 
-#include <KWayland/Client/registry.h>
 #include <qcryptographichash.h>
 
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QTimer>
+
+#include "WaylandProtocolRecorder.hpp"
+#include "displays/batch-system/ConfigurationBatchSystem.hpp"
+
+#include <QThread>
 #include <cstdint>
 #include <cstring>
 
 namespace bd {
   WaylandOrchestrator::WaylandOrchestrator(QObject* parent)
-      : QObject(parent), m_registry(nullptr), m_display(nullptr), m_manager(nullptr), m_has_serial(false), m_serial(0), m_has_initted(false) {}
+      : QObject(parent), m_registry(nullptr), m_display(nullptr), m_notifier(nullptr), m_event_queue(nullptr), m_event_thread(nullptr), m_replay(nullptr), m_manager(nullptr), m_has_serial(false), m_serial(0), m_has_initted(false), m_use_event_thread(false), m_reconnecting(false), m_reconnect_delay(MinReconnectDelay) {}
 
   WaylandOrchestrator& WaylandOrchestrator::instance() {
     static WaylandOrchestrator _instance(nullptr);
@@ -16,40 +23,253 @@ namespace bd {
   }
 
   void WaylandOrchestrator::init() {
-    auto display = wl_display_connect(nullptr);
-    if (display == nullptr) {
-      emit orchestratorInitFailed(QString("Failed to connect to the Wayland display"));
+    // Debugging aids: record every output management event we receive, or replay such a recording instead of talking to a compositor
+    auto replay_path = qEnvironmentVariable("BUDGIE_DAEMON_WAYLAND_REPLAY");
+    if (!replay_path.isEmpty()) {
+      startReplay(replay_path);
+      return;
+    }
+
+    auto record_path = qEnvironmentVariable("BUDGIE_DAEMON_WAYLAND_RECORD");
+    if (!record_path.isEmpty()) {
+      WaylandProtocolRecorder::instance().start(record_path);
+      connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, []() { WaylandProtocolRecorder::instance().stop(); });
+    }
+
+    // Opt-in: dispatch the output management objects on their own queue and thread so hotplug bursts never compete with D-Bus on the main thread
+    m_use_event_thread = qEnvironmentVariableIntValue("BUDGIE_DAEMON_WAYLAND_EVENT_THREAD") == 1;
+    if (m_use_event_thread) qInfo() << "Dispatching output management events on a dedicated thread";
+
+    // The registry (and the output manager bound through it) outlive any single display connection, see handleDisconnect
+    m_registry = new WaylandRegistry();
+
+    connect(m_registry, &WaylandRegistry::interfaceAnnounced, this, [this](const QByteArray& interface, quint32 name, quint32 version) {
+      if (std::strcmp(interface, QtWayland::zwlr_output_manager_v1::interface()->name) == 0) {
+        // Never bind a newer version than the compositor advertises, the version decides which requests (like release) we may send
+        auto bind_version = qMin(version, static_cast<quint32>(QtWayland::zwlr_output_manager_v1::interface()->version));
+        if (m_manager) {
+          // Reconnected: bind the manager we already have, its meta heads are matched up with the new heads by identifier
+          m_manager->bind(m_registry, name, bind_version, m_event_queue);
+        } else {
+          watchManager(new WaylandOutputManager(nullptr, m_registry, name, bind_version, m_event_queue));
+        }
+
+        // The bind has not been flushed yet and nothing else reads the display before we return, so the manager is already on its own queue
+        // by the time the thread can see any of its events
+        if (m_event_queue != nullptr) startEventThread();
+      }
+    });
+
+    // The registry's initial sync has completed, if the output manager wasn't among the globals we will never become ready
+    connect(m_registry, &WaylandRegistry::interfacesAnnounced, this, [this]() {
+      if (!m_manager || !m_manager->isBound()) emit orchestratorInitFailed(QString("Compositor does not support wlr-output-management"));
+    });
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &WaylandOrchestrator::stopEventThread);
+
+    auto error = connectDisplay();
+    if (!error.isNull()) emit orchestratorInitFailed(error);
+  }
+
+  void WaylandOrchestrator::watchManager(WaylandOutputManager* manager) {
+    connect(manager, &WaylandOutputManager::done, this, &WaylandOrchestrator::outputManagerDone);
+    connect(manager, &WaylandOutputManager::headsChanged, this, [this]() {
+      // The initial set of heads is announced through ready, which follows on the first done. After a reconnect we only report a change
+      // once the whole topology has been compared against what we had before.
+      if (m_has_initted && !m_reconnecting) emit outputsChanged();
+    });
+
+    // How long (in seconds) a disconnected output is remembered for, in case it comes back
+    auto has_max_age = false;
+    auto max_age     = qEnvironmentVariableIntValue("BUDGIE_DAEMON_OUTPUT_TOMBSTONE_AGE", &has_max_age);
+    if (has_max_age && max_age >= 0) manager->setTombstoneMaxAge(qint64 {max_age} * 1000);
+
+    m_manager = QSharedPointer<WaylandOutputManager>(manager);
+  }
+
+  // startReplay drives the daemon from a protocol log instead of a compositor. Events are replayed once the event loop is running, as fast as
+  // they can be processed, so ready and everything that follows from it happen just like they would for a live connection.
+  void WaylandOrchestrator::startReplay(const QString& path) {
+    qInfo() << "Replaying Wayland output management events from" << path;
+    m_replay   = new WaylandProtocolReplay(this);
+    auto error = m_replay->open(path);
+    if (!error.isNull()) {
+      emit orchestratorInitFailed(error);
       return;
     }
 
+    m_display = m_replay->getDisplay();
+    m_startup_timer.start();
+    watchManager(m_replay->createManager());
+    QTimer::singleShot(0, m_replay, &WaylandProtocolReplay::run);
+  }
+
+  // connectDisplay connects to the Wayland display and starts the registry handshake, returning an error message if that failed. Nothing blocks
+  // from here on: globals, heads and the first done are dispatched from the event loop (or the event thread), and ready is emitted once that first
+  // done has been committed.
+  QString WaylandOrchestrator::connectDisplay() {
+    auto display = wl_display_connect(nullptr);
+    if (display == nullptr) return QString("Failed to connect to the Wayland display");
+
     m_display = display;
+    m_startup_timer.start();
+
+    if (m_use_event_thread) m_event_queue = wl_display_create_queue(m_display);
 
-    m_registry = new KWayland::Client::Registry();
     m_registry->create(m_display);  // Create using our existing display connection
 
     if (!m_registry->isValid()) {
-      wl_display_disconnect(m_display);
       m_registry->release();
-      emit orchestratorInitFailed(QString("Failed to create our KWayland registry and manage it"));
-      return;
+      if (m_event_queue != nullptr) wl_event_queue_destroy(m_event_queue);
+      m_event_queue = nullptr;
+      wl_display_disconnect(m_display);
+      m_display = nullptr;
+      return QString("Failed to create our registry and manage it");
     }
 
-    connect(m_registry, &KWayland::Client::Registry::interfaceAnnounced, this, [this](const QByteArray& interface, quint32 name, quint32 version) {
-      if (std::strcmp(interface, QtWayland::zwlr_output_manager_v1::interface()->name) == 0) {
-        auto manager = new WaylandOutputManager(nullptr, m_registry, name, QtWayland::zwlr_output_manager_v1::interface()->version);
-        connect(manager, &WaylandOutputManager::done, this, &WaylandOrchestrator::outputManagerDone);
-        m_manager = QSharedPointer<WaylandOutputManager>(manager);
+    m_registry->setup();
+    setupEventDispatch();
+    return QString();
+  }
+
+  // handleDisconnect tears down everything tied to a display connection that has failed (typically because the compositor crashed or restarted),
+  // keeping our meta heads so their D-Bus objects survive, and starts trying to reconnect.
+  void WaylandOrchestrator::handleDisconnect() {
+    if (m_display == nullptr) return;  // Already torn down, a reconnect is pending
+    qWarning() << "Lost connection to the Wayland display, error:" << wl_display_get_error(m_display);
+
+    if (m_notifier != nullptr) {
+      m_notifier->setEnabled(false);
+      m_notifier->deleteLater();
+      m_notifier = nullptr;
+    }
+
+    if (m_event_thread != nullptr) {
+      m_event_thread->stop();
+      m_event_thread->deleteLater();
+      m_event_thread = nullptr;
+    }
+
+    if (m_manager) {
+      if (m_has_initted) m_cached_state = captureOutputState();
+      m_manager->unbind();
+    }
+
+    m_registry->release();
+    if (m_event_queue != nullptr) wl_event_queue_destroy(m_event_queue);
+    m_event_queue = nullptr;
+    wl_display_disconnect(m_display);
+    m_display = nullptr;
+
+    m_reconnecting = true;
+    scheduleReconnect();
+  }
+
+  void WaylandOrchestrator::scheduleReconnect() {
+    qInfo() << "Reconnecting to the Wayland display in" << m_reconnect_delay << "ms";
+    QTimer::singleShot(m_reconnect_delay, this, &WaylandOrchestrator::reconnect);
+    m_reconnect_delay = qMin(m_reconnect_delay * 2, MaxReconnectDelay);
+  }
+
+  void WaylandOrchestrator::reconnect() {
+    auto error = connectDisplay();
+    if (error.isNull()) return;  // The rest of the handshake completes in outputManagerDone
+
+    qWarning() << "Failed to reconnect to the Wayland display:" << error;
+    scheduleReconnect();
+  }
+
+  // captureOutputState records what is live on every available output, so we can tell whether a compositor restart left them as they were
+  QHash<QString, WaylandOutputState> WaylandOrchestrator::captureOutputState() {
+    auto states = QHash<QString, WaylandOutputState> {};
+    if (!m_manager) return states;
+
+    for (const auto& head : m_manager->getHeads()) {
+      if (head.isNull() || !head->isAvailable()) continue;
+
+      auto state = WaylandOutputState {
+          .enabled   = head->isEnabled(),
+          .position  = head->getPosition(),
+          .scale     = head->getScale(),
+          .transform = head->getTransform(),
+      };
+
+      auto mode = head->getCurrentMode();
+      if (mode) {
+        state.size    = mode.getSize().value_or(QSize {});
+        state.refresh = mode.getRefresh().value_or(0);
       }
+
+      states.insert(head->getIdentifier(), state);
+    }
+
+    return states;
+  }
+
+  void WaylandOrchestrator::startEventThread() {
+    auto thread = new WaylandEventThread(m_display, m_event_queue, this);
+
+    // The thread only stops by itself when the connection has failed
+    connect(thread, &QThread::finished, this, [this, thread]() {
+      if (thread == m_event_thread && !thread->isStopRequested()) handleDisconnect();
     });
 
-    m_registry->setup();
+    m_event_thread = thread;
+    m_event_thread->start();
+  }
+
+  void WaylandOrchestrator::stopEventThread() {
+    if (m_event_thread == nullptr) return;
+    m_event_thread->stop();
+  }
+
+  // setupEventDispatch hooks our wl_display fd into the Qt event loop so compositor events (hotplugs, configuration results) are dispatched as they
+  // arrive rather than only when something performs a blocking roundtrip.
+  void WaylandOrchestrator::setupEventDispatch() {
+    m_notifier = new QSocketNotifier(wl_display_get_fd(m_display), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &WaylandOrchestrator::dispatchEvents);
+
+    // Requests are only written out on flush, so make sure anything queued during this loop iteration is sent before we go idle
+    auto dispatcher = QAbstractEventDispatcher::instance(QCoreApplication::instance()->thread());
+    if (dispatcher) connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, &WaylandOrchestrator::flushEvents, Qt::UniqueConnection);
+
+    flushEvents();
+  }
+
+  void WaylandOrchestrator::dispatchEvents() {
+    if (m_display == nullptr) return;
+
+    // prepare_read only succeeds once the default queue is empty, so drain whatever is already queued first
+    while (wl_display_prepare_read(m_display) != 0) {
+      if (wl_display_dispatch_pending(m_display) < 0) {
+        qCritical() << "Failed to dispatch pending Wayland events, error:" << wl_display_get_error(m_display);
+        handleDisconnect();
+        return;
+      }
+    }
 
-    if (wl_display_roundtrip(m_display) < 0) {
-      emit orchestratorInitFailed(QString("Failed to perform roundtrip on Wayland display"));
+    // The notifier told us the fd is readable, so this will not block
+    if (wl_display_read_events(m_display) < 0) {
+      qCritical() << "Failed to read Wayland events, error:" << wl_display_get_error(m_display);
+      handleDisconnect();
       return;
     }
 
-    wl_display_dispatch(m_display);
+    if (wl_display_dispatch_pending(m_display) < 0) {
+      qCritical() << "Failed to dispatch Wayland events, error:" << wl_display_get_error(m_display);
+      handleDisconnect();
+      return;
+    }
+
+    wl_display_flush(m_display);
+  }
+
+  void WaylandOrchestrator::flushEvents() {
+    if (m_display == nullptr || m_notifier == nullptr || !m_notifier->isEnabled()) return;
+
+    // Events may have been queued by a read elsewhere (e.g. a roundtrip), dispatch them before sleeping on the fd
+    wl_display_dispatch_pending(m_display);
+    wl_display_flush(m_display);
   }
 
   QSharedPointer<WaylandOutputManager> WaylandOrchestrator::getManager() {
@@ -60,7 +280,7 @@ namespace bd {
     return m_display;
   }
 
-  KWayland::Client::Registry* WaylandOrchestrator::getRegistry() {
+  WaylandRegistry* WaylandOrchestrator::getRegistry() {
     return m_registry;
   }
 
@@ -72,58 +292,349 @@ namespace bd {
     return m_serial;
   }
 
+  bool WaylandOrchestrator::isEventThreadEnabled() {
+    return m_use_event_thread;
+  }
+
   void WaylandOrchestrator::outputManagerDone() {
-    if (!m_has_initted) emit ready();  // Haven't done our first init, emit that we are ready
-    m_has_initted = true;
+    if (!m_has_initted) {
+      // Haven't done our first init, emit that we are ready
+      m_has_initted     = true;
+      m_reconnecting    = false;  // Lost the connection before we ever became ready, this is still our first init
+      m_reconnect_delay = MinReconnectDelay;
+      qInfo() << "Wayland connect to ready took" << m_startup_timer.elapsed() << "ms";
+      m_startup_timer.restart();
+
+      connect(
+          &ConfigurationBatchSystem::instance(), &ConfigurationBatchSystem::configurationApplied, this,
+          [this](bool success) {
+            qInfo() << "Ready to first configuration apply took" << m_startup_timer.elapsed() << "ms, success:" << success;
+          },
+          Qt::SingleShotConnection);
+
+      emit ready();
+    } else if (m_reconnecting) {
+      m_reconnecting    = false;
+      m_reconnect_delay = MinReconnectDelay;
+      qInfo() << "Wayland reconnect to ready took" << m_startup_timer.elapsed() << "ms";
+
+      // The compositor may have restored the layout we had configured by itself, only re-apply if it did not
+      if (captureOutputState() != m_cached_state) {
+        qInfo() << "Outputs differ from before the connection was lost, re-applying configuration";
+        emit outputsChanged();
+      } else {
+        qInfo() << "Outputs match their state from before the connection was lost, not re-applying configuration";
+      }
+
+      m_cached_state.clear();
+    }
+
     emit done();
   }
 
-  WaylandOutputManager::WaylandOutputManager(QObject* parent, KWayland::Client::Registry* registry, uint32_t serial, uint32_t version)
+  WaylandOutputManager::WaylandOutputManager(QObject* parent, WaylandRegistry* registry, uint32_t serial, uint32_t version, wl_event_queue* queue)
       : QObject(parent),
-        zwlr_output_manager_v1(registry->registry(), serial, static_cast<int>(version)),
+        zwlr_output_manager_v1(),
         m_registry(registry),
+        m_tombstone_max_age(DefaultTombstoneMaxAge),
+        m_topology(WaylandOutputTopology::build({}, 0)),
+        m_topology_generation(0),
         m_serial(serial),
         m_has_serial(true),
-        m_version(version) {}
+        m_version(version),
+        m_bound(false),
+        m_threaded(queue != nullptr),
+        m_snapshot_slots(SnapshotCapacity) {
+    bind(registry, serial, version, queue);
+  }
 
-  // Overridden methods from QtWayland::zwlr_output_manager_v1
-  void WaylandOutputManager::zwlr_output_manager_v1_head(zwlr_output_head_v1* wlr_head) {
-    auto head = new WaylandOutputMetaHead(nullptr, m_registry);
-    qInfo() << "WaylandOutputManager::zwlr_output_manager_v1_head with id:" << head->getIdentifier() << ", description:" << head->getDescription();
-
-    connect(head, &WaylandOutputMetaHead::headAvailable, this, [this, head]() {
-        qDebug() << "Head available for output: " << head->getIdentifier();
-        bool headAlreadyExists = false;
-        for (const auto& existingHead : m_heads) {
-            qDebug() << "Checking existing head: " << existingHead->getIdentifier();
-          if (existingHead->getIdentifier() == head->getIdentifier()) {
-            qDebug() << "Head already exists for output: " << head->getIdentifier();
-            headAlreadyExists = true;
-            existingHead->setHead(head->getWlrHead().value());
-            break;
-          }
-        }
+  WaylandOutputManager::WaylandOutputManager(QObject* parent, ::zwlr_output_manager_v1* manager)
+      : QObject(parent),
+        zwlr_output_manager_v1(manager),
+        m_registry(nullptr),
+        m_tombstone_max_age(DefaultTombstoneMaxAge),
+        m_topology(WaylandOutputTopology::build({}, 0)),
+        m_topology_generation(0),
+        m_serial(0),
+        m_has_serial(false),
+        m_version(wl_proxy_get_version(reinterpret_cast<wl_proxy*>(manager))),
+        m_bound(true),
+        m_threaded(false),
+        m_snapshot_slots(SnapshotCapacity) {}
+
+  void WaylandOutputManager::bind(WaylandRegistry* registry, uint32_t name, uint32_t version, wl_event_queue* queue) {
+    init(registry->registry(), static_cast<int>(name), static_cast<int>(version));
+    m_registry = registry;
+    m_version  = version;
+    m_threaded = queue != nullptr;
+    m_bound    = true;
+
+    // Nothing has been flushed since the bind, so no events can have been queued for us on the default queue yet. Heads and modes created from
+    // our events inherit this queue, configurations are moved back to the default one in configure().
+    if (queue != nullptr) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(object()), queue);
+  }
+
+  // unbind forgets every protocol object belonging to a connection that has gone away. Nothing can be sent on it anymore, so the proxies are
+  // destroyed directly. Meta heads are kept (and marked unavailable) so the next bind matches them up with the new heads by identifier.
+  void WaylandOutputManager::unbind() {
+    if (!m_bound) return;
+
+    // Transactions the event thread published but the main thread never got to
+    auto snapshot = WaylandOutputManagerSnapshot {};
+    while (m_snapshots.pop(snapshot)) {
+      m_snapshot_slots.release();
+      abandonSnapshot(snapshot);
+    }
 
-        if (!headAlreadyExists) {
-            qDebug() << "Adding new head for output: " << head->getIdentifier();
-            m_heads.append(QSharedPointer<WaylandOutputMetaHead>(head));
-        }
-    });
+    for (const auto& meta_head : m_heads) {
+      meta_head->unsetModes();
+      if (meta_head->isAvailable()) meta_head->headDisconnected();
+    }
+    m_meta_heads_by_head.clear();
+
+    for (const auto& head : m_pending_heads) head->abandon();
+    m_pending_heads.clear();
+
+    wl_proxy_destroy(reinterpret_cast<wl_proxy*>(object()));
+    m_bound = false;
+    publishTopology();
+  }
+
+  bool WaylandOutputManager::isBound() {
+    return m_bound;
+  }
 
-    head->setHead(wlr_head);
+  // Overridden methods from QtWayland::zwlr_output_manager_v1
+  void WaylandOutputManager::zwlr_output_manager_v1_head(zwlr_output_head_v1* wlr_head) {
+    auto& recorder = WaylandProtocolRecorder::instance();
+    if (recorder.isRecording()) {
+      recorder.record(WaylandProtocolEvent::ManagerHead, object(), static_cast<qint32>(wl_proxy_get_id(reinterpret_cast<wl_proxy*>(wlr_head))));
+    }
+    // Only record here, the head is matched up with a meta head once its first transaction is committed on done
+    auto head = QSharedPointer<WaylandOutputHead>(new WaylandOutputHead(nullptr, wlr_head));
+    // On the event thread the wrapper is created here, but committed, released and destroyed by the main thread, so it belongs to the latter
+    if (head->thread() != thread()) head->moveToThread(thread());
+    m_pending_heads.append(head);
   }
 
   void WaylandOutputManager::zwlr_output_manager_v1_finished() {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ManagerFinished, object());
     qInfo() << "WaylandOutputManager::zwlr_output_manager_v1_finished";
   }
 
   void WaylandOutputManager::zwlr_output_manager_v1_done(uint32_t serial) {
-    m_serial     = serial;
-    m_has_serial = true;
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ManagerDone, object(), static_cast<qint32>(serial));
+    auto snapshot = takeSnapshot(serial);
+
+    if (m_threaded) {
+      // Event thread: hand the transaction to the main thread, which owns the meta heads. If it is too far behind to take it, the thread is
+      // being stopped and the connection is going away with it.
+      if (!acquireSnapshotSlot()) {
+        abandonSnapshot(snapshot);
+        return;
+      }
+      m_snapshots.push(std::move(snapshot));
+      QMetaObject::invokeMethod(this, &WaylandOutputManager::drainSnapshots, Qt::QueuedConnection);
+      return;
+    }
 
+    auto heads_changed = applySnapshot(snapshot);
+    compactHeads();
+    publishTopology();
+    if (heads_changed) emit headsChanged();
     emit done();
   }
 
+  // takeSnapshot packages up everything that changed in the transaction ending with this done, and forgets heads that have finished
+  WaylandOutputManagerSnapshot WaylandOutputManager::takeSnapshot(uint32_t serial) {
+    auto snapshot = WaylandOutputManagerSnapshot {.serial = serial};
+    for (auto it = m_pending_heads.begin(); it != m_pending_heads.end();) {
+      const auto& head = *it;
+      if (head->isDirty()) {
+        auto head_snapshot = head->takeSnapshot();
+        head_snapshot.head = head;
+        snapshot.heads.append(head_snapshot);
+      }
+
+      if (head->isFinished()) {
+        it = m_pending_heads.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    return snapshot;
+  }
+
+  // acquireSnapshotSlot blocks the event thread until m_snapshots has room for another transaction, so a main thread that fell behind holds the
+  // event thread back rather than have it spin. Returns false if the event thread was asked to stop while waiting.
+  bool WaylandOutputManager::acquireSnapshotSlot() {
+    auto event_thread = qobject_cast<WaylandEventThread*>(QThread::currentThread());
+    while (!m_snapshot_slots.tryAcquire(1, SnapshotSlotWait)) {
+      if (event_thread != nullptr && event_thread->isStopRequested()) return false;
+    }
+    return true;
+  }
+
+  // abandonSnapshot destroys the proxies a transaction that will never be committed was handing over, for when the connection is going away
+  void WaylandOutputManager::abandonSnapshot(const WaylandOutputManagerSnapshot& snapshot) {
+    for (const auto& head_snapshot : snapshot.heads) {
+      for (const auto& mode : head_snapshot.removed_modes) mode->abandon();
+      if (head_snapshot.finished) head_snapshot.head->abandon();
+    }
+  }
+
+  void WaylandOutputManager::drainSnapshots() {
+    auto snapshot      = WaylandOutputManagerSnapshot {};
+    auto drained       = false;
+    auto heads_changed = false;
+    while (m_snapshots.pop(snapshot)) {
+      m_snapshot_slots.release();
+      if (applySnapshot(snapshot)) heads_changed = true;
+      drained = true;
+    }
+
+    // A burst of transactions is coalesced into a single done
+    if (drained) compactHeads();
+    if (drained) publishTopology();
+    if (heads_changed) emit headsChanged();
+    if (drained) emit done();
+  }
+
+  // applySnapshot commits a transaction to our meta heads, returning whether any head was connected or disconnected by it
+  bool WaylandOutputManager::applySnapshot(const WaylandOutputManagerSnapshot& snapshot) {
+    auto heads_changed = false;
+    m_serial           = snapshot.serial;
+    m_has_serial       = true;
+
+    for (const auto& head_snapshot : snapshot.heads) {
+      auto wrapper   = head_snapshot.head.data();
+      auto meta_head = m_meta_heads_by_head.value(wrapper);
+      // Only set for a meta head created by this snapshot, which then doesn't have to generate the identifier all over again
+      auto new_identifier = QString();
+
+      if (meta_head.isNull()) {
+        // First snapshot for this head carries its identifying properties, reuse the meta head if we have seen this output before
+        auto identifier =
+            WaylandOutputMetaHead::generateIdentifier(head_snapshot.serial, head_snapshot.make, head_snapshot.model, head_snapshot.name);
+        meta_head = findHead(OutputIdTable::instance().find(identifier));
+        if (meta_head.isNull()) {
+          qDebug() << "Adding new head for output: " << identifier;
+          new_identifier = identifier;
+          meta_head      = QSharedPointer<WaylandOutputMetaHead>(new WaylandOutputMetaHead(nullptr, m_registry));
+          m_head_index.insert(OutputIdTable::instance().intern(identifier), m_heads.size());
+          m_heads.append(meta_head);
+          watchHead(meta_head);
+        } else if (!meta_head->isAvailable()) {
+          qDebug() << "Reviving head for output: " << identifier;
+        } else {
+          qDebug() << "Head already exists for output: " << identifier;
+        }
+
+        meta_head->setHead(head_snapshot.head);
+        m_meta_heads_by_head.insert(wrapper, meta_head);
+        heads_changed = true;
+      }
+
+      auto previous_id = meta_head->getOutputId();
+      meta_head->commit(head_snapshot, new_identifier);
+
+      // Identifying properties changed after we indexed this head, move it over to its new identifier. Group matching keys on identifiers,
+      // so this counts as a change to our heads.
+      if (previous_id != OutputId::Invalid && previous_id != meta_head->getOutputId()) {
+        rekeyHead(meta_head, previous_id);
+        heads_changed = true;
+      }
+
+      // Nothing refers to these proxies anymore now the meta head has committed, let the compositor know we are done with them
+      for (const auto& mode : head_snapshot.removed_modes) mode->releaseProxy();
+
+      if (head_snapshot.finished) {
+        head_snapshot.head->releaseProxy();
+        m_meta_heads_by_head.remove(wrapper);
+        heads_changed = true;
+      }
+    }
+
+    return heads_changed;
+  }
+
+  // compactHeads forgets heads that have been disconnected for longer than m_tombstone_max_age. Heads stay in the order we first saw them, so
+  // the positions in the index are moved along if anything was removed. The index isn't rebuilt from identifiers, a head that lost its
+  // identifier to another (see rekeyHead) must not get it back.
+  void WaylandOutputManager::compactHeads() {
+    auto positions = QList<qsizetype>(m_heads.size(), -1);
+    auto kept      = qsizetype {0};
+    for (qsizetype i = 0; i < m_heads.size(); ++i) {
+      const auto& head            = m_heads.at(i);
+      auto        unavailable_for = head->getUnavailableFor();
+      if (unavailable_for < 0 || unavailable_for < m_tombstone_max_age) {
+        positions[i] = kept++;
+        continue;
+      }
+      qDebug() << "Compacting head for output" << head->getIdentifier() << "disconnected" << unavailable_for << "ms ago";
+      head->disconnect(this);
+    }
+    if (kept == m_heads.size()) return;
+
+    for (qsizetype i = m_heads.size() - 1; i >= 0; --i) {
+      if (positions.at(i) < 0) m_heads.removeAt(i);
+    }
+    for (auto it = m_head_index.begin(); it != m_head_index.end();) {
+      auto position = positions.at(it.value());
+      if (position < 0) {
+        it = m_head_index.erase(it);
+      } else {
+        it.value() = position;
+        ++it;
+      }
+    }
+  }
+
+  // watchHead republishes our topology when a head's metadata is changed outside of a compositor transaction (anchoring, primary and so on)
+  void WaylandOutputManager::watchHead(const QSharedPointer<WaylandOutputMetaHead>& head) {
+    connect(head.data(), &WaylandOutputMetaHead::metadataChanged, this, &WaylandOutputManager::publishTopology);
+  }
+
+  // publishTopology replaces the published topology if any head changed since the last one, bumping the global generation. A done that
+  // changed nothing leaves the generation where it was, so clients comparing it don't re-read everything.
+  void WaylandOutputManager::publishTopology() {
+    auto topology = WaylandOutputTopology::build(m_heads, m_topology_generation + 1);
+    auto current  = m_topology.load(std::memory_order_relaxed);
+    if (current && current->hasSameGenerations(*topology)) return;
+
+    m_topology_generation++;
+    m_topology.store(topology, std::memory_order_release);
+  }
+
+  std::shared_ptr<const WaylandOutputTopology> WaylandOutputManager::getTopology() const {
+    return m_topology.load(std::memory_order_acquire);
+  }
+
+  // rekeyHead moves head over to the identifier it now has, from previous. Should another head already have that identifier, the head that
+  // just took it keeps it and the other is tombstoned: disconnected if it was connected, and left to be compacted without an identifier.
+  void WaylandOutputManager::rekeyHead(const QSharedPointer<WaylandOutputMetaHead>& head, OutputId previous) {
+    auto position = qsizetype {-1};
+    auto indexed  = m_head_index.find(previous);
+    if (indexed != m_head_index.end() && m_heads.at(indexed.value()) == head) {
+      position = indexed.value();
+      m_head_index.erase(indexed);
+    } else {
+      // This head already lost its previous identifier to another head
+      position = m_heads.indexOf(head);
+    }
+    if (position < 0) return;
+
+    auto current  = head->getOutputId();
+    auto existing = m_head_index.constFind(current);
+    if (existing != m_head_index.constEnd()) {
+      auto older = m_heads.at(existing.value());
+      qWarning() << "Head" << previous << "now has identifier" << current << "which already belongs to another head, tombstoning that head";
+      if (older->isAvailable()) older->headDisconnected();
+    }
+    m_head_index.insert(current, position);
+  }
+
   // applyNoOpConfigurationForNonSpecifiedHeads is a bit of a funky function, but effectively it applies a configuration that does nothing for every output
   // excluding the ones we are wanting to change (specified by the serial). This is to ensure we don't create protocol errors when performing output
   // configurations, as it is a protocol error to not specify everything else.
@@ -134,6 +645,8 @@ namespace bd {
     qDebug() << "Applying no-op configuration for non-specified heads. Ignoring:" << serials.join(", ");
 
     for (const auto& o : m_heads) {
+      // Disconnected heads have nothing to configure
+      if (!o->isAvailable()) continue;
       qDebug() << "Checking head " << o->getIdentifier() << ": " << o->getDescription();
       // Skip the output for the serial we are changing
       if (serials.contains(o->getIdentifier())) {
@@ -159,7 +672,14 @@ namespace bd {
   }
 
   QSharedPointer<WaylandOutputConfiguration> WaylandOutputManager::configure() {
+    if (!m_bound) {
+      qWarning() << "Not connected to the compositor, cannot create an output configuration";
+      return nullptr;
+    }
+
     auto wlr_output_configuration = create_configuration(m_serial);
+    // New proxies inherit our queue, but a configuration is applied and answered on the main thread, never on the event thread
+    if (m_threaded) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(wlr_output_configuration), nullptr);
     auto config                   = new WaylandOutputConfiguration(nullptr, wlr_output_configuration);
     connect(config, &WaylandOutputConfiguration::cancelled, this, [this, config]() {
       qDebug() << "Configuration cancelled";
@@ -177,15 +697,29 @@ namespace bd {
   }
 
   QList<QSharedPointer<WaylandOutputMetaHead>> WaylandOutputManager::getHeads() {
-    return m_heads;
+    auto heads = QList<QSharedPointer<WaylandOutputMetaHead>> {};
+    heads.reserve(m_heads.size());
+    for (const auto& head : m_heads) {
+      if (head->isAvailable()) heads.append(head);
+    }
+    return heads;
   }
 
   QSharedPointer<WaylandOutputMetaHead> WaylandOutputManager::getOutputHead(const QString& str) {
-    for (auto head : m_heads) {
-      if (head->getIdentifier() == str) { return head; }
-    }
+    return getOutputHead(OutputIdTable::instance().find(str));
+  }
+
+  QSharedPointer<WaylandOutputMetaHead> WaylandOutputManager::getOutputHead(OutputId id) {
+    auto head = findHead(id);
+    if (head.isNull() || !head->isAvailable()) return nullptr;
+    return head;
+  }
 
-    return nullptr;
+  // findHead looks up a head whether or not it is connected
+  QSharedPointer<WaylandOutputMetaHead> WaylandOutputManager::findHead(OutputId id) {
+    auto it = m_head_index.constFind(id);
+    if (it == m_head_index.constEnd()) return nullptr;
+    return m_heads.at(it.value());
   }
 
   uint32_t WaylandOutputManager::getSerial() {
@@ -196,6 +730,10 @@ namespace bd {
     return m_version;
   }
 
+  void WaylandOutputManager::setTombstoneMaxAge(qint64 max_age) {
+    m_tombstone_max_age = max_age;
+  }
+
   // Output Mode Configuration
 
   WaylandOutputConfiguration::WaylandOutputConfiguration(QObject* parent, ::zwlr_output_configuration_v1* config)
@@ -212,9 +750,13 @@ namespace bd {
     return QSharedPointer<WaylandOutputConfigurationHead>(config_head);
   }
 
+  // applySelf sends the apply request without waiting on the compositor. The outcome is delivered later through the succeeded, failed or cancelled
+  // signals once the orchestrator dispatches the corresponding event.
   void WaylandOutputConfiguration::applySelf() {
     apply();
-    wl_display_roundtrip(bd::WaylandOrchestrator::instance().getDisplay());
+    // Nothing to flush while the orchestrator is not connected (a test driving the manager flushes its own display)
+    auto display = bd::WaylandOrchestrator::instance().getDisplay();
+    if (display != nullptr) wl_display_flush(display);
   }
 
   void WaylandOutputConfiguration::release() {
@@ -259,9 +801,9 @@ namespace bd {
     set_adaptive_sync(state);
   }
 
-  void WaylandOutputConfigurationHead::setMode(WaylandOutputMetaMode* mode) {
-    auto wlrModeOpt = mode->getWlrMode();
-    if (wlrModeOpt == nullptr || (wlrModeOpt != nullptr && !wlrModeOpt.has_value())) {
+  void WaylandOutputConfigurationHead::setMode(const WaylandOutputMetaMode& mode) {
+    auto wlrModeOpt = mode.getWlrMode();
+    if (!wlrModeOpt.has_value()) {
       qWarning() << "Tried to set mode on configuration head, but mode is not available";
       return;
     }
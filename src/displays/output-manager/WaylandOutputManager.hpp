@@ -1,11 +1,22 @@
 #pragma once
 
-#include <KWayland/Client/registry.h>
 #include <wayland-client.h>
 #include <wayland-util.h>
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
-
+#include <QSemaphore>
+#include <QSocketNotifier>
+#include <atomic>
+#include <memory>
+
+#include "SpscQueue.hpp"
+#include "WaylandEventThread.hpp"
+#include "WaylandProtocolReplay.hpp"
+#include "WaylandOutputTopology.hpp"
+#include "WaylandRegistry.hpp"
+#include "head/WaylandOutputHeadSnapshot.hpp"
 #include "head/WaylandOutputMetaHead.hpp"
 #include "qwayland-wlr-output-management-unstable-v1.h"
 
@@ -17,6 +28,18 @@ namespace bd {
   class WaylandOutputConfigurationHead;
   class WaylandOutputMetaMode;
 
+  // WaylandOutputState is enough of an output's live state to tell whether a compositor restart left it as we had configured it
+  struct WaylandOutputState {
+      bool       enabled   = false;
+      QPoint     position  = QPoint {0, 0};
+      double     scale     = 1.0;
+      int        transform = 0;
+      QSize      size;
+      qulonglong refresh = 0;
+
+      bool operator==(const WaylandOutputState&) const = default;
+  };
+
   class WaylandOrchestrator : public QObject {
       Q_OBJECT
 
@@ -28,59 +51,143 @@ namespace bd {
       void                                  init();
       QSharedPointer<WaylandOutputManager> getManager();
       wl_display*           getDisplay();
-      KWayland::Client::Registry*           getRegistry();
+      WaylandRegistry*           getRegistry();
 
       bool hasSerial();
       int  getSerial();
+      bool isEventThreadEnabled();
 
     signals:
       void ready();
       void done();
+      void outputsChanged();
       void orchestratorInitFailed(QString error);
 
     public slots:
       void outputManagerDone();
 
+    private slots:
+      void dispatchEvents();
+      void flushEvents();
+      void handleDisconnect();
+      void reconnect();
+      void stopEventThread();
+
     private:
-      KWayland::Client::Registry*           m_registry;
+      static constexpr int MinReconnectDelay = 250;
+      static constexpr int MaxReconnectDelay = 8000;
+
+      QHash<QString, WaylandOutputState> captureOutputState();
+      QString                            connectDisplay();
+      void                               scheduleReconnect();
+      void                               setupEventDispatch();
+      void                               startEventThread();
+      void                               startReplay(const QString& path);
+      void                               watchManager(WaylandOutputManager* manager);
+
+      WaylandRegistry*           m_registry;
       wl_display*           m_display;
+      QSocketNotifier*                      m_notifier;
+      wl_event_queue*                       m_event_queue;
+      WaylandEventThread*                   m_event_thread;
+      WaylandProtocolReplay*                m_replay;
       QSharedPointer<WaylandOutputManager> m_manager;
       bool                                  m_has_initted;
       bool                                  m_has_serial;
       int                                   m_serial;
+      // Measures connect to ready, then ready to the first applied configuration
+      QElapsedTimer                         m_startup_timer;
+
+      // Reconnect state: what our outputs looked like when the connection was lost, and how long to wait before the next attempt
+      bool                                  m_use_event_thread;
+      bool                                  m_reconnecting;
+      int                                   m_reconnect_delay;
+      QHash<QString, WaylandOutputState>    m_cached_state;
   };
 
   class WaylandOutputManager : public QObject, QtWayland::zwlr_output_manager_v1 {
       Q_OBJECT
 
     public:
-      WaylandOutputManager(QObject* parent, KWayland::Client::Registry* registry, uint32_t serial, uint32_t version);
+      WaylandOutputManager(QObject* parent, WaylandRegistry* registry, uint32_t serial, uint32_t version, wl_event_queue* queue = nullptr);
+      // Wraps an existing manager object, used by WaylandProtocolReplay
+      WaylandOutputManager(QObject* parent, ::zwlr_output_manager_v1* manager);
       //      static WaylandOutputManager& instance();
 
+      static constexpr qint64 DefaultTombstoneMaxAge = 60 * 60 * 1000;
+
       QSharedPointer<WaylandOutputConfiguration>            configure();
+      // getHeads and getOutputHead only see heads that are currently connected, disconnected heads are kept as tombstones until they come
+      // back or are compacted
       QList<QSharedPointer<WaylandOutputMetaHead>>          getHeads();
       QSharedPointer<WaylandOutputMetaHead>                 getOutputHead(const QString& str);
+      QSharedPointer<WaylandOutputMetaHead>                 getOutputHead(OutputId id);
+      // getTopology returns the most recently published topology, safe to call from any thread
+      std::shared_ptr<const WaylandOutputTopology>          getTopology() const;
       QList<QSharedPointer<WaylandOutputConfigurationHead>> applyNoOpConfigurationForNonSpecifiedHeads(
           WaylandOutputConfiguration* config,
           const QStringList&          identifiers);
 
       uint32_t getSerial();
       uint32_t getVersion();
+      // setTombstoneMaxAge sets how long (ms) a disconnected head is kept around for in case it comes back
+      void     setTombstoneMaxAge(qint64 max_age);
+
+      void bind(WaylandRegistry* registry, uint32_t name, uint32_t version, wl_event_queue* queue = nullptr);
+      void unbind();
+      bool isBound();
 
     signals:
       void done();
+      // Emitted after a committed transaction connected or disconnected at least one head
+      void headsChanged();
 
     protected:
+      friend class WaylandProtocolReplay;
+
       void zwlr_output_manager_v1_head(zwlr_output_head_v1* head) override;
       void zwlr_output_manager_v1_finished() override;
       void zwlr_output_manager_v1_done(uint32_t serial) override;
 
+    private slots:
+      void drainSnapshots();
+      void publishTopology();
+
     private:
-      KWayland::Client::Registry*                   m_registry;
+      static constexpr std::size_t SnapshotCapacity = 16;
+      static constexpr int         SnapshotSlotWait = 50; // ms between checks for a stop request while the main thread is behind
+
+      bool acquireSnapshotSlot();
+      void abandonSnapshot(const WaylandOutputManagerSnapshot& snapshot);
+      bool applySnapshot(const WaylandOutputManagerSnapshot& snapshot);
+      void compactHeads();
+      QSharedPointer<WaylandOutputMetaHead> findHead(OutputId id);
+      void rekeyHead(const QSharedPointer<WaylandOutputMetaHead>& head, OutputId previous);
+      void watchHead(const QSharedPointer<WaylandOutputMetaHead>& head);
+      WaylandOutputManagerSnapshot takeSnapshot(uint32_t serial);
+
+      WaylandRegistry*                   m_registry;
+      // Meta heads in the order we first saw them, with m_head_index mapping an output id to its position in m_heads
       QList<QSharedPointer<WaylandOutputMetaHead>> m_heads;
+      QHash<OutputId, qsizetype>                    m_head_index;
+      qint64                                        m_tombstone_max_age;
+
+      // Published by the main thread after every change to our heads, read from anywhere
+      std::atomic<std::shared_ptr<const WaylandOutputTopology>> m_topology;
+      quint64                                                   m_topology_generation;
       uint32_t                                      m_serial;
       bool                                          m_has_serial;
       uint32_t                                      m_version;
+      bool                                          m_bound;
+
+      // Heads record protocol events into pending state, which is only committed to meta heads on done. When dispatched on the event thread,
+      // m_pending_heads is touched by the event thread alone, m_meta_heads_by_head by the main thread alone, and m_snapshots is how the former
+      // hands committed state to the latter. m_snapshot_slots counts the free slots in m_snapshots.
+      bool                                                              m_threaded;
+      QList<QSharedPointer<WaylandOutputHead>>                          m_pending_heads;
+      QHash<WaylandOutputHead*, QSharedPointer<WaylandOutputMetaHead>> m_meta_heads_by_head;
+      SpscQueue<WaylandOutputManagerSnapshot, SnapshotCapacity>         m_snapshots;
+      QSemaphore                                                        m_snapshot_slots;
   };
 
   class WaylandOutputConfiguration : public QObject, QtWayland::zwlr_output_configuration_v1 {
@@ -113,7 +220,7 @@ namespace bd {
       WaylandOutputMetaHead* getHead();
       void                   release();
       void                   setAdaptiveSync(uint32_t state);
-      void                   setMode(WaylandOutputMetaMode* mode);
+      void                   setMode(const WaylandOutputMetaMode& mode);
       void                   setCustomMode(int32_t width, int32_t height, qulonglong refresh);
       void                   setPosition(int32_t x, int32_t y);
       void                   setTransform(quint8 transform);
@@ -0,0 +1,161 @@
+#include "WaylandOutputTopology.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "head/WaylandOutputMetaHead.hpp"
+
+namespace bd {
+  std::shared_ptr<const WaylandOutputTopology> WaylandOutputTopology::build(const QList<QSharedPointer<WaylandOutputMetaHead>>& heads, quint64 generation) {
+    auto topology          = std::make_shared<WaylandOutputTopology>();
+    topology->m_generation = generation;
+    topology->m_heads.reserve(heads.size());
+
+    for (const auto& head : heads) {
+      if (head.isNull() || head->getOutputId() == OutputId::Invalid) continue;
+
+      auto entry = WaylandOutputTopologyHead {
+          .id                = head->getOutputId(),
+          .generation        = head->getGeneration(),
+          .identifier        = head->getIdentifier(),
+          .name              = head->getName(),
+          .description       = head->getDescription(),
+          .make              = head->getMake(),
+          .model             = head->getModel(),
+          .available         = head->isAvailable(),
+          .enabled           = head->isEnabled(),
+          .primary           = head->isPrimary(),
+          .position          = head->getPosition(),
+          .scale             = head->getScale(),
+          .transform         = head->getTransform(),
+          .adaptive_sync     = static_cast<uint32_t>(head->getAdaptiveSync()),
+          .relative_output   = head->getRelativeOutput(),
+          .horizontal_anchor = head->getHorizontalAnchor(),
+          .vertical_anchor   = head->getVerticalAnchor(),
+          .mode_ids          = head->getModeIds(),
+      };
+
+      auto mode = head->getCurrentMode();
+      if (mode) {
+        entry.size    = mode.getSize().value_or(QSize {});
+        entry.refresh = mode.getRefresh().value_or(0);
+        entry.mode_id = mode.getId();
+      }
+
+      entry.geometry = logicalGeometry(entry);
+
+      topology->m_index.insert(entry.id, topology->m_heads.size());
+      topology->m_heads.append(entry);
+    }
+
+    for (qsizetype i = 0; i < topology->m_heads.size(); ++i) {
+      const auto& geometry = topology->m_heads.at(i).geometry;
+      if (geometry.isEmpty()) continue;
+      topology->m_by_left.append(i);
+      topology->m_max_width = std::max(topology->m_max_width, geometry.width());
+    }
+    std::stable_sort(topology->m_by_left.begin(), topology->m_by_left.end(), [&heads = topology->m_heads](qsizetype a, qsizetype b) {
+      return heads.at(a).geometry.left() < heads.at(b).geometry.left();
+    });
+
+    return topology;
+  }
+
+  // logicalGeometry is the mode's size scaled down, with width and height swapped for the transforms that rotate by 90 or 270 degrees (the
+  // odd values of wl_output_transform)
+  QRect WaylandOutputTopology::logicalGeometry(const WaylandOutputTopologyHead& head) {
+    if (!head.available || !head.enabled || head.size.isEmpty()) return QRect {};
+
+    auto scale  = head.scale > 0 ? head.scale : 1.0;
+    auto width  = static_cast<int>(std::lround(head.size.width() / scale));
+    auto height = static_cast<int>(std::lround(head.size.height() / scale));
+    if (head.transform % 2 == 1) std::swap(width, height);
+
+    // A head placed right at the edge of the coordinate space is cut off there, rather than have its far edge wrap around
+    auto right  = std::min<qint64>(qint64 {head.position.x()} + width - 1, std::numeric_limits<int>::max());
+    auto bottom = std::min<qint64>(qint64 {head.position.y()} + height - 1, std::numeric_limits<int>::max());
+    return QRect {head.position, QPoint {static_cast<int>(right), static_cast<int>(bottom)}};
+  }
+
+  quint64 WaylandOutputTopology::getGeneration() const {
+    return m_generation;
+  }
+
+  // hasSameGenerations is whether both topologies hold the same heads, in the same order, each at the same generation. If they do, nothing
+  // changed between them.
+  bool WaylandOutputTopology::hasSameGenerations(const WaylandOutputTopology& other) const {
+    if (m_heads.size() != other.m_heads.size()) return false;
+    for (qsizetype i = 0; i < m_heads.size(); ++i) {
+      if (m_heads.at(i).id != other.m_heads.at(i).id || m_heads.at(i).generation != other.m_heads.at(i).generation) return false;
+    }
+    return true;
+  }
+
+  const QList<WaylandOutputTopologyHead>& WaylandOutputTopology::getHeads() const {
+    return m_heads;
+  }
+
+  // getHead returns the entry for this output, which keeps the whole topology alive for as long as it is held
+  std::shared_ptr<const WaylandOutputTopologyHead> WaylandOutputTopology::getHead(OutputId id) const {
+    auto it = m_index.constFind(id);
+    if (it == m_index.constEnd()) return nullptr;
+    return share(it.value());
+  }
+
+  // getPrimaryOrFirstHead returns the connected head marked primary, or the first connected head if none is
+  std::shared_ptr<const WaylandOutputTopologyHead> WaylandOutputTopology::getPrimaryOrFirstHead() const {
+    auto first = qsizetype {-1};
+    for (qsizetype i = 0; i < m_heads.size(); ++i) {
+      if (!m_heads.at(i).available) continue;
+      if (m_heads.at(i).primary) return share(i);
+      if (first < 0) first = i;
+    }
+    if (first < 0) return nullptr;
+    return share(first);
+  }
+
+  // getHeadAt returns the head whose geometry contains point. Where heads overlap (mirroring) the one we saw first wins.
+  std::shared_ptr<const WaylandOutputTopologyHead> WaylandOutputTopology::getHeadAt(const QPoint& point) const {
+    auto found = qsizetype {-1};
+    for (auto index : candidatesFor(point.x(), point.x())) {
+      if (!m_heads.at(index).geometry.contains(point)) continue;
+      if (found < 0 || index < found) found = index;
+    }
+    if (found < 0) return nullptr;
+    return share(found);
+  }
+
+  // getHeadsIn returns every head whose geometry intersects rect, in the order we saw them. rect may span the whole coordinate space, so its
+  // edges are compared directly rather than through QRect::intersects, which works its width out.
+  QList<std::shared_ptr<const WaylandOutputTopologyHead>> WaylandOutputTopology::getHeadsIn(const QRect& rect) const {
+    auto found = QList<qsizetype> {};
+    if (rect.isEmpty()) return {};
+
+    for (auto index : candidatesFor(rect.left(), rect.right())) {
+      const auto& geometry = m_heads.at(index).geometry;
+      if (geometry.left() > rect.right() || geometry.right() < rect.left()) continue;
+      if (geometry.top() > rect.bottom() || geometry.bottom() < rect.top()) continue;
+      found.append(index);
+    }
+    std::sort(found.begin(), found.end());
+
+    auto heads = QList<std::shared_ptr<const WaylandOutputTopologyHead>> {};
+    heads.reserve(found.size());
+    for (auto index : found) heads.append(share(index));
+    return heads;
+  }
+
+  // candidatesFor narrows the spatial index down to the heads that may overlap the columns [left, right]. The edges are worked out in 64 bits,
+  // so columns at either end of the coordinate space don't overflow.
+  QList<qsizetype> WaylandOutputTopology::candidatesFor(int left, int right) const {
+    auto by_left_edge = [this](qsizetype index, qint64 edge) { return m_heads.at(index).geometry.left() < edge; };
+    auto first        = std::lower_bound(m_by_left.cbegin(), m_by_left.cend(), qint64 {left} - m_max_width + 1, by_left_edge);
+    auto last         = std::lower_bound(first, m_by_left.cend(), qint64 {right} + 1, by_left_edge);
+    return QList<qsizetype>(first, last);
+  }
+
+  std::shared_ptr<const WaylandOutputTopologyHead> WaylandOutputTopology::share(qsizetype index) const {
+    return std::shared_ptr<const WaylandOutputTopologyHead>(shared_from_this(), &m_heads.at(index));
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+#include "displays/OutputId.hpp"
+#include "displays/batch-system/enums.hpp"
+
+namespace bd {
+  class WaylandOutputMetaHead;
+
+  // WaylandOutputTopologyHead is what one head looked like when a WaylandOutputTopology was published
+  struct WaylandOutputTopologyHead {
+      OutputId   id         = OutputId::Invalid;
+      quint64    generation = 0;
+      QString    identifier;
+      QString    name;
+      QString    description;
+      QString    make;
+      QString    model;
+      bool       available = false;
+      bool       enabled   = false;
+      bool       primary   = false;
+      QPoint     position  = QPoint {0, 0};
+      QSize      size;
+      qulonglong refresh = 0;
+      QString    mode_id;
+      double     scale         = 1.0;
+      int        transform     = 0;
+      uint32_t   adaptive_sync = 0;
+      // geometry is the area of the global (logical) space the head covers once scale and transform are applied, empty while disabled
+      QRect      geometry;
+
+      QString                       relative_output;
+      ConfigurationHorizontalAnchor horizontal_anchor = ConfigurationHorizontalAnchor::NoHorizontalAnchor;
+      ConfigurationVerticalAnchor   vertical_anchor   = ConfigurationVerticalAnchor::NoVerticalAnchor;
+
+      // mode_ids is the id of every mode the head has, shared with the meta head
+      QStringList mode_ids;
+  };
+
+  // WaylandOutputTopology is an immutable copy of every head's committed state. WaylandOutputManager publishes a new one whenever that state
+  // changes, and readers on any thread take the current one with a single atomic load. A topology is never modified once published, so every
+  // property read from one is consistent with every other. Strings are implicitly shared with the meta heads, so publishing copies little.
+  class WaylandOutputTopology : public std::enable_shared_from_this<WaylandOutputTopology> {
+    public:
+      static std::shared_ptr<const WaylandOutputTopology> build(const QList<QSharedPointer<WaylandOutputMetaHead>>& heads, quint64 generation);
+
+      quint64                                          getGeneration() const;
+      bool                                             hasSameGenerations(const WaylandOutputTopology& other) const;
+      const QList<WaylandOutputTopologyHead>&          getHeads() const;
+      std::shared_ptr<const WaylandOutputTopologyHead> getHead(OutputId id) const;
+      std::shared_ptr<const WaylandOutputTopologyHead> getPrimaryOrFirstHead() const;
+      std::shared_ptr<const WaylandOutputTopologyHead> getHeadAt(const QPoint& point) const;
+      QList<std::shared_ptr<const WaylandOutputTopologyHead>> getHeadsIn(const QRect& rect) const;
+
+    private:
+      static QRect logicalGeometry(const WaylandOutputTopologyHead& head);
+
+      QList<qsizetype>                                 candidatesFor(int left, int right) const;
+      std::shared_ptr<const WaylandOutputTopologyHead> share(qsizetype index) const;
+
+      quint64                          m_generation = 0;
+      QList<WaylandOutputTopologyHead> m_heads;
+      QHash<OutputId, qsizetype>       m_index;
+
+      // Spatial index: positions in m_heads of every head with a geometry, ordered by left edge, and the widest of those geometries. Any
+      // head overlapping [left, right] horizontally has its left edge within [left - m_max_width + 1, right].
+      QList<qsizetype> m_by_left;
+      int              m_max_width = 0;
+  };
+}
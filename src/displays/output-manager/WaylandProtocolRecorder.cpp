@@ -0,0 +1,151 @@
+#include "WaylandProtocolRecorder.hpp"
+
+#include <wayland-client.h>
+
+#include <QDebug>
+#include <QMutexLocker>
+
+namespace bd {
+  namespace {
+    constexpr quint32 LogMagic   = 0x42445752;  // "BDWR"
+    constexpr quint16 LogVersion = 1;
+
+    enum class Payload { None, OneArgument, TwoArguments, Text };
+
+    Payload payloadFor(WaylandProtocolEvent event) {
+      switch (event) {
+        case WaylandProtocolEvent::ManagerFinished:
+        case WaylandProtocolEvent::HeadFinished:
+        case WaylandProtocolEvent::ModePreferred:
+        case WaylandProtocolEvent::ModeFinished:
+          return Payload::None;
+        case WaylandProtocolEvent::HeadPosition:
+        case WaylandProtocolEvent::ModeSize:
+          return Payload::TwoArguments;
+        case WaylandProtocolEvent::HeadName:
+        case WaylandProtocolEvent::HeadDescription:
+        case WaylandProtocolEvent::HeadMake:
+        case WaylandProtocolEvent::HeadModel:
+        case WaylandProtocolEvent::HeadSerialNumber:
+          return Payload::Text;
+        default:
+          return Payload::OneArgument;
+      }
+    }
+  }
+
+  WaylandProtocolRecorder::WaylandProtocolRecorder() : m_recording(false) {}
+
+  WaylandProtocolRecorder& WaylandProtocolRecorder::instance() {
+    static WaylandProtocolRecorder _instance;
+    return _instance;
+  }
+
+  bool WaylandProtocolRecorder::start(const QString& path) {
+    QMutexLocker locker(&m_mutex);
+    if (m_recording.load()) return true;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << "Failed to open Wayland protocol log" << path << ":" << m_file.errorString();
+      return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setByteOrder(QDataStream::LittleEndian);
+    m_stream << LogMagic << LogVersion;
+
+    m_timer.start();
+    m_recording.store(true);
+    qInfo() << "Recording Wayland output management events to" << path;
+    return true;
+  }
+
+  void WaylandProtocolRecorder::stop() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_recording.load()) return;
+
+    m_recording.store(false);
+    m_stream.setDevice(nullptr);
+    m_file.close();
+  }
+
+  void WaylandProtocolRecorder::record(WaylandProtocolEvent event, void* object, qint32 first, qint32 second) {
+    if (!isRecording()) return;
+
+    auto record    = WaylandProtocolRecord {.event = event, .object = wl_proxy_get_id(static_cast<wl_proxy*>(object))};
+    record.args[0] = first;
+    record.args[1] = second;
+    write(record);
+  }
+
+  void WaylandProtocolRecorder::record(WaylandProtocolEvent event, void* object, const QString& text) {
+    if (!isRecording()) return;
+
+    auto record = WaylandProtocolRecord {.event = event, .object = wl_proxy_get_id(static_cast<wl_proxy*>(object)), .text = text};
+    write(record);
+  }
+
+  void WaylandProtocolRecorder::write(const WaylandProtocolRecord& record) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_recording.load()) return;
+
+    m_stream << static_cast<quint64>(m_timer.nsecsElapsed()) << static_cast<quint8>(record.event) << record.object;
+
+    switch (payloadFor(record.event)) {
+      case Payload::None:
+        break;
+      case Payload::OneArgument:
+        m_stream << record.args[0];
+        break;
+      case Payload::TwoArguments:
+        m_stream << record.args[0] << record.args[1];
+        break;
+      case Payload::Text:
+        m_stream << record.text.toUtf8();
+        break;
+    }
+
+    // Each done ends a transaction, make sure everything up to it survives us crashing
+    if (record.event == WaylandProtocolEvent::ManagerDone) m_file.flush();
+  }
+
+  bool WaylandProtocolRecorder::readHeader(QDataStream& stream) {
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic   = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    return stream.status() == QDataStream::Ok && magic == LogMagic && version == LogVersion;
+  }
+
+  bool WaylandProtocolRecorder::readRecord(QDataStream& stream, WaylandProtocolRecord& record) {
+    quint8 event = 0;
+    stream >> record.timestamp >> event >> record.object;
+    if (stream.status() != QDataStream::Ok) return false;
+
+    record.event   = static_cast<WaylandProtocolEvent>(event);
+    record.args[0] = 0;
+    record.args[1] = 0;
+    record.text.clear();
+
+    switch (payloadFor(record.event)) {
+      case Payload::None:
+        break;
+      case Payload::OneArgument:
+        stream >> record.args[0];
+        break;
+      case Payload::TwoArguments:
+        stream >> record.args[0] >> record.args[1];
+        break;
+      case Payload::Text: {
+        QByteArray text;
+        stream >> text;
+        record.text = QString::fromUtf8(text);
+        break;
+      }
+    }
+
+    return stream.status() == QDataStream::Ok;
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+namespace bd {
+  // WaylandProtocolEvent identifies a zwlr_output_* event in a protocol log. Values are part of the log format, only ever append to this.
+  enum class WaylandProtocolEvent : quint8 {
+    ManagerHead,
+    ManagerDone,
+    ManagerFinished,
+    HeadName,
+    HeadDescription,
+    HeadMake,
+    HeadModel,
+    HeadSerialNumber,
+    HeadMode,
+    HeadEnabled,
+    HeadCurrentMode,
+    HeadPosition,
+    HeadTransform,
+    HeadScale,
+    HeadAdaptiveSync,
+    HeadFinished,
+    ModeSize,
+    ModeRefresh,
+    ModePreferred,
+    ModeFinished,
+  };
+
+  // WaylandProtocolRecord is a single event from a protocol log. object is the protocol id of the object that received the event. For events
+  // introducing or referring to another object (ManagerHead, HeadMode, HeadCurrentMode) that object's id is the first argument.
+  struct WaylandProtocolRecord {
+      quint64              timestamp = 0;  // Nanoseconds since recording started, monotonic
+      WaylandProtocolEvent event     = WaylandProtocolEvent::ManagerDone;
+      quint32              object    = 0;
+      qint32               args[2]   = {0, 0};
+      QString              text;
+  };
+
+  // WaylandProtocolRecorder is a flight recorder for the output management protocol. When started, every event received by WaylandOutputManager,
+  // WaylandOutputHead and WaylandOutputMode is appended to a compact binary log that WaylandProtocolReplay can feed back in without a compositor.
+  class WaylandProtocolRecorder {
+    public:
+      static WaylandProtocolRecorder& instance();
+
+      bool start(const QString& path);
+      void stop();
+      bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+
+      void record(WaylandProtocolEvent event, void* object, qint32 first = 0, qint32 second = 0);
+      void record(WaylandProtocolEvent event, void* object, const QString& text);
+
+      static bool readHeader(QDataStream& stream);
+      static bool readRecord(QDataStream& stream, WaylandProtocolRecord& record);
+
+    private:
+      WaylandProtocolRecorder();
+      Q_DISABLE_COPY(WaylandProtocolRecorder)
+
+      void write(const WaylandProtocolRecord& record);
+
+      QMutex            m_mutex;
+      QFile             m_file;
+      QDataStream       m_stream;
+      QElapsedTimer     m_timer;
+      std::atomic<bool> m_recording;
+  };
+}
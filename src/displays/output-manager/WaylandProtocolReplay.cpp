@@ -0,0 +1,192 @@
+#include "WaylandProtocolReplay.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "WaylandOutputManager.hpp"
+#include "head/WaylandOutputHead.hpp"
+#include "mode/WaylandOutputMode.hpp"
+
+namespace bd {
+  WaylandProtocolReplay::WaylandProtocolReplay(QObject* parent) : QObject(parent), m_peer_fd(-1), m_display(nullptr), m_manager(nullptr) {}
+
+  WaylandProtocolReplay::~WaylandProtocolReplay() {
+    if (m_display != nullptr) wl_display_disconnect(m_display);
+    if (m_peer_fd >= 0) close(m_peer_fd);
+  }
+
+  // open loads the whole log up front, so reading it is not part of what run() measures
+  QString WaylandProtocolReplay::open(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return QString("Failed to open Wayland protocol log %1: %2").arg(path, file.errorString());
+
+    QDataStream stream(&file);
+    if (!WaylandProtocolRecorder::readHeader(stream)) return QString("%1 is not a Wayland protocol log we understand").arg(path);
+
+    auto record = WaylandProtocolRecord {};
+    while (!stream.atEnd()) {
+      if (!WaylandProtocolRecorder::readRecord(stream, record)) {
+        qWarning() << "Wayland protocol log" << path << "is truncated, replaying the first" << m_records.size() << "events";
+        break;
+      }
+      m_records.append(record);
+    }
+
+    // A display connected to a socket nobody reads from, so we can create proxies (and the daemon can send requests) without a compositor
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0) return QString("Failed to create a socket pair for replay");
+
+    m_display = wl_display_connect_to_fd(fds[0]);
+    m_peer_fd = fds[1];
+    if (m_display == nullptr) return QString("Failed to create a Wayland display for replay");
+
+    return QString();
+  }
+
+  wl_display* WaylandProtocolReplay::getDisplay() {
+    return m_display;
+  }
+
+  WaylandOutputManager* WaylandProtocolReplay::createManager() {
+    // Every manager event in the log was received by the same object
+    auto manager_id = quint32 {0};
+    for (const auto& record : m_records) {
+      if (record.event == WaylandProtocolEvent::ManagerHead || record.event == WaylandProtocolEvent::ManagerDone) {
+        manager_id = record.object;
+        break;
+      }
+    }
+
+    auto proxy = createProxy(manager_id, QtWayland::zwlr_output_manager_v1::interface());
+    m_manager  = new WaylandOutputManager(nullptr, reinterpret_cast<::zwlr_output_manager_v1*>(proxy));
+    return m_manager;
+  }
+
+  wl_proxy* WaylandProtocolReplay::createProxy(quint32 id, const wl_interface* interface) {
+    auto proxy = wl_proxy_create(reinterpret_cast<wl_proxy*>(m_display), interface);
+    m_proxies.insert(id, proxy);  // Ids are reused once the compositor is done with an object, the newest one wins
+    return proxy;
+  }
+
+  void WaylandProtocolReplay::run() {
+    if (m_manager == nullptr) {
+      qWarning() << "No output manager to replay Wayland protocol events into";
+      emit finished();
+      return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const auto& record : m_records) replay(record);
+
+    auto elapsed = timer.nsecsElapsed();
+    auto count   = qMax<qsizetype>(m_records.size(), 1);
+    qInfo() << "Replayed" << m_records.size() << "Wayland events in" << elapsed / 1000 << "us," << elapsed / count << "ns per event";
+    emit finished();
+  }
+
+  void WaylandProtocolReplay::replay(const WaylandProtocolRecord& record) {
+    switch (record.event) {
+      case WaylandProtocolEvent::ManagerHead:
+        m_manager->zwlr_output_manager_v1_head(
+            reinterpret_cast<::zwlr_output_head_v1*>(createProxy(static_cast<quint32>(record.args[0]), QtWayland::zwlr_output_head_v1::interface())));
+        return;
+      case WaylandProtocolEvent::ManagerDone:
+        m_manager->zwlr_output_manager_v1_done(static_cast<uint32_t>(record.args[0]));
+        return;
+      case WaylandProtocolEvent::ManagerFinished:
+        m_manager->zwlr_output_manager_v1_finished();
+        return;
+      default:
+        break;
+    }
+
+    auto proxy = m_proxies.value(record.object);
+    if (proxy == nullptr) {
+      qWarning() << "Wayland protocol log refers to unknown object" << record.object << ", skipping event" << static_cast<int>(record.event);
+      return;
+    }
+
+    if (record.event >= WaylandProtocolEvent::ModeSize) {
+      auto mode = static_cast<WaylandOutputMode*>(QtWayland::zwlr_output_mode_v1::fromObject(reinterpret_cast<::zwlr_output_mode_v1*>(proxy)));
+      if (mode == nullptr) return;
+
+      switch (record.event) {
+        case WaylandProtocolEvent::ModeSize:
+          mode->zwlr_output_mode_v1_size(record.args[0], record.args[1]);
+          break;
+        case WaylandProtocolEvent::ModeRefresh:
+          mode->zwlr_output_mode_v1_refresh(record.args[0]);
+          break;
+        case WaylandProtocolEvent::ModePreferred:
+          mode->zwlr_output_mode_v1_preferred();
+          break;
+        case WaylandProtocolEvent::ModeFinished:
+          mode->zwlr_output_mode_v1_finished();
+          break;
+        default:
+          break;
+      }
+      return;
+    }
+
+    auto head = static_cast<WaylandOutputHead*>(QtWayland::zwlr_output_head_v1::fromObject(reinterpret_cast<::zwlr_output_head_v1*>(proxy)));
+    if (head == nullptr) return;
+
+    switch (record.event) {
+      case WaylandProtocolEvent::HeadName:
+        head->zwlr_output_head_v1_name(record.text);
+        break;
+      case WaylandProtocolEvent::HeadDescription:
+        head->zwlr_output_head_v1_description(record.text);
+        break;
+      case WaylandProtocolEvent::HeadMake:
+        head->zwlr_output_head_v1_make(record.text);
+        break;
+      case WaylandProtocolEvent::HeadModel:
+        head->zwlr_output_head_v1_model(record.text);
+        break;
+      case WaylandProtocolEvent::HeadSerialNumber:
+        head->zwlr_output_head_v1_serial_number(record.text);
+        break;
+      case WaylandProtocolEvent::HeadMode:
+        head->zwlr_output_head_v1_mode(
+            reinterpret_cast<::zwlr_output_mode_v1*>(createProxy(static_cast<quint32>(record.args[0]), QtWayland::zwlr_output_mode_v1::interface())));
+        break;
+      case WaylandProtocolEvent::HeadEnabled:
+        head->zwlr_output_head_v1_enabled(record.args[0]);
+        break;
+      case WaylandProtocolEvent::HeadCurrentMode: {
+        auto mode = m_proxies.value(static_cast<quint32>(record.args[0]));
+        if (mode == nullptr) {
+          qWarning() << "Wayland protocol log refers to unknown mode" << record.args[0] << ", skipping current mode of" << record.object;
+          break;
+        }
+        head->zwlr_output_head_v1_current_mode(reinterpret_cast<::zwlr_output_mode_v1*>(mode));
+        break;
+      }
+      case WaylandProtocolEvent::HeadPosition:
+        head->zwlr_output_head_v1_position(record.args[0], record.args[1]);
+        break;
+      case WaylandProtocolEvent::HeadTransform:
+        head->zwlr_output_head_v1_transform(record.args[0]);
+        break;
+      case WaylandProtocolEvent::HeadScale:
+        head->zwlr_output_head_v1_scale(static_cast<wl_fixed_t>(record.args[0]));
+        break;
+      case WaylandProtocolEvent::HeadAdaptiveSync:
+        head->zwlr_output_head_v1_adaptive_sync(static_cast<uint32_t>(record.args[0]));
+        break;
+      case WaylandProtocolEvent::HeadFinished:
+        head->zwlr_output_head_v1_finished();
+        break;
+      default:
+        break;
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+#include "WaylandProtocolRecorder.hpp"
+
+namespace bd {
+  class WaylandOutputManager;
+
+  // WaylandProtocolReplay feeds a log written by WaylandProtocolRecorder back into WaylandOutputManager, WaylandOutputHead and WaylandOutputMode
+  // without a compositor. Proxies are created on a display connected to nothing, so requests the daemon sends in response go nowhere.
+  class WaylandProtocolReplay : public QObject {
+      Q_OBJECT
+
+    public:
+      WaylandProtocolReplay(QObject* parent = nullptr);
+      ~WaylandProtocolReplay() override;
+
+      QString               open(const QString& path);
+      wl_display*           getDisplay();
+      WaylandOutputManager* createManager();
+
+    public slots:
+      void run();
+
+    signals:
+      void finished();
+
+    private:
+      wl_proxy* createProxy(quint32 id, const wl_interface* interface);
+      void      replay(const WaylandProtocolRecord& record);
+
+      int                          m_peer_fd;
+      wl_display*                  m_display;
+      WaylandOutputManager*        m_manager;
+      QList<WaylandProtocolRecord> m_records;
+      QHash<quint32, wl_proxy*>    m_proxies;
+  };
+}
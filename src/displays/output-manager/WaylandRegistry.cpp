@@ -0,0 +1,67 @@
+#include "WaylandRegistry.hpp"
+
+#ifndef BUDGIE_DAEMON_KWAYLAND
+namespace bd {
+  const wl_registry_listener WaylandRegistry::s_registry_listener = {
+      .global        = WaylandRegistry::handleGlobal,
+      .global_remove = WaylandRegistry::handleGlobalRemove,
+  };
+
+  const wl_callback_listener WaylandRegistry::s_sync_listener = {
+      .done = WaylandRegistry::handleSyncDone,
+  };
+
+  WaylandRegistry::WaylandRegistry(QObject* parent) : QObject(parent), m_display(nullptr), m_registry(nullptr), m_sync(nullptr) {}
+
+  WaylandRegistry::~WaylandRegistry() {
+    release();
+  }
+
+  // create requests the registry from display. Globals are only announced once setup() has added our listener.
+  void WaylandRegistry::create(wl_display* display) {
+    if (isValid()) return;
+    m_display  = display;
+    m_registry = wl_display_get_registry(display);
+  }
+
+  bool WaylandRegistry::isValid() const {
+    return m_registry != nullptr;
+  }
+
+  void WaylandRegistry::release() {
+    if (m_sync != nullptr) wl_callback_destroy(m_sync);
+    if (m_registry != nullptr) wl_registry_destroy(m_registry);
+    m_sync     = nullptr;
+    m_registry = nullptr;
+    m_display  = nullptr;
+  }
+
+  void WaylandRegistry::setup() {
+    if (!isValid()) return;
+    wl_registry_add_listener(m_registry, &s_registry_listener, this);
+
+    // The compositor announces every existing global before replying to a sync requested after get_registry
+    m_sync = wl_display_sync(m_display);
+    wl_callback_add_listener(m_sync, &s_sync_listener, this);
+  }
+
+  wl_registry* WaylandRegistry::registry() {
+    return m_registry;
+  }
+
+  void WaylandRegistry::handleGlobal(void* data, wl_registry*, uint32_t name, const char* interface, uint32_t version) {
+    emit static_cast<WaylandRegistry*>(data)->interfaceAnnounced(QByteArray(interface), name, version);
+  }
+
+  void WaylandRegistry::handleGlobalRemove(void* data, wl_registry*, uint32_t name) {
+    emit static_cast<WaylandRegistry*>(data)->interfaceRemoved(name);
+  }
+
+  void WaylandRegistry::handleSyncDone(void* data, wl_callback* callback, uint32_t) {
+    auto registry = static_cast<WaylandRegistry*>(data);
+    wl_callback_destroy(callback);
+    registry->m_sync = nullptr;
+    emit registry->interfacesAnnounced();
+  }
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <QByteArray>
+#include <QObject>
+
+#ifdef BUDGIE_DAEMON_KWAYLAND
+#include <KWayland/Client/registry.h>
+#endif
+
+namespace bd {
+#ifdef BUDGIE_DAEMON_KWAYLAND
+  using WaylandRegistry = KWayland::Client::Registry;
+#else
+  // WaylandRegistry is a minimal wl_registry listener. It exposes the small part of KWayland::Client::Registry we rely on, so the daemon does not
+  // need to load KWayland just to find the output manager global. Build with WITH_KWAYLAND to use KWayland's registry instead.
+  class WaylandRegistry : public QObject {
+      Q_OBJECT
+
+    public:
+      WaylandRegistry(QObject* parent = nullptr);
+      ~WaylandRegistry() override;
+
+      void         create(wl_display* display);
+      bool         isValid() const;
+      void         release();
+      void         setup();
+      wl_registry* registry();
+
+    signals:
+      void interfaceAnnounced(const QByteArray& interface, quint32 name, quint32 version);
+      void interfaceRemoved(quint32 name);
+      // Emitted once the globals that existed when setup() was called have all been announced
+      void interfacesAnnounced();
+
+    private:
+      static void handleGlobal(void* data, wl_registry* registry, uint32_t name, const char* interface, uint32_t version);
+      static void handleGlobalRemove(void* data, wl_registry* registry, uint32_t name);
+      static void handleSyncDone(void* data, wl_callback* callback, uint32_t serial);
+
+      static const wl_registry_listener s_registry_listener;
+      static const wl_callback_listener s_sync_listener;
+
+      wl_display*  m_display;
+      wl_registry* m_registry;
+      wl_callback* m_sync;
+  };
+#endif
+}
@@ -1,6 +1,9 @@
 #include "WaylandOutputHead.hpp"
 
 #include <QPoint>
+#include <algorithm>
+
+#include "displays/output-manager/WaylandProtocolRecorder.hpp"
 
 namespace bd {
   WaylandOutputHead::WaylandOutputHead(QObject* parent, ::zwlr_output_head_v1* wlr_head)
@@ -10,66 +13,157 @@ namespace bd {
     return m_wlr_head;
   }
 
+  // abandon destroys our head and mode proxies without sending anything, for when the connection they belong to is already gone
+  void WaylandOutputHead::abandon() {
+    for (const auto& mode : m_modes) mode->abandon();
+    m_modes.clear();
+
+    if (m_wlr_head != nullptr) wl_proxy_destroy(reinterpret_cast<wl_proxy*>(m_wlr_head));
+    m_wlr_head = nullptr;
+  }
+
+  // releaseProxy tells the compositor we are done with a finished head (protocol version 3 and later) and destroys our proxy. Its modes have all
+  // finished before the head does, so they are released along with the snapshot that removed them.
+  void WaylandOutputHead::releaseProxy() {
+    if (m_wlr_head == nullptr) return;
+
+    if (wl_proxy_get_version(reinterpret_cast<wl_proxy*>(m_wlr_head)) >= ZWLR_OUTPUT_HEAD_V1_RELEASE_SINCE_VERSION) {
+      release();
+    } else {
+      wl_proxy_destroy(reinterpret_cast<wl_proxy*>(m_wlr_head));
+    }
+    m_wlr_head = nullptr;
+  }
+
+  bool WaylandOutputHead::isDirty() const {
+    if (m_state.isDirty()) return true;
+    return std::any_of(m_modes.begin(), m_modes.end(), [](const auto& mode) { return mode->isFinished(); });
+  }
+
+  bool WaylandOutputHead::isFinished() const {
+    return m_state.finished;
+  }
+
+  // takeSnapshot returns everything recorded so far and resets the change tracking, so the next snapshot only reports what happened after this one.
+  WaylandOutputHeadSnapshot WaylandOutputHead::takeSnapshot() {
+    auto snapshot = m_state;
+    for (auto& mode : snapshot.added_modes) {
+      mode.size      = mode.mode->getSize();
+      mode.refresh   = mode.mode->getRefresh();
+      mode.preferred = mode.mode->isPreferred();
+    }
+
+    // Modes the compositor has finished are handed over with this snapshot, we no longer hold on to them
+    for (auto it = m_modes.begin(); it != m_modes.end();) {
+      if ((*it)->isFinished()) {
+        snapshot.removed_modes.append(*it);
+        snapshot.markChanged(WaylandOutputMetaHeadProperty::Modes);
+        it = m_modes.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    m_state.changed = 0;
+    m_state.added_modes.clear();
+    return snapshot;
+  }
+
   void WaylandOutputHead::zwlr_output_head_v1_name(const QString& name) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadName, m_wlr_head, name);
     qDebug() << "Head name changed to: " << name;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Name, QVariant {name});
+    m_state.name = name;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Name);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_description(const QString& description) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadDescription, m_wlr_head, description);
     qDebug() << "Head description changed to: " << description;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Description, QVariant {description});
+    m_state.description = description;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Description);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_make(const QString& make) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadMake, m_wlr_head, make);
     qDebug() << "Head make changed to: " << make;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Make, QVariant {make});
+    m_state.make = make;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Make);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_model(const QString& model) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadModel, m_wlr_head, model);
     qDebug() << "Head model changed to: " << model;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Model, QVariant {model});
+    m_state.model = model;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Model);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_mode(::zwlr_output_mode_v1* mode) {
+    auto& recorder = WaylandProtocolRecorder::instance();
+    if (recorder.isRecording()) {
+      recorder.record(WaylandProtocolEvent::HeadMode, m_wlr_head, static_cast<qint32>(wl_proxy_get_id(reinterpret_cast<wl_proxy*>(mode))));
+    }
     qDebug() << "Head mode changed to: " << mode;
-    emit modeAdded(mode);
+    // The mode's own events follow immediately, so its listener has to be in place before we return
+    auto output_mode = QSharedPointer<WaylandOutputMode>(new WaylandOutputMode(mode));
+    m_modes.append(output_mode);
+    m_state.added_modes.append(WaylandOutputModeSnapshot {.mode = output_mode});
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Modes);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_enabled(int32_t enabled) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadEnabled, m_wlr_head, enabled);
     qDebug() << "Head enabled state changed to: " << enabled;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Enabled, QVariant {enabled});
+    m_state.enabled = enabled != 0;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Enabled);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_current_mode(::zwlr_output_mode_v1* mode) {
-    emit modeChanged(mode);
+    // Only look the id up when it is going to be recorded, it is the one thing here that touches the proxy
+    auto& recorder = WaylandProtocolRecorder::instance();
+    if (recorder.isRecording()) {
+      recorder.record(WaylandProtocolEvent::HeadCurrentMode, m_wlr_head, static_cast<qint32>(wl_proxy_get_id(reinterpret_cast<wl_proxy*>(mode))));
+    }
+    m_state.current_mode = mode;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::CurrentMode);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_finished() {
-    emit headFinished();
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadFinished, m_wlr_head);
+    m_state.finished = true;
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_position(int32_t x, int32_t y) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadPosition, m_wlr_head, x, y);
     qDebug() << "Head position changed to: " << x << ", " << y;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Position, QVariant {QPoint(x, y)});
+    m_state.position = QPoint(x, y);
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Position);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_transform(int32_t transform) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadTransform, m_wlr_head, transform);
     qDebug() << "Head transform changed to: " << transform;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Transform, QVariant {transform});
+    m_state.transform = transform;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Transform);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_scale(wl_fixed_t scale) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadScale, m_wlr_head, scale);
     qDebug() << "Head scale changed to: " << wl_fixed_to_double(scale);
-    emit propertyChanged(WaylandOutputMetaHeadProperty::Scale, QVariant {wl_fixed_to_double(scale)});
+    m_state.scale = wl_fixed_to_double(scale);
+    m_state.markChanged(WaylandOutputMetaHeadProperty::Scale);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_serial_number(const QString& serial) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadSerialNumber, m_wlr_head, serial);
     qDebug() << "Head serial number changed to: " << serial;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::SerialNumber, QVariant {serial});
+    m_state.serial = serial;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::SerialNumber);
   }
 
   void WaylandOutputHead::zwlr_output_head_v1_adaptive_sync(uint32_t state) {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::HeadAdaptiveSync, m_wlr_head, static_cast<qint32>(state));
     qDebug() << "Head adaptive sync state changed to: " << state;
-    emit propertyChanged(WaylandOutputMetaHeadProperty::AdaptiveSync, QVariant {state});
+    m_state.adaptive_sync = state;
+    m_state.markChanged(WaylandOutputMetaHeadProperty::AdaptiveSync);
   }
 }
@@ -1,11 +1,15 @@
 #pragma once
 #include <QObject>
-#include <QVariant>
+#include <QSharedPointer>
 
+#include "WaylandOutputHeadSnapshot.hpp"
+#include "displays/output-manager/mode/WaylandOutputMode.hpp"
 #include "enums.hpp"
 #include "qwayland-wlr-output-management-unstable-v1.h"
 
 namespace bd {
+  // WaylandOutputHead wraps a zwlr_output_head_v1 proxy. Protocol events are only recorded into a pending snapshot, which the manager collects with
+  // takeSnapshot() on zwlr_output_manager_v1.done and commits to the matching WaylandOutputMetaHead in one go.
   class WaylandOutputHead : public QObject, QtWayland::zwlr_output_head_v1 {
       Q_OBJECT
 
@@ -14,13 +18,16 @@ namespace bd {
 
       ::zwlr_output_head_v1* getWlrHead();
 
-    signals:
-      void propertyChanged(WaylandOutputMetaHeadProperty property, const QVariant& value);
-      void headFinished();
-      void modeAdded(::zwlr_output_mode_v1* mode);
-      void modeChanged(::zwlr_output_mode_v1* mode);
+      void abandon();
+      void releaseProxy();
+
+      bool                      isDirty() const;
+      bool                      isFinished() const;
+      WaylandOutputHeadSnapshot takeSnapshot();
 
     protected:
+      friend class WaylandProtocolReplay;
+
       void zwlr_output_head_v1_name(const QString& name) override;
       void zwlr_output_head_v1_description(const QString& description) override;
       void zwlr_output_head_v1_make(const QString& make) override;
@@ -36,6 +43,8 @@ namespace bd {
       void zwlr_output_head_v1_finished() override;
 
     private:
-      ::zwlr_output_head_v1* m_wlr_head;
+      ::zwlr_output_head_v1*                   m_wlr_head;
+      WaylandOutputHeadSnapshot                m_state;
+      QList<QSharedPointer<WaylandOutputMode>> m_modes;
   };
 }
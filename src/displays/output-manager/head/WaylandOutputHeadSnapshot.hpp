@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QList>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+#include "displays/output-manager/mode/WaylandOutputMode.hpp"
+#include "enums.hpp"
+
+namespace bd {
+  class WaylandOutputHead;
+
+  struct WaylandOutputModeSnapshot {
+      QSharedPointer<WaylandOutputMode> mode;
+      QSize                             size;
+      qulonglong                        refresh   = 0;
+      bool                              preferred = false;
+  };
+
+  // WaylandOutputHeadSnapshot is the pending state a WaylandOutputHead has accumulated from protocol events since the last zwlr_output_manager_v1.done.
+  // changed is a bitmask of WaylandOutputMetaHeadProperty values, added_modes and removed_modes only hold modes advertised or finished since the
+  // last snapshot.
+  struct WaylandOutputHeadSnapshot {
+      QSharedPointer<WaylandOutputHead> head;
+      quint32                           changed = 0;
+
+      QString  name;
+      QString  description;
+      QString  make;
+      QString  model;
+      QString  serial;
+      bool     enabled       = false;
+      QPoint   position      = QPoint {0, 0};
+      int32_t  transform     = 0;
+      double   scale         = 1.0;
+      uint32_t adaptive_sync = 0;
+
+      QList<WaylandOutputModeSnapshot>         added_modes;
+      QList<QSharedPointer<WaylandOutputMode>> removed_modes;
+      ::zwlr_output_mode_v1*           current_mode = nullptr;
+      bool                             finished     = false;
+
+      bool hasChanged(WaylandOutputMetaHeadProperty property) const { return (changed & (1u << property)) != 0; }
+      void markChanged(WaylandOutputMetaHeadProperty property) { changed |= (1u << property); }
+      bool isDirty() const { return changed != 0 || finished; }
+  };
+
+  struct WaylandOutputManagerSnapshot {
+      uint32_t                         serial = 0;
+      QList<WaylandOutputHeadSnapshot> heads;
+  };
+}
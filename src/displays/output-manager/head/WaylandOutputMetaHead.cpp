@@ -10,11 +10,12 @@
 #include "config/utils.hpp"
 
 namespace bd {
-    WaylandOutputMetaHead::WaylandOutputMetaHead(QObject *parent, KWayland::Client::Registry *registry)
+    WaylandOutputMetaHead::WaylandOutputMetaHead(QObject *parent, WaylandRegistry *registry)
             : QObject(parent),
               m_registry(registry),
-              m_current_mode(nullptr),
               m_head(nullptr),
+              m_output_id(OutputId::Invalid),
+              m_generation(0),
               m_position(QPoint{0, 0}),
               m_transform(0),
               m_scale(1.0),
@@ -28,12 +29,7 @@ namespace bd {
     }
 
     WaylandOutputMetaHead::~WaylandOutputMetaHead() {
-        for (auto &mode: m_output_modes) {
-            if (!mode) continue;
-            auto mode_ptr = mode.data();
-            mode_ptr->deleteLater();
-        }
-        m_output_modes.clear();
+        m_modes.clear();
     }
 
     // Getters
@@ -42,8 +38,8 @@ namespace bd {
         return m_adaptive_sync;
     }
 
-    QSharedPointer<WaylandOutputMetaMode> WaylandOutputMetaHead::getCurrentMode() {
-        return m_current_mode;
+    WaylandOutputMetaMode WaylandOutputMetaHead::getCurrentMode() {
+        return m_modes.current();
     }
 
     QString WaylandOutputMetaHead::getDescription() {
@@ -54,49 +50,60 @@ namespace bd {
         return m_head;
     }
 
-    QString WaylandOutputMetaHead::getIdentifier() {
+    // generateIdentifier derives the identifier a head with these properties would have, without needing a meta head for it
+    QString WaylandOutputMetaHead::generateIdentifier(const QString &serial, const QString &make, const QString &model, const QString &name) {
         // Have a valid serial, use that as the identifier
-        if (!m_serial.isNull() && !m_serial.isEmpty()) {
-            return m_serial;
+        if (!serial.isNull() && !serial.isEmpty()) {
+            return serial;
         }
 
-        // Already generated an identifier
-        if (!m_identifier.isNull() && !m_identifier.isEmpty()) { return m_identifier; }
-
         // Default to unique name being machine ID + name
-        auto unique_name = QString{SysInfo::instance().getMachineId() + "_" + m_name};
+        auto unique_name = QString{SysInfo::instance().getMachineId() + "_" + name};
 
-        if (!m_make.isNull() && !m_model.isNull() && !m_make.isEmpty() && !m_model.isEmpty()) {
-            unique_name = QString {m_make + " " + m_model + " (" + m_name + ")"};
+        if (!make.isNull() && !model.isNull() && !make.isEmpty() && !model.isEmpty()) {
+            unique_name = QString {make + " " + model + " (" + name + ")"};
         }
 
         auto hash = QCryptographicHash::hash(unique_name.toUtf8(), QCryptographicHash::Md5);
 
-        m_identifier = QString{hash.toHex()};
+        return QString{hash.toHex()};
+    }
+
+    quint64 WaylandOutputMetaHead::getGeneration() {
+        return m_generation;
+    }
 
+    const QString &WaylandOutputMetaHead::getIdentifier() {
         return m_identifier;
     }
 
-    QSharedPointer<WaylandOutputMetaMode> WaylandOutputMetaHead::getModeForOutputHead(int width, int height, qulonglong refresh) {
-        for (const auto& mode_ptr: m_output_modes) {
-            if (!mode_ptr) continue;
+    OutputId WaylandOutputMetaHead::getOutputId() {
+        return m_output_id;
+    }
+
+    WaylandOutputMetaMode WaylandOutputMetaHead::getBestMode(ConfigurationModePolicy policy) {
+        return m_modes.best(policy);
+    }
 
-            auto mode = mode_ptr.data();
-            auto modeSizeOpt = mode->getSize();
-            auto modeRefreshOpt = mode->getRefresh();
-            if (!modeSizeOpt.has_value() || !modeRefreshOpt.has_value()) continue;
-            if (!modeSizeOpt.value().isValid()) continue;
-            auto modeSize = modeSizeOpt.value();
-            auto modeRefresh = static_cast<qulonglong>(modeRefreshOpt.value());
+    WaylandOutputMetaMode WaylandOutputMetaHead::getModeForOutputHead(int width, int height, qulonglong refresh) {
+        auto mode = m_modes.find(width, height, refresh);
+        if (!mode.isNull()) return mode;
 
-            if (modeSize.width() == width && modeSize.height() == height && modeRefresh == refresh) { return mode_ptr; }
+        mode = m_modes.findNearest(width, height, refresh, MaxRefreshDelta);
+        if (!mode.isNull()) {
+            qDebug() << "No exact mode for" << width << "x" << height << "@" << refresh << "on head" << getIdentifier() << ", using"
+                     << mode.getRefresh().value_or(0);
         }
 
-        return nullptr;
+        return mode;
+    }
+
+    QList<WaylandOutputMetaMode> WaylandOutputMetaHead::getModes() {
+        return m_modes.modes();
     }
 
-    QList<QSharedPointer<WaylandOutputMetaMode>> WaylandOutputMetaHead::getModes() {
-        return m_output_modes;
+    const QStringList &WaylandOutputMetaHead::getModeIds() {
+        return m_mode_ids;
     }
 
     QString WaylandOutputMetaHead::getMake() {
@@ -123,6 +130,11 @@ namespace bd {
         return m_transform;
     }
 
+    qint64 WaylandOutputMetaHead::getUnavailableFor() {
+        if (m_is_available || !m_unavailable_timer.isValid()) return -1;
+        return m_unavailable_timer.elapsed();
+    }
+
     std::optional<::zwlr_output_head_v1*> WaylandOutputMetaHead::getWlrHead() {
         if (!m_head) return std::nullopt;
         auto head = m_head.data()->getWlrHead();
@@ -135,8 +147,6 @@ namespace bd {
     }
 
     bool WaylandOutputMetaHead::isBuiltIn() {
-        // Generate identifier if necessary
-        getIdentifier();
         // Return if identifier exists
         return !m_identifier.isNull() && !m_identifier.isEmpty();
     }
@@ -151,15 +161,87 @@ namespace bd {
 
     // Setters
 
-    void WaylandOutputMetaHead::setHead(::zwlr_output_head_v1 *wlr_head) {
-        auto head = new WaylandOutputHead(this, wlr_head);
-        m_head = QSharedPointer<WaylandOutputHead>(head);
+    // commit swaps the pending state a WaylandOutputHead collected during one compositor transaction into this meta head. Nothing downstream sees
+    // the intermediate states, stateCommitted is emitted once everything has been applied.
+    void WaylandOutputMetaHead::commit(const WaylandOutputHeadSnapshot &snapshot, const QString &identifier) {
+        for (const auto &mode_snapshot: snapshot.added_modes) addMode(mode_snapshot);
+        for (const auto &mode: snapshot.removed_modes) removeMode(mode);
+        if (!snapshot.added_modes.isEmpty() || !snapshot.removed_modes.isEmpty()) {
+            m_modes.rank();
+
+            // Modes that look the same share an id (and D-Bus object)
+            m_mode_ids.clear();
+            for (const auto &mode: m_modes.modes()) m_mode_ids.append(mode.getId());
+            m_mode_ids.removeDuplicates();
+        }
+
+        // Our identifier is only regenerated when one of the properties it is derived from actually changed value
+        auto identity_changed = m_identifier.isEmpty();
+        auto setIdentifying = [&snapshot, &identity_changed](WaylandOutputMetaHeadProperty property, QString &field, const QString &value) {
+            if (!snapshot.hasChanged(property) || field == value) return;
+            field = value;
+            identity_changed = true;
+        };
+        setIdentifying(WaylandOutputMetaHeadProperty::Name, m_name, snapshot.name);
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::Description)) m_description = snapshot.description;
+        setIdentifying(WaylandOutputMetaHeadProperty::Make, m_make, snapshot.make);
+        setIdentifying(WaylandOutputMetaHeadProperty::Model, m_model, snapshot.model);
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::SerialNumber)) {
+            setIdentifying(WaylandOutputMetaHeadProperty::SerialNumber, m_serial, snapshot.serial);
+            qDebug() << "Setting serial number on head" << m_name << "to" << m_serial;
+        }
+        if (identity_changed) updateIdentifier(identifier);
+
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::Enabled)) {
+            m_enabled = snapshot.enabled;
+            qInfo() << "Setting enabled state on head" << getIdentifier() << "to" << m_enabled;
+        }
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::Position)) {
+            m_position = snapshot.position;
+            qDebug() << "Setting position on head" << getIdentifier() << "to" << m_position.x() << m_position.y();
+        }
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::Transform)) {
+            m_transform = static_cast<qint16>(snapshot.transform);
+            qDebug() << "Setting transform on head" << getIdentifier() << "to" << m_transform;
+        }
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::Scale)) {
+            m_scale = snapshot.scale;
+            qDebug() << "Setting scale on head" << getIdentifier() << "to" << m_scale;
+        }
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::AdaptiveSync)) {
+            m_adaptive_sync = static_cast<QtWayland::zwlr_output_head_v1::adaptive_sync_state>(snapshot.adaptive_sync);
+            qDebug() << "Setting adaptive sync on head" << getIdentifier() << "to" << m_adaptive_sync;
+        }
+
+        if (snapshot.hasChanged(WaylandOutputMetaHeadProperty::CurrentMode)) currentModeChanged(snapshot.current_mode);
+
+        if (snapshot.changed != 0 || !snapshot.added_modes.isEmpty() || !snapshot.removed_modes.isEmpty()) m_generation++;
+        if (snapshot.changed != 0) emit stateCommitted(snapshot.changed);
+        if (snapshot.finished && m_head == snapshot.head) headDisconnected();
+    }
+
+    // updateIdentifier rebuilds our identifier after the properties it is derived from changed, using identifier instead if we were given it
+    void WaylandOutputMetaHead::updateIdentifier(const QString &identifier) {
+        auto updated = identifier.isEmpty() ? generateIdentifier(m_serial, m_make, m_model, m_name) : identifier;
+        if (updated == m_identifier) return;
+
+        auto previous = m_identifier;
+        m_identifier = updated;
+        m_output_id = OutputIdTable::instance().intern(m_identifier);
+        if (previous.isEmpty()) return;
+
+        qInfo() << "Identifier for head" << m_name << "changed from" << previous << "to" << m_identifier;
+        emit identifierChanged(previous, m_identifier);
+    }
+
+    void WaylandOutputMetaHead::setHead(QSharedPointer<WaylandOutputHead> head) {
+        if (head.isNull()) return;
+        m_head = head;
         m_is_available = true;
+        m_unavailable_timer.invalidate();
+        // Availability is part of what a published topology reports, so it counts as a change
+        m_generation++;
         emit headAvailable();
-        connect(head, &WaylandOutputHead::headFinished, this, &WaylandOutputMetaHead::headDisconnected);
-        connect(head, &WaylandOutputHead::modeAdded, this, &WaylandOutputMetaHead::addMode);
-        connect(head, &WaylandOutputHead::modeChanged, this, &WaylandOutputMetaHead::currentModeChanged);
-        connect(head, &WaylandOutputHead::propertyChanged, this, &WaylandOutputMetaHead::setProperty);
     }
 
     void WaylandOutputMetaHead::setPosition(QPoint position) {
@@ -176,164 +258,67 @@ namespace bd {
         qDebug() << "Setting position on head" << getIdentifier() << "to" << m_position.x() << m_position.y();
         m_position.setX(position.x());
         m_position.setY(position.y());
-        emit propertyChanged(WaylandOutputMetaHeadProperty::Position, QVariant{m_position});
+        m_generation++;
+        emit metadataChanged();
+        emit stateCommitted(1u << WaylandOutputMetaHeadProperty::Position);
     }
 
     void WaylandOutputMetaHead::setPrimary(bool primary) {
         if (m_primary == primary) return;
         m_primary = primary;
+        m_generation++;
+        emit metadataChanged();
     }
 
     void WaylandOutputMetaHead::unsetModes() {
         qDebug() << "Unsetting modes for head: " << getIdentifier();
-        for (const auto& mode_ptr: m_output_modes) {
-            if (!mode_ptr) continue;
-            auto mode = mode_ptr.data();
-            mode->unsetMode(); // Unset the mode so it no longer holds a reference to a zwlr_output_mode_v1 (WaylandOutputMode)
-        }
+        m_modes.unsetModes(); // Drop our references to zwlr_output_mode_v1 (WaylandOutputMode) objects, keeping the modes themselves
     }
 
     // Slots
 
-    QSharedPointer<WaylandOutputMetaMode> WaylandOutputMetaHead::addMode(::zwlr_output_mode_v1 *mode) {
-        auto output_mode = new WaylandOutputMetaMode(this, mode);
-        auto shared_ptr = QSharedPointer<WaylandOutputMetaMode>(output_mode);
-
-        connect(output_mode, &WaylandOutputMetaMode::done, this, [this, output_mode, shared_ptr]() {
-            // Check if this already exists
-            for (const auto &mode_ptr: m_output_modes) {
-                if (!mode_ptr) continue;
-                auto existing_mode = mode_ptr.data();
-                // Already exists, set the wlr_mode of the existing mode and delete this newly created meta mode
-                if (existing_mode->isSameAs(output_mode)) {
-                    qDebug() << "Found an output mode that matches one we already have, deleting the new one.";
-                    auto wlr_mode_opt = output_mode->getWlrMode();
-                    if (wlr_mode_opt.has_value() && wlr_mode_opt.value() != nullptr) {
-                        qDebug() << "Setting existing mode to the new wlr_mode.";
-                        existing_mode->setMode(const_cast<::zwlr_output_mode_v1*>(wlr_mode_opt.value()));
-                    }
-//                    shared_ptr.clear();
-                    return;
-                }
-            }
-
-            // Doesn't already exist, add it
-            qDebug() << "Adding new output mode to head: " << getIdentifier() << " with size: "
-                     << output_mode->getSize().value_or(QSize(0, 0))
-                     << " and refresh: " << static_cast<qulonglong>(output_mode->getRefresh().value_or(0));
-            m_output_modes.append(shared_ptr);
-        });
-
-        return shared_ptr;
+    WaylandOutputMetaMode WaylandOutputMetaHead::addMode(const WaylandOutputModeSnapshot &mode) {
+        auto output_mode = m_modes.add(mode);
+        qDebug() << "Added output mode to head: " << getIdentifier() << " with size: " << output_mode.getSize().value_or(QSize(0, 0))
+                 << " and refresh: " << output_mode.getRefresh().value_or(0);
+        return output_mode;
     }
 
     void WaylandOutputMetaHead::currentModeChanged(::zwlr_output_mode_v1 *mode) {
         qDebug() << "Current mode changed for output: " << getIdentifier();
-        for (const auto &output_mode_ptr: m_output_modes) {
-            if (!output_mode_ptr || output_mode_ptr.isNull()) continue;
-            auto output_mode = output_mode_ptr.data();
-
-            auto output_mode_opt = output_mode->getWlrMode();
-            if (!output_mode_opt || !output_mode_opt.has_value()) {
-                qWarning() << "Output mode is not available, skipping.";
-                continue;
-            }
-
-            if (output_mode_opt.value() == mode) {
-                auto outputModeSizeOpt = output_mode->getSize();
-                if (!outputModeSizeOpt.has_value()) return;
-                if (!outputModeSizeOpt.value().isValid()) return;
-
-                auto refreshOpt = output_mode->getRefresh();
-                if (!refreshOpt.has_value()) return;
-
-                auto outputModeSize = outputModeSizeOpt.value();
-                auto refresh = refreshOpt.value();
-                qDebug() << "Setting current mode to" << outputModeSize.width() << "x" << outputModeSize.height() << "@"
-                         << refresh;
-                m_current_mode = output_mode_ptr; // Set m_current_mode to same QSharedPointer as iterated output mode
-                return;
-            }
+        auto output_mode = m_modes.findByWlrMode(mode);
+        if (output_mode.isNull()) {
+            qWarning() << "Current mode is not one we know about, skipping.";
+            return;
         }
 
-//        auto meta_mode_ptr = addMode(mode); // Add the mode to the list of modes. If it already exists then we'll assign it to an existing Mode
-//        if (meta_mode_ptr.isNull()) {
-//            qWarning() << "Failed to add mode, meta_mode_ptr is null.";
-//            return;
-//        }
-//        auto meta_mode = meta_mode_ptr.data();
-//        if (meta_mode->isAvailable().value()) {
-//            qDebug() << "(Mode already available) Current mode set to:" << meta_mode->getSize().value_or(QSize(0, 0))
-//                     << "with refresh:" << meta_mode->getRefresh().value_or(0);
-//            m_current_mode = meta_mode_ptr; // Set the current mode already since it is available
-//        } else { // Not available yet
-//            connect(meta_mode, &WaylandOutputMetaMode::done, this, [this, meta_mode_ptr, meta_mode]() {
-//                // Set the current mode to the one that was just added
-//                qDebug() << "(Mode done) Current mode set to:" << meta_mode->getSize().value_or(QSize(0, 0))
-//                         << "with refresh:" << meta_mode->getRefresh().value_or(0);
-//                m_current_mode = meta_mode_ptr;
-//            });
-//        }
+        auto outputModeSizeOpt = output_mode.getSize();
+        auto refreshOpt = output_mode.getRefresh();
+        if (!outputModeSizeOpt.has_value() || !refreshOpt.has_value()) return;
+
+        qDebug() << "Setting current mode to" << outputModeSizeOpt->width() << "x" << outputModeSizeOpt->height() << "@" << refreshOpt.value();
+        m_modes.setCurrent(output_mode);
+    }
+
+    // removeMode drops the row bound to a mode the compositor has finished. Anything still exposing it (like its D-Bus object) is told through
+    // modeRemoved.
+    void WaylandOutputMetaHead::removeMode(const QSharedPointer<WaylandOutputMode> &mode) {
+        auto id = m_modes.remove(mode);
+        if (id.isNull()) return;
+
+        qDebug() << "Removing finished output mode" << id << "from head:" << getIdentifier();
+        emit modeRemoved(id);
     }
 
     void WaylandOutputMetaHead::headDisconnected() {
         qDebug() << "Head disconnected for output: " << getIdentifier();
         m_head.clear();
         m_is_available = false;
+        m_unavailable_timer.start();
+        m_generation++;
         emit headNoLongerAvailable();
     }
 
-    void WaylandOutputMetaHead::setProperty(WaylandOutputMetaHeadProperty property, const QVariant &value) {
-        bool changed = true;
-
-        switch (property) {
-            case WaylandOutputMetaHeadProperty::AdaptiveSync:
-                m_adaptive_sync = static_cast<QtWayland::zwlr_output_head_v1::adaptive_sync_state>(value.toInt());
-                qDebug() << "Setting adaptive sync on head" << getIdentifier() << "to" << m_adaptive_sync;
-                break;
-            case WaylandOutputMetaHeadProperty::Description:
-                m_description = value.toString();
-                qDebug() << "Output head finished, emitting headNoLongerAvailable: " << getIdentifier()
-                         << " with description: " << m_description;
-                break;
-            case WaylandOutputMetaHeadProperty::Enabled:
-                m_enabled = value.toBool();
-                qInfo() << "Setting enabled state on head" << getIdentifier() << "to" << m_enabled;
-                break;
-            case WaylandOutputMetaHeadProperty::Make:
-                m_make = value.toString();
-                break;
-            case WaylandOutputMetaHeadProperty::Model:
-                m_model = value.toString();
-                break;
-            case WaylandOutputMetaHeadProperty::Name:
-                m_name = value.toString();
-                break;
-            case WaylandOutputMetaHeadProperty::Position:
-                m_position = value.toPoint();
-                qDebug() << "Setting position on head" << getIdentifier() << "to" << m_position.x() << m_position.y();
-                break;
-            case WaylandOutputMetaHeadProperty::Scale:
-                m_scale = value.toDouble();
-                qDebug() << "Setting scale on head" << getIdentifier() << "to" << m_scale;
-                break;
-            case WaylandOutputMetaHeadProperty::SerialNumber:
-                m_serial = value.toString();
-                qDebug() << "Setting serial number on head" << getIdentifier() << "to" << m_serial;
-                break;
-            case WaylandOutputMetaHeadProperty::Transform:
-                m_transform = value.toInt();
-                qDebug() << "Setting transform on head" << getIdentifier() << "to" << m_transform;
-                break;
-            default:
-                qWarning() << "Unknown property" << property << "for output head";
-                changed = false;
-                break;
-        }
-
-        if (changed) { emit propertyChanged(property, value); }
-    }
-
     // Anchoring/relative configuration accessors
     QString WaylandOutputMetaHead::getRelativeOutput() {
         return m_relative_output;
@@ -348,19 +333,28 @@ namespace bd {
     }
 
     void WaylandOutputMetaHead::setRelativeOutput(const QString &relative) {
+        if (m_relative_output == relative) return;
         m_relative_output = relative;
         qDebug() << "Relative output set for head" << getIdentifier() << "relative:" << m_relative_output;
+        m_generation++;
+        emit metadataChanged();
     }
 
     void WaylandOutputMetaHead::setHorizontalAnchoring(ConfigurationHorizontalAnchor horizontal) {
+        if (m_horizontal_anchor == horizontal) return;
         m_horizontal_anchor = horizontal;
         qDebug() << "Horizontal anchoring set for head" << getIdentifier()
                  << "h:" << bd::DisplayConfigurationUtils::getHorizontalAnchorString(m_horizontal_anchor).c_str();
+        m_generation++;
+        emit metadataChanged();
     }
 
     void WaylandOutputMetaHead::setVerticalAnchoring(ConfigurationVerticalAnchor vertical) {
+        if (m_vertical_anchor == vertical) return;
         m_vertical_anchor = vertical;
         qDebug() << "Vertical anchoring set for head" << getIdentifier()
                  << "v:" << bd::DisplayConfigurationUtils::getVerticalAnchorString(m_vertical_anchor).c_str();
+        m_generation++;
+        emit metadataChanged();
     }
 }
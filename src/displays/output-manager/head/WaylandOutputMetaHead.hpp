@@ -1,13 +1,18 @@
 #pragma once
 
-#include <KWayland/Client/registry.h>
-
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPoint>
+#include <QStringList>
 #include <optional>
 
+#include "displays/OutputId.hpp"
+#include "displays/output-manager/WaylandRegistry.hpp"
+
 #include "displays/output-manager/head/WaylandOutputHead.hpp"
+#include "displays/output-manager/head/WaylandOutputHeadSnapshot.hpp"
 #include "displays/output-manager/mode/WaylandOutputMetaMode.hpp"
+#include "displays/output-manager/mode/WaylandOutputModeTable.hpp"
 #include "enums.hpp"
 #include "displays/batch-system/enums.hpp"
 
@@ -17,13 +22,19 @@ namespace bd {
     Q_OBJECT
 
     public:
-        WaylandOutputMetaHead(QObject *parent, KWayland::Client::Registry *registry);
+        static constexpr qulonglong MaxRefreshDelta = 1000; // mHz
+        WaylandOutputMetaHead(QObject *parent, WaylandRegistry *registry);
 
         ~WaylandOutputMetaHead() override;
 
+        static QString generateIdentifier(const QString &serial, const QString &make, const QString &model, const QString &name);
+
         QtWayland::zwlr_output_head_v1::adaptive_sync_state getAdaptiveSync();
 
-        QSharedPointer<WaylandOutputMetaMode> getCurrentMode();
+        // getBestMode returns the mode policy ranks highest among our modes, null if we have none
+        WaylandOutputMetaMode getBestMode(ConfigurationModePolicy policy);
+
+        WaylandOutputMetaMode getCurrentMode();
 
         QString getDescription();
 
@@ -31,15 +42,26 @@ namespace bd {
 
         ConfigurationHorizontalAnchor getHorizontalAnchor();
 
-        QString getIdentifier();
+        // getGeneration returns a counter bumped every time anything about this head changes, so callers can tell whether to re-read it
+        quint64 getGeneration();
+
+        // getIdentifier returns the identifier built when our name, make, model or serial were last committed, empty until the first commit
+        const QString &getIdentifier();
+
+        OutputId getOutputId();
 
         QString getMake();
 
         QString getModel();
 
-        QSharedPointer<WaylandOutputMetaMode> getModeForOutputHead(int width, int height, qulonglong refresh);
+        // getModeForOutputHead returns our mode with this size and refresh (mHz), falling back to the one with the closest refresh within
+        // MaxRefreshDelta so a config saying 60000 still finds a 59940 mode instead of needing a custom mode
+        WaylandOutputMetaMode getModeForOutputHead(int width, int height, qulonglong refresh);
+
+        QList<WaylandOutputMetaMode> getModes();
 
-        QList<QSharedPointer<WaylandOutputMetaMode>> getModes();
+        // getModeIds returns the getId of each of our modes, each id once. It is only rebuilt when our modes change, so it is cheap to copy.
+        const QStringList &getModeIds();
 
         QString getName();
 
@@ -51,6 +73,9 @@ namespace bd {
 
         int getTransform();
 
+        // getUnavailableFor returns how many milliseconds ago our head was disconnected, -1 while we have one
+        qint64 getUnavailableFor();
+
         ConfigurationVerticalAnchor getVerticalAnchor();
 
         std::optional<::zwlr_output_head_v1*> getWlrHead();
@@ -60,7 +85,11 @@ namespace bd {
         bool isEnabled();
         bool isPrimary();
 
-        void setHead(::zwlr_output_head_v1 *head);
+        // commit applies a transaction's snapshot. identifier, if given, is what generateIdentifier makes of the snapshot's identifying properties,
+        // for a caller that already had to work it out. It is only used if this commit changes our identifier.
+        void commit(const WaylandOutputHeadSnapshot &snapshot, const QString &identifier = QString());
+
+        void setHead(QSharedPointer<WaylandOutputHead> head);
 
         void setHorizontalAnchoring(ConfigurationHorizontalAnchor horizontal);
 
@@ -79,35 +108,50 @@ namespace bd {
 
         void headNoLongerAvailable();
 
-        void propertyChanged(WaylandOutputMetaHeadProperty property, const QVariant &value);
+        // Emitted when the compositor finished a mode and it was removed from our table, id is what getId() returned for it
+        void modeRemoved(const QString &id);
+
+        // Emitted when a commit changed the properties our identifier is derived from enough to change the identifier itself
+        void identifierChanged(const QString &previous, const QString &current);
+
+        // Emitted when something we track outside of compositor transactions (position, anchoring, primary) is changed on us directly
+        void metadataChanged();
+
+        // Emitted once per committed compositor transaction, changed is a bitmask of WaylandOutputMetaHeadProperty values
+        void stateCommitted(quint32 changed);
 
     public slots:
 
-        QSharedPointer<WaylandOutputMetaMode> addMode(::zwlr_output_mode_v1 *mode);
+        WaylandOutputMetaMode addMode(const WaylandOutputModeSnapshot &mode);
 
         void currentModeChanged(::zwlr_output_mode_v1 *mode);
 
         void headDisconnected();
 
-        void setProperty(WaylandOutputMetaHeadProperty property, const QVariant &value);
+        void removeMode(const QSharedPointer<WaylandOutputMode> &mode);
 
     private:
-        KWayland::Client::Registry *m_registry;
+        void updateIdentifier(const QString &identifier);
+
+        WaylandRegistry *m_registry;
         QSharedPointer<WaylandOutputHead> m_head;
         QString m_make;
         QString m_model;
         QString m_name;
         QString m_description;
         QString m_identifier;
-        QList<QSharedPointer<WaylandOutputMetaMode>> m_output_modes;
+        OutputId m_output_id;
+        quint64 m_generation;
+        WaylandOutputModeTable m_modes;
+        QStringList m_mode_ids;
         QString m_serial;
-        QSharedPointer<WaylandOutputMetaMode> m_current_mode;
 
         QPoint m_position;
         qint16 m_transform;
         qreal m_scale;
 
         bool m_is_available;
+        QElapsedTimer m_unavailable_timer;
         bool m_enabled;
         QtWayland::zwlr_output_head_v1::adaptive_sync_state m_adaptive_sync;
 
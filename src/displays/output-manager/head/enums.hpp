@@ -12,5 +12,7 @@ namespace bd {
     Scale,
     SerialNumber,
     Transform,
+    CurrentMode,
+    Modes,
   };
 }
@@ -1,141 +1,54 @@
-#include <QPointer>
 #include "WaylandOutputMetaMode.hpp"
 
+#include "WaylandOutputModeTable.hpp"
+
 namespace bd {
-    WaylandOutputMetaMode::WaylandOutputMetaMode(QObject *parent, ::zwlr_output_mode_v1 *wlr_mode)
-            : QObject(parent), m_id(QString()), m_mode(QSharedPointer<WaylandOutputMode>(nullptr)), m_refresh(0), m_preferred(std::nullopt), m_size(QSize{0, 0}),
-              m_is_available(std::nullopt) {
-        setMode(wlr_mode);
-    }
+    WaylandOutputMetaMode::WaylandOutputMetaMode(const WaylandOutputModeTable *table, quint32 slot, quint32 generation)
+            : m_table(table), m_slot(slot), m_generation(generation) {}
 
-    WaylandOutputMetaMode::~WaylandOutputMetaMode() {
-        unsetMode(); // Unset the mode to ensure no references are held
-        m_preferred = std::nullopt; // Clear preferred state
+    // getId is {width}_{height}_{refresh}, which is DBus object-path safe
+    QString WaylandOutputMetaMode::getId() const {
+        if (isNull()) return QString();
+        return QString("%1_%2_%3").arg(m_table->m_widths.at(m_slot)).arg(m_table->m_heights.at(m_slot)).arg(m_table->m_refreshes.at(m_slot));
     }
 
-    QString WaylandOutputMetaMode::getId() {
-        return m_id;
+    std::optional<qulonglong> WaylandOutputMetaMode::getRefresh() const {
+        if (isNull() || m_table->m_refreshes.at(m_slot) == 0) return std::nullopt;
+        return std::make_optional(m_table->m_refreshes.at(m_slot));
     }
 
-    std::optional<qulonglong> WaylandOutputMetaMode::getRefresh() {
-        if (m_refresh == 0) return std::nullopt;
-        return std::make_optional(m_refresh);
+    std::optional<QSize> WaylandOutputMetaMode::getSize() const {
+        if (isNull()) return std::nullopt;
+        auto size = QSize(m_table->m_widths.at(m_slot), m_table->m_heights.at(m_slot));
+        if (size.isEmpty() || size.isNull()) return std::nullopt;
+        return std::make_optional(size);
     }
 
-    std::optional<QSize> WaylandOutputMetaMode::getSize() {
-        if (m_size.isEmpty() || m_size.isNull()) return std::nullopt;
-        return std::make_optional(m_size);
+    QSharedPointer<WaylandOutputMode> WaylandOutputMetaMode::getMode() const {
+        if (isNull()) return nullptr;
+        return m_table->m_wrappers.at(m_slot);
     }
 
-    std::optional<const ::zwlr_output_mode_v1*> WaylandOutputMetaMode::getWlrMode() {
-        if (!m_mode || m_mode.isNull()) return std::nullopt;
-        return m_mode->getWlrMode();
+    std::optional<const ::zwlr_output_mode_v1*> WaylandOutputMetaMode::getWlrMode() const {
+        auto mode = getMode();
+        if (mode.isNull()) return std::nullopt;
+        return mode->getWlrMode();
     }
 
-    std::optional<bool> WaylandOutputMetaMode::isAvailable() {
-        return m_is_available;
+    bool WaylandOutputMetaMode::isAvailable() const {
+        return !getMode().isNull();
     }
 
-    std::optional<bool> WaylandOutputMetaMode::isPreferred() {
-        return m_preferred;
+    bool WaylandOutputMetaMode::isCurrent() const {
+        return !isNull() && m_table->current() == *this;
     }
 
-    bool WaylandOutputMetaMode::isSameAs(WaylandOutputMetaMode *mode) {
-        if (mode == nullptr) { return false; }
-
-        auto r_refresh = mode->getRefresh();
-        if (!r_refresh) { return false; }
-
-        auto r_size = mode->getSize();
-        if (!r_size) { return false; }
-
-        auto refresh = getRefresh();
-        if (!refresh) { return false; }
-
-        auto size = getSize();
-        if (!size) { return false; }
-
-        auto same = r_refresh.value() == refresh.value() && r_size.value() == size.value();
-        if (same) {
-            qDebug() << "Mode is same as ours, with refresh:" << r_refresh.value() << "and size:" << r_size.value();
-        }
-
-        return same;
-    }
-
-    // Setters
-
-    void WaylandOutputMetaMode::setMode(::zwlr_output_mode_v1 *wlr_mode) {
-        if (wlr_mode == nullptr) {
-            qWarning() << "Received null wlr_mode, doing nothing.";
-            return;
-        }
-        unsetMode(); // Unset any existing mode
-
-        qDebug() << "Setting new mode with Wayland object:" << (void*)wlr_mode;
-        auto mode = new WaylandOutputMode(wlr_mode);
-        m_mode = QSharedPointer<WaylandOutputMode>(mode);
-//        connect(mode, &WaylandOutputMode::modeFinished, this, &WaylandOutputMetaMode::modeDisconnected);
-
-        connect(mode, &WaylandOutputMode::propertyChanged,
-                this, &WaylandOutputMetaMode::setProperty);
+    bool WaylandOutputMetaMode::isNull() const {
+        return m_table == nullptr || !m_table->isLive(m_slot, m_generation);
     }
 
-    void WaylandOutputMetaMode::unsetMode() {
-        if (!m_mode.isNull()) {
-            m_mode.clear();
-        }
-        m_is_available = std::make_optional<bool>(false);
-    }
-
-    // Slots
-
-    void WaylandOutputMetaMode::modeDisconnected() {
-        unsetMode();
-        emit modeNoLongerAvailable();
-        m_is_available = std::make_optional<bool>(false);
-    }
-
-    void WaylandOutputMetaMode::setPreferred(bool preferred) {
-        m_preferred = std::make_optional<bool>(preferred);
-        emit propertyChanged(WaylandOutputMetaModeProperty::Preferred, QVariant::fromValue(preferred));
-    }
-
-    void WaylandOutputMetaMode::setProperty(WaylandOutputMetaModeProperty property, const QVariant &value) {
-        bool changed = true;
-        switch (property) {
-            case WaylandOutputMetaModeProperty::Preferred:
-                m_preferred = std::make_optional<bool>(value.toBool());
-                break;
-            case WaylandOutputMetaModeProperty::Refresh:
-                m_refresh = static_cast<qulonglong>(value.toULongLong());
-                break;
-            case WaylandOutputMetaModeProperty::Size:
-                m_size = value.toSize();
-                break;
-            default:
-                changed = false;
-                break;
-        }
-
-        if (changed) {
-            emit propertyChanged(property, value);
-
-            auto refresh = getRefresh();
-            auto size = getSize();
-
-            if (!refresh.has_value()) return;
-            if (!size.has_value()) return;
-            if (!size.value().isValid()) return;
-
-            // Compute ID string as {width}_{height}_{refresh} and ensure it's DBus object-path safe
-            const auto sz = size.value();
-            const auto ref = refresh.value();
-            m_id = QString("%1_%2_%3").arg(sz.width()).arg(sz.height()).arg(ref);
-            // no decimal in integer refresh
-
-            m_is_available = true;
-            emit done();
-        }
+    bool WaylandOutputMetaMode::isPreferred() const {
+        if (isNull()) return false;
+        return (m_table->m_flags.at(m_slot) & WaylandOutputModeTable::Preferred) != 0;
     }
 }
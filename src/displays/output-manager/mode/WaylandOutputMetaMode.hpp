@@ -1,61 +1,50 @@
 #pragma once
 
-#include <QObject>
+#include <QSharedPointer>
 #include <QSize>
-#include <QVariant>
 #include <QString>
 #include <optional>
 
 #include "WaylandOutputMode.hpp"
 
 namespace bd {
-    class WaylandOutputMetaMode : public QObject {
-    Q_OBJECT
+    class WaylandOutputModeTable;
 
-    public:
-        WaylandOutputMetaMode(QObject *parent, ::zwlr_output_mode_v1 *wlr_mode);
-        ~WaylandOutputMetaMode() override;
-
-        QString getId();
-
-        std::optional<qulonglong> getRefresh();
-
-        std::optional<QSize> getSize();
+    // WaylandOutputMetaMode is a lightweight handle to a row in the WaylandOutputModeTable of the meta head that owns the mode. It is cheap to copy
+    // and compare, and goes null (rather than dangling) once the compositor finishes the mode and its row is freed. A handle must not outlive the
+    // meta head it came from.
+    class WaylandOutputMetaMode {
+        friend class WaylandOutputModeTable;
 
-        std::optional<const ::zwlr_output_mode_v1*> getWlrMode();
-
-        std::optional<bool> isAvailable();
-
-        std::optional<bool> isPreferred();
+    public:
+        WaylandOutputMetaMode() = default;
+        WaylandOutputMetaMode(const WaylandOutputModeTable *table, quint32 slot, quint32 generation);
 
-        bool isSameAs(WaylandOutputMetaMode *mode);
+        QString getId() const;
 
-        void setMode(::zwlr_output_mode_v1 *wlr_mode);
+        std::optional<qulonglong> getRefresh() const;
 
-        void setPreferred(bool preferred);
+        std::optional<QSize> getSize() const;
 
-        void unsetMode();
+        QSharedPointer<WaylandOutputMode> getMode() const;
 
-    signals:
+        std::optional<const ::zwlr_output_mode_v1*> getWlrMode() const;
 
-        void done();
+        bool isAvailable() const;
 
-        void modeNoLongerAvailable();
+        bool isCurrent() const;
 
-        void propertyChanged(WaylandOutputMetaModeProperty property, const QVariant &value);
+        bool isNull() const;
 
-    public slots:
+        bool isPreferred() const;
 
-        void modeDisconnected();
+        explicit operator bool() const { return !isNull(); }
 
-        void setProperty(WaylandOutputMetaModeProperty property, const QVariant &value);
+        bool operator==(const WaylandOutputMetaMode &other) const = default;
 
     private:
-        QSharedPointer<WaylandOutputMode> m_mode;
-        QString m_id;
-        QSize m_size;
-        qulonglong m_refresh;
-        std::optional<bool> m_preferred;
-        std::optional<bool> m_is_available;
+        const WaylandOutputModeTable *m_table = nullptr;
+        quint32 m_slot = 0;
+        quint32 m_generation = 0;
     };
 }
@@ -1,29 +1,73 @@
 #include "WaylandOutputMode.hpp"
 
+#include "displays/output-manager/WaylandProtocolRecorder.hpp"
+
 namespace bd {
-    WaylandOutputMode::WaylandOutputMode(::zwlr_output_mode_v1* mode) : zwlr_output_mode_v1(mode) {}
+    WaylandOutputMode::WaylandOutputMode(::zwlr_output_mode_v1* mode)
+        : zwlr_output_mode_v1(mode), m_size(QSize {0, 0}), m_refresh(0), m_preferred(false), m_finished(false), m_released(false) {}
 
     std::optional<::zwlr_output_mode_v1*> WaylandOutputMode::getWlrMode() {
-        if (isInitialized() && object()) {
+        if (!m_released && isInitialized() && object()) {
             return std::make_optional(object());
         }
         return std::nullopt;
     }
 
+  QSize WaylandOutputMode::getSize() const {
+    return m_size;
+  }
+
+  qulonglong WaylandOutputMode::getRefresh() const {
+    return m_refresh;
+  }
+
+  bool WaylandOutputMode::isFinished() const {
+    return m_finished;
+  }
+
+  bool WaylandOutputMode::isPreferred() const {
+    return m_preferred;
+  }
+
+  // abandon destroys our proxy without sending anything, for when the connection it belongs to is already gone
+  void WaylandOutputMode::abandon() {
+    auto wlr_mode = getWlrMode();
+    if (!wlr_mode.has_value()) return;
+    wl_proxy_destroy(reinterpret_cast<wl_proxy*>(wlr_mode.value()));
+    m_released = true;
+  }
+
+  // releaseProxy tells the compositor we are done with this mode (protocol version 3 and later) and destroys our proxy
+  void WaylandOutputMode::releaseProxy() {
+    auto wlr_mode = getWlrMode();
+    if (!wlr_mode.has_value()) return;
+
+    if (wl_proxy_get_version(reinterpret_cast<wl_proxy*>(wlr_mode.value())) >= ZWLR_OUTPUT_MODE_V1_RELEASE_SINCE_VERSION) {
+      release();
+    } else {
+      wl_proxy_destroy(reinterpret_cast<wl_proxy*>(wlr_mode.value()));
+    }
+    m_released = true;
+  }
+
   void WaylandOutputMode::zwlr_output_mode_v1_size(int32_t width, int32_t height) {
-    emit propertyChanged(WaylandOutputMetaModeProperty::Size, QVariant {QSize(width, height)});
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ModeSize, object(), width, height);
+    m_size = QSize(width, height);
   }
 
   void WaylandOutputMode::zwlr_output_mode_v1_refresh(int32_t refresh) {
-    auto val = QVariant::fromValue(refresh);
-    emit propertyChanged(WaylandOutputMetaModeProperty::Refresh, val);
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ModeRefresh, object(), refresh);
+    m_refresh = static_cast<qulonglong>(refresh);
   }
 
   void WaylandOutputMode::zwlr_output_mode_v1_preferred() {
-    emit propertyChanged(WaylandOutputMetaModeProperty::Preferred, QVariant::fromValue(true));
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ModePreferred, object());
+    m_preferred = true;
   }
 
-//  void WaylandOutputMode::zwlr_output_mode_v1_finished() {
-//    emit modeFinished();
-//  }
+  void WaylandOutputMode::zwlr_output_mode_v1_finished() {
+    WaylandProtocolRecorder::instance().record(WaylandProtocolEvent::ModeFinished, object());
+    // The owning head notices this when it is next snapshotted, the proxy is released once the meta modes have let go of it
+    m_finished = true;
+  }
 }
@@ -1,29 +1,39 @@
 #pragma once
-#include <QObject>
 #include <QSize>
-#include <QVariant>
+#include <optional>
 
-#include "enums.hpp"
 #include "qwayland-wlr-output-management-unstable-v1.h"
 
 namespace bd {
-  class WaylandOutputMode : public QObject, public QtWayland::zwlr_output_mode_v1 {
-      Q_OBJECT
-
+  // WaylandOutputMode wraps a zwlr_output_mode_v1 proxy and records what the compositor advertised for it. The owning WaylandOutputHead reads these
+  // values when it is snapshotted.
+  class WaylandOutputMode : public QtWayland::zwlr_output_mode_v1 {
     public:
       WaylandOutputMode(::zwlr_output_mode_v1* mode);
 
       std::optional<::zwlr_output_mode_v1*> getWlrMode();
 
-    signals:
-      void propertyChanged(WaylandOutputMetaModeProperty property, const QVariant& value);
-      void modeFinished();
+      QSize      getSize() const;
+      qulonglong getRefresh() const;
+      bool       isFinished() const;
+      bool       isPreferred() const;
+
+      void abandon();
+      void releaseProxy();
 
     protected:
+      friend class WaylandProtocolReplay;
+
       void zwlr_output_mode_v1_size(int32_t width, int32_t height) override;
       void zwlr_output_mode_v1_refresh(int32_t refresh) override;
       void zwlr_output_mode_v1_preferred() override;
-//      void zwlr_output_mode_v1_finished() override;
+      void zwlr_output_mode_v1_finished() override;
 
+    private:
+      QSize      m_size;
+      qulonglong m_refresh;
+      bool       m_preferred;
+      bool       m_finished;
+      bool       m_released;
   };
 }
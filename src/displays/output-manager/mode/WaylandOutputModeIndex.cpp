@@ -0,0 +1,78 @@
+#include "WaylandOutputModeIndex.hpp"
+
+#include <algorithm>
+
+namespace bd {
+    std::optional<quint32> WaylandOutputModeIndex::find(const WaylandOutputModeKey &key) const {
+        auto it = m_slots.constFind(key);
+        if (it == m_slots.constEnd()) return std::nullopt;
+        return it.value();
+    }
+
+    // findNearest returns the slot of the mode of this size whose refresh is closest to the one asked for, as long as it is within tolerance (mHz)
+    std::optional<quint32> WaylandOutputModeIndex::findNearest(int width, int height, qulonglong refresh, qulonglong tolerance) const {
+        auto bucket = m_refreshes_by_size.constFind(sizeKey(width, height));
+        if (bucket == m_refreshes_by_size.constEnd() || bucket->isEmpty()) return std::nullopt;
+
+        const auto &entries = bucket.value();
+        auto it = std::lower_bound(entries.cbegin(), entries.cend(), refresh,
+                                   [](const RefreshEntry &entry, qulonglong value) { return entry.refresh < value; });
+
+        auto best = std::optional<quint32>();
+        auto best_delta = tolerance;
+
+        // Only the entries either side of where this refresh would sit can be the closest
+        if (it != entries.cend()) {
+            auto delta = it->refresh - refresh;
+            if (delta <= best_delta) {
+                best = it->slot;
+                best_delta = delta;
+            }
+        }
+        if (it != entries.cbegin()) {
+            auto prev = std::prev(it);
+            // Slots sharing a refresh are in the order they were inserted, the first is the one find would return
+            while (prev != entries.cbegin() && std::prev(prev)->refresh == prev->refresh) prev = std::prev(prev);
+            auto delta = refresh - prev->refresh;
+            if (delta <= best_delta && (!best.has_value() || delta < best_delta)) best = prev->slot;
+        }
+
+        return best;
+    }
+
+    // insert indexes a slot under key, returning false if another slot already has that key. That slot is still the one found for key, this one
+    // only takes over once it is removed.
+    bool WaylandOutputModeIndex::insert(const WaylandOutputModeKey &key, quint32 slot) {
+        auto first = !m_slots.contains(key);
+        if (first) m_slots.insert(key, slot);
+
+        auto &entries = m_refreshes_by_size[sizeKey(key.width, key.height)];
+        auto it = std::upper_bound(entries.begin(), entries.end(), key.refresh,
+                                   [](qulonglong value, const RefreshEntry &entry) { return value < entry.refresh; });
+        entries.insert(it, RefreshEntry{key.refresh, slot});
+        return first;
+    }
+
+    void WaylandOutputModeIndex::remove(const WaylandOutputModeKey &key, quint32 slot) {
+        auto bucket = m_refreshes_by_size.find(sizeKey(key.width, key.height));
+        if (bucket == m_refreshes_by_size.end()) return;
+        bucket->removeIf([&key, slot](const RefreshEntry &entry) { return entry.refresh == key.refresh && entry.slot == slot; });
+
+        auto found = m_slots.find(key);
+        if (found != m_slots.end() && found.value() == slot) {
+            auto next = std::lower_bound(bucket->cbegin(), bucket->cend(), key.refresh,
+                                         [](const RefreshEntry &entry, qulonglong value) { return entry.refresh < value; });
+            if (next != bucket->cend() && next->refresh == key.refresh) {
+                found.value() = next->slot;
+            } else {
+                m_slots.erase(found);
+            }
+        }
+        if (bucket->isEmpty()) m_refreshes_by_size.erase(bucket);
+    }
+
+    void WaylandOutputModeIndex::clear() {
+        m_slots.clear();
+        m_refreshes_by_size.clear();
+    }
+}
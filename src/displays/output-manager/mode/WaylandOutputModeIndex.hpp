@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <optional>
+
+namespace bd {
+    // WaylandOutputModeKey identifies a mode by what it looks like rather than which protocol object advertised it. Refresh is in mHz.
+    struct WaylandOutputModeKey {
+        int width = 0;
+        int height = 0;
+        qulonglong refresh = 0;
+
+        bool operator==(const WaylandOutputModeKey &other) const = default;
+    };
+
+    inline size_t qHash(const WaylandOutputModeKey &key, size_t seed = 0) {
+        return qHashMulti(seed, key.width, key.height, key.refresh);
+    }
+
+    // WaylandOutputModeIndex maps a mode key to its slot in a WaylandOutputModeTable, hashed for exact lookups and per size sorted by refresh so
+    // the closest refresh rate can be found without walking every mode. It is updated as modes are added and removed, never rebuilt.
+    //
+    // More than one slot can have the same key, the one inserted first is found until it is removed and the next one takes over.
+    class WaylandOutputModeIndex {
+    public:
+        std::optional<quint32> find(const WaylandOutputModeKey &key) const;
+        std::optional<quint32> findNearest(int width, int height, qulonglong refresh, qulonglong tolerance) const;
+
+        bool insert(const WaylandOutputModeKey &key, quint32 slot);
+        void remove(const WaylandOutputModeKey &key, quint32 slot);
+        void clear();
+
+    private:
+        struct RefreshEntry {
+            qulonglong refresh;
+            quint32 slot;
+        };
+
+        static quint64 sizeKey(int width, int height) {
+            return (static_cast<quint64>(static_cast<quint32>(width)) << 32) | static_cast<quint32>(height);
+        }
+
+        QHash<WaylandOutputModeKey, quint32> m_slots;
+        QHash<quint64, QList<RefreshEntry>> m_refreshes_by_size;
+    };
+}
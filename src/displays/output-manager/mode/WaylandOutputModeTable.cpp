@@ -0,0 +1,219 @@
+#include "WaylandOutputModeTable.hpp"
+
+#include <QDebug>
+
+#include "displays/output-manager/head/WaylandOutputHeadSnapshot.hpp"
+
+namespace bd {
+    // add records a mode the compositor advertised. If we already have a row that looks the same and was left without a protocol object by a
+    // reconnect, that row takes over the new one instead, so the mode keeps its handles (and D-Bus object). A row that still has a protocol object
+    // belongs to another mode, even one that looks the same, so the new mode gets a row of its own.
+    WaylandOutputMetaMode WaylandOutputModeTable::add(const WaylandOutputModeSnapshot &mode) {
+        auto key = WaylandOutputModeKey{mode.size.width(), mode.size.height(), mode.refresh};
+        auto has_key = mode.size.isValid() && !mode.size.isEmpty() && mode.refresh != 0;
+        auto flags = static_cast<quint8>(Live | (mode.preferred ? Preferred : 0));
+
+        if (has_key) {
+            auto existing = m_index.find(key);
+            if (existing.has_value() && m_wrappers.at(existing.value()).isNull()) {
+                qDebug() << "Found an output mode that matches one we already have, setting existing mode to the new wlr_mode.";
+                auto slot = existing.value();
+                m_flags[slot] = flags;
+                bind(slot, mode.mode);
+                return handleFor(slot);
+            }
+        }
+
+        auto slot = quint32{0};
+        if (!m_free_slots.isEmpty()) {
+            slot = m_free_slots.takeLast();
+            m_widths[slot] = key.width;
+            m_heights[slot] = key.height;
+            m_refreshes[slot] = key.refresh;
+            m_flags[slot] = flags;
+        } else {
+            slot = static_cast<quint32>(m_widths.size());
+            m_widths.append(key.width);
+            m_heights.append(key.height);
+            m_refreshes.append(key.refresh);
+            m_flags.append(flags);
+            m_generations.append(0);
+            m_wrappers.append(nullptr);
+        }
+        bind(slot, mode.mode);
+
+        // Modes we do not know the size or refresh of can't be told apart, so they are kept but never matched against
+        if (has_key) m_index.insert(key, slot);
+        m_live++;
+        return handleFor(slot);
+    }
+
+    // remove frees the row bound to a protocol object the compositor has finished, returning the id it had (empty if no row was bound to it)
+    QString WaylandOutputModeTable::remove(const QSharedPointer<WaylandOutputMode> &mode) {
+        auto found = m_slots_by_wrapper.constFind(mode.data());
+        if (found == m_slots_by_wrapper.constEnd()) return QString();
+        auto slot = found.value();
+        m_slots_by_wrapper.erase(found);
+
+        auto wlr_mode = mode->getWlrMode();
+        if (wlr_mode.has_value()) {
+            auto bound = m_slots_by_wlr_mode.constFind(wlr_mode.value());
+            if (bound != m_slots_by_wlr_mode.constEnd() && bound.value() == slot) m_slots_by_wlr_mode.erase(bound);
+        }
+
+        auto id = handleFor(slot).getId();
+        m_index.remove(WaylandOutputModeKey{m_widths.at(slot), m_heights.at(slot), m_refreshes.at(slot)}, slot);
+
+        if (m_current_slot == slot) m_current_slot = -1;
+        for (auto &best: m_best_slots) {
+            if (best == slot) best = -1;
+        }
+        m_flags[slot] = 0;
+        m_generations[slot]++;
+        m_wrappers[slot].clear();
+        m_free_slots.append(slot);
+        m_live--;
+        return id;
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::best(ConfigurationModePolicy policy) const {
+        auto slot = m_best_slots.at(static_cast<size_t>(policy));
+        if (slot < 0) return WaylandOutputMetaMode();
+        return handleFor(static_cast<quint32>(slot));
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::current() const {
+        if (m_current_slot < 0) return WaylandOutputMetaMode();
+        return handleFor(static_cast<quint32>(m_current_slot));
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::find(int width, int height, qulonglong refresh) const {
+        auto slot = m_index.find(WaylandOutputModeKey{width, height, refresh});
+        if (!slot.has_value()) return WaylandOutputMetaMode();
+        return handleFor(slot.value());
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::findNearest(int width, int height, qulonglong refresh, qulonglong tolerance) const {
+        auto slot = m_index.findNearest(width, height, refresh, tolerance);
+        if (!slot.has_value()) return WaylandOutputMetaMode();
+        return handleFor(slot.value());
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::findByWlrMode(const ::zwlr_output_mode_v1 *mode) const {
+        auto found = m_slots_by_wlr_mode.constFind(mode);
+        if (found == m_slots_by_wlr_mode.constEnd()) return WaylandOutputMetaMode();
+
+        // A proxy destroyed without the compositor finishing its mode first can leave its address behind for a new one, check it is still ours
+        const auto &wrapper = m_wrappers.at(found.value());
+        if (wrapper.isNull() || wrapper->getWlrMode().value_or(nullptr) != mode) return WaylandOutputMetaMode();
+        return handleFor(found.value());
+    }
+
+    QList<WaylandOutputMetaMode> WaylandOutputModeTable::modes() const {
+        auto modes = QList<WaylandOutputMetaMode>();
+        modes.reserve(m_live);
+        for (qsizetype slot = 0; slot < m_flags.size(); ++slot) {
+            if ((m_flags.at(slot) & Live) != 0) modes.append(handleFor(static_cast<quint32>(slot)));
+        }
+        return modes;
+    }
+
+    qsizetype WaylandOutputModeTable::size() const {
+        return m_live;
+    }
+
+    // rank works out the best row for every ConfigurationModePolicy in one pass over the table, so picking a mode for an output later is a
+    // lookup. It should be called whenever the set of modes changes. The native size is that of the preferred mode, or the largest we have if
+    // nothing is preferred.
+    void WaylandOutputModeTable::rank() {
+        m_best_slots.fill(-1);
+
+        auto native_width = 0;
+        auto native_height = 0;
+        auto native_preferred = false;
+        for (qsizetype slot = 0; slot < m_flags.size(); ++slot) {
+            if ((m_flags.at(slot) & Live) == 0) continue;
+            auto preferred = (m_flags.at(slot) & Preferred) != 0;
+            auto larger = qint64{m_widths.at(slot)} * m_heights.at(slot) > qint64{native_width} * native_height;
+            if ((preferred && !native_preferred) || (preferred == native_preferred && larger)) {
+                native_width = m_widths.at(slot);
+                native_height = m_heights.at(slot);
+                native_preferred = preferred;
+            }
+        }
+
+        // Each policy orders the same properties of a row differently, compared left to right the largest score wins
+        auto score = [this, native_width, native_height](ConfigurationModePolicy policy, qsizetype slot) -> std::array<qint64, 4> {
+            auto native = qint64{m_widths.at(slot) == native_width && m_heights.at(slot) == native_height};
+            auto preferred = qint64{(m_flags.at(slot) & Preferred) != 0};
+            auto refresh = static_cast<qint64>(m_refreshes.at(slot));
+            auto area = qint64{m_widths.at(slot)} * m_heights.at(slot);
+
+            switch (policy) {
+                case ConfigurationModePolicy::Preferred:
+                    return {preferred, native, refresh, area};
+                case ConfigurationModePolicy::HighestRefresh:
+                    return {refresh, native, area, preferred};
+                default:
+                    return {native, refresh, preferred, area};
+            }
+        };
+
+        for (auto policy : {ConfigurationModePolicy::Native, ConfigurationModePolicy::Preferred, ConfigurationModePolicy::HighestRefresh}) {
+            auto &best = m_best_slots[static_cast<size_t>(policy)];
+            for (qsizetype slot = 0; slot < m_flags.size(); ++slot) {
+                if ((m_flags.at(slot) & Live) == 0) continue;
+                if (best < 0 || score(policy, slot) > score(policy, best)) best = slot;
+            }
+        }
+    }
+
+    void WaylandOutputModeTable::setCurrent(const WaylandOutputMetaMode &mode) {
+        if (mode.isNull() || mode.m_table != this) {
+            m_current_slot = -1;
+            return;
+        }
+        m_current_slot = mode.m_slot;
+    }
+
+    // unsetModes lets go of every protocol object while keeping the rows, so the next connection's modes are matched back up with them
+    void WaylandOutputModeTable::unsetModes() {
+        for (auto &wrapper : m_wrappers) wrapper.clear();
+        m_slots_by_wrapper.clear();
+        m_slots_by_wlr_mode.clear();
+    }
+
+    void WaylandOutputModeTable::clear() {
+        m_widths.clear();
+        m_heights.clear();
+        m_refreshes.clear();
+        m_flags.clear();
+        m_generations.clear();
+        m_wrappers.clear();
+        m_slots_by_wrapper.clear();
+        m_slots_by_wlr_mode.clear();
+        m_free_slots.clear();
+        m_index.clear();
+        m_live = 0;
+        m_current_slot = -1;
+        m_best_slots.fill(-1);
+    }
+
+    // bind makes wrapper the protocol object behind a row. Rows for modes without one (as in tests) aren't looked up by protocol object.
+    void WaylandOutputModeTable::bind(quint32 slot, const QSharedPointer<WaylandOutputMode> &wrapper) {
+        m_wrappers[slot] = wrapper;
+        if (wrapper.isNull()) return;
+
+        m_slots_by_wrapper.insert(wrapper.data(), slot);
+        auto wlr_mode = wrapper->getWlrMode();
+        if (wlr_mode.has_value()) m_slots_by_wlr_mode.insert(wlr_mode.value(), slot);
+    }
+
+    WaylandOutputMetaMode WaylandOutputModeTable::handleFor(quint32 slot) const {
+        return WaylandOutputMetaMode(this, slot, m_generations.at(slot));
+    }
+
+    bool WaylandOutputModeTable::isLive(quint32 slot, quint32 generation) const {
+        return slot < static_cast<quint32>(m_flags.size()) && m_generations.at(slot) == generation && (m_flags.at(slot) & Live) != 0;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QSize>
+#include <array>
+
+#include "WaylandOutputMetaMode.hpp"
+#include "WaylandOutputMode.hpp"
+#include "WaylandOutputModeIndex.hpp"
+#include "displays/batch-system/enums.hpp"
+
+namespace bd {
+    struct WaylandOutputModeSnapshot;
+
+    // WaylandOutputModeTable holds every mode a meta head knows about as columns of plain values, one row per mode the compositor advertised.
+    // Rows freed when the compositor finishes a mode are reused, and each row carries a generation so handles to a freed row read as null.
+    class WaylandOutputModeTable {
+        friend class WaylandOutputMetaMode;
+
+    public:
+        enum Flag : quint8 {
+            Live = 1 << 0,
+            Preferred = 1 << 1,
+        };
+
+        WaylandOutputMetaMode add(const WaylandOutputModeSnapshot &mode);
+        QString remove(const QSharedPointer<WaylandOutputMode> &mode);
+
+        WaylandOutputMetaMode best(ConfigurationModePolicy policy) const;
+        WaylandOutputMetaMode current() const;
+        WaylandOutputMetaMode find(int width, int height, qulonglong refresh) const;
+        WaylandOutputMetaMode findNearest(int width, int height, qulonglong refresh, qulonglong tolerance) const;
+        WaylandOutputMetaMode findByWlrMode(const ::zwlr_output_mode_v1 *mode) const;
+        QList<WaylandOutputMetaMode> modes() const;
+        qsizetype size() const;
+
+        void rank();
+        void setCurrent(const WaylandOutputMetaMode &mode);
+        void unsetModes();
+        void clear();
+
+    private:
+        WaylandOutputMetaMode handleFor(quint32 slot) const;
+        bool isLive(quint32 slot, quint32 generation) const;
+        void bind(quint32 slot, const QSharedPointer<WaylandOutputMode> &wrapper);
+
+        QList<int> m_widths;
+        QList<int> m_heights;
+        QList<qulonglong> m_refreshes;
+        QList<quint8> m_flags;
+        QList<quint32> m_generations;
+        QList<QSharedPointer<WaylandOutputMode>> m_wrappers;
+
+        // Which row each protocol object is bound to, so a finished mode or a current_mode event doesn't have to look through every row
+        QHash<const WaylandOutputMode *, quint32> m_slots_by_wrapper;
+        QHash<const ::zwlr_output_mode_v1 *, quint32> m_slots_by_wlr_mode;
+
+        QList<quint32> m_free_slots;
+        qsizetype m_live = 0;
+        qint64 m_current_slot = -1;
+        std::array<qint64, 3> m_best_slots = {-1, -1, -1};
+        WaylandOutputModeIndex m_index;
+    };
+}
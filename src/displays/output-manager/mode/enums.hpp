@@ -1,9 +0,0 @@
-#pragma once
-
-namespace bd {
-  enum WaylandOutputMetaModeProperty {
-  Preferred,
-    Refresh,
-    Size,
-  };
-}
\ No newline at end of file
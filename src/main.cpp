@@ -34,9 +34,11 @@ int main(int argc, char* argv[]) {
 
   app.connect(&orchestrator, &bd::WaylandOrchestrator::ready, &bd::DisplayObjectManager::instance(), &bd::DisplayObjectManager::onOutputManagerReady);
 
-  orchestrator.init();
+  // Outputs connected or disconnected later on: re-match the display groups and export any new outputs
+  app.connect(&orchestrator, &bd::WaylandOrchestrator::outputsChanged, &bd::DisplayConfig::instance(), &bd::DisplayConfig::apply);
+  app.connect(&orchestrator, &bd::WaylandOrchestrator::outputsChanged, &bd::DisplayObjectManager::instance(), &bd::DisplayObjectManager::onOutputsChanged);
 
-  wl_display_roundtrip(bd::WaylandOrchestrator::instance().getDisplay());
+  orchestrator.init();
 
   return app.exec();
 }
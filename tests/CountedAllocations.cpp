@@ -0,0 +1,119 @@
+#include "CountedAllocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+  std::atomic<bool>   counting {false};
+  std::atomic<size_t> allocations {0};
+  std::atomic<qint64> live_bytes {0};
+
+  void* countedAllocation(void* pointer) {
+    if (pointer != nullptr && counting.load(std::memory_order_relaxed)) allocations.fetch_add(1, std::memory_order_relaxed);
+    return pointer;
+  }
+
+#ifdef __GLIBC__
+  void trackBytes(void* pointer, qint64 sign) {
+    if (pointer == nullptr || !counting.load(std::memory_order_relaxed)) return;
+    live_bytes.fetch_add(sign * static_cast<qint64>(malloc_usable_size(pointer)), std::memory_order_relaxed);
+  }
+#endif
+}
+
+void* operator new(size_t size) {
+#ifdef __GLIBC__
+  auto pointer = std::malloc(size == 0 ? 1 : size); // Counted by malloc below
+#else
+  auto pointer = countedAllocation(std::malloc(size == 0 ? 1 : size));
+#endif
+  if (pointer == nullptr) throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+#ifdef __GLIBC__
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t count, size_t size);
+  void* __libc_realloc(void* pointer, size_t size);
+  void  __libc_free(void* pointer);
+
+  void* malloc(size_t size) {
+    auto pointer = countedAllocation(__libc_malloc(size));
+    trackBytes(pointer, 1);
+    return pointer;
+  }
+
+  void* calloc(size_t count, size_t size) {
+    auto pointer = countedAllocation(__libc_calloc(count, size));
+    trackBytes(pointer, 1);
+    return pointer;
+  }
+
+  void* realloc(void* pointer, size_t size) {
+    trackBytes(pointer, -1);
+    auto reallocated = countedAllocation(__libc_realloc(pointer, size));
+    // A failed realloc leaves the old block where it was
+    trackBytes(reallocated != nullptr || size == 0 ? reallocated : pointer, 1);
+    return reallocated;
+  }
+
+  void free(void* pointer) {
+    trackBytes(pointer, -1);
+    __libc_free(pointer);
+  }
+}
+#endif
+
+namespace bd::testing {
+  CountedAllocations::CountedAllocations() {
+    allocations = 0;
+    live_bytes  = 0;
+    counting    = true;
+  }
+
+  CountedAllocations::~CountedAllocations() {
+    counting = false;
+  }
+
+  bool CountedAllocations::isTrackingBytes() {
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  size_t CountedAllocations::count() const {
+    return allocations.load();
+  }
+
+  qint64 CountedAllocations::liveBytes() const {
+    return live_bytes.load();
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstddef>
+
+namespace bd::testing {
+  // CountedAllocations counts every allocation made while it is alive, and how much the heap grew meanwhile. It only works in binaries built
+  // with CountedAllocations.cpp, which replaces the global allocation functions, so those get a binary to themselves.
+  //
+  // Qt containers allocate through malloc and realloc rather than operator new, so on glibc those are counted instead. Elsewhere only operator
+  // new is counted, and heap growth isn't tracked at all.
+  class CountedAllocations {
+    public:
+      CountedAllocations();
+      ~CountedAllocations();
+
+      // isTrackingBytes is whether liveBytes means anything on this platform
+      static bool isTrackingBytes();
+
+      size_t count() const;
+      // liveBytes is what was allocated minus what was freed since we were created, in the sizes the allocator actually handed out
+      qint64 liveBytes() const;
+  };
+}
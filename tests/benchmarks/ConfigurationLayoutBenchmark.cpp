@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <QStringList>
+#include <array>
+
+#include "displays/batch-system/ConfigurationLayout.hpp"
+#include "mock/MockHeads.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto ChainedOutputs = 16;
+
+    // ChainedLayout is ChainedOutputs outputs, each anchored to the right of the one before it
+    struct ChainedLayout {
+        QStringList                                  serials;
+        QList<QSharedPointer<WaylandOutputMetaHead>> heads;
+        ConfigurationActionStore                     actions;
+
+        ChainedLayout() {
+          for (auto index = 0; index < ChainedOutputs; ++index) {
+            auto serial = QString("benchmark-chain-%1").arg(index);
+            serials.append(serial);
+            heads.append(makeMetaHead(serial));
+            actions.insert(ConfigurationAction::mode(serial, QSize {1920, 1080}, 60000));
+            if (index == 0) continue;
+            actions.insert(ConfigurationAction::setPositionAnchor(serial, serials.at(index - 1), ConfigurationHorizontalAnchor::Right,
+                                                                  ConfigurationVerticalAnchor::NoVerticalAnchor));
+          }
+        }
+    };
+  }
+
+  // A calculation from scratch, what every calculation cost before the layout was kept between them
+  static void BM_FullUpdate(benchmark::State& state) {
+    auto chained = ChainedLayout {};
+    for (auto _ : state) {
+      auto layout = ConfigurationLayout {};
+      benchmark::DoNotOptimize(layout.update(chained.heads, chained.actions));
+    }
+  }
+  BENCHMARK(BM_FullUpdate);
+
+  // Changing the scale of one output, which repositions it and everything to its right. The argument is the output's place in the chain.
+  static void BM_IncrementalUpdate(benchmark::State& state) {
+    auto chained = ChainedLayout {};
+    auto layout  = ConfigurationLayout {};
+    layout.update(chained.heads, chained.actions);
+
+    const auto& serial = chained.serials.at(state.range(0));
+    auto        scales = std::array {ConfigurationAction::scale(serial, 1.0), ConfigurationAction::scale(serial, 2.0)};
+    auto        next   = size_t {0};
+    for (auto _ : state) {
+      const auto& action = scales.at(next++ % scales.size());
+      chained.actions.insert(action);
+      layout.markDirty(action->getOutputId());
+      benchmark::DoNotOptimize(layout.update(chained.heads, chained.actions));
+    }
+  }
+  BENCHMARK(BM_IncrementalUpdate)->Arg(0)->Arg(ChainedOutputs / 2)->Arg(ChainedOutputs - 1);
+
+  // Nothing changed, the update only has to check every head's generation
+  static void BM_UnchangedUpdate(benchmark::State& state) {
+    auto chained = ChainedLayout {};
+    auto layout  = ConfigurationLayout {};
+    layout.update(chained.heads, chained.actions);
+
+    for (auto _ : state) benchmark::DoNotOptimize(layout.update(chained.heads, chained.actions));
+  }
+  BENCHMARK(BM_UnchangedUpdate);
+}
@@ -0,0 +1,31 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <iostream>
+
+#include "mock/MockOutputManagementServer.hpp"
+
+using namespace bd::testing;
+
+// MockCompositor serves the mock output management compositor on a named socket, so the daemon itself can be started against it rather than
+// the desktop it is run from. Usage: MockCompositor <socket name> [heads]. It prints "ready" once the socket is up and runs until killed.
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  auto arguments = app.arguments();
+  if (arguments.size() < 2) {
+    std::cerr << "Usage: MockCompositor <socket name> [heads]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto heads  = arguments.size() > 2 ? arguments.at(2).toInt() : 2;
+  auto server = MockOutputManagementServer {};
+  for (auto index = 0; index < heads; ++index) server.addHead(makeMockHead(QString("mock-compositor-%1").arg(index), QPoint {index * 1920, 0}));
+
+  if (!server.addSocket(arguments.at(1))) {
+    std::cerr << "Failed to listen on " << arguments.at(1).toStdString() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "ready" << std::endl;
+  return app.exec();
+}
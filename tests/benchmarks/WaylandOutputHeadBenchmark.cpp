@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+
+#include <QObject>
+#include <QVariant>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  // BoxedHead and BoxedMetaHead rebuild the path head state used to take before it was committed through typed setters: every event was
+  // boxed into a QVariant, emitted as propertyChanged and unboxed again by a switch on the other side. They only exist as a baseline.
+  class BoxedHead : public QObject {
+      Q_OBJECT
+
+    signals:
+      void propertyChanged(int property, const QVariant& value);
+      void modePropertyChanged(int mode, int property, const QVariant& value);
+  };
+
+  class BoxedMetaHead : public QObject {
+      Q_OBJECT
+
+    public:
+      struct Mode {
+          QSize      size;
+          qulonglong refresh   = 0;
+          bool       preferred = false;
+      };
+
+      enum ModeProperty { Size, Refresh, Preferred };
+
+      QString     name, description, make, model, serial;
+      bool        enabled = false;
+      QPoint      position;
+      int         transform = 0;
+      double      scale     = 1.0;
+      uint32_t    adaptive_sync = 0;
+      int         current_mode  = -1;
+      QList<Mode> modes;
+
+    public slots:
+      void applyProperty(int property, const QVariant& value) {
+        switch (property) {
+          case WaylandOutputMetaHeadProperty::Name: name = value.toString(); break;
+          case WaylandOutputMetaHeadProperty::Description: description = value.toString(); break;
+          case WaylandOutputMetaHeadProperty::Make: make = value.toString(); break;
+          case WaylandOutputMetaHeadProperty::Model: model = value.toString(); break;
+          case WaylandOutputMetaHeadProperty::SerialNumber: serial = value.toString(); break;
+          case WaylandOutputMetaHeadProperty::Enabled: enabled = value.toBool(); break;
+          case WaylandOutputMetaHeadProperty::Position: position = value.toPoint(); break;
+          case WaylandOutputMetaHeadProperty::Transform: transform = value.toInt(); break;
+          case WaylandOutputMetaHeadProperty::Scale: scale = value.toDouble(); break;
+          case WaylandOutputMetaHeadProperty::AdaptiveSync: adaptive_sync = value.toUInt(); break;
+          case WaylandOutputMetaHeadProperty::CurrentMode: current_mode = value.toInt(); break;
+          default: break;
+        }
+      }
+
+      void applyModeProperty(int mode, int property, const QVariant& value) {
+        if (mode >= modes.size()) modes.resize(mode + 1);
+        switch (property) {
+          case Size: modes[mode].size = value.toSize(); break;
+          case Refresh: modes[mode].refresh = value.toULongLong(); break;
+          case Preferred: modes[mode].preferred = value.toBool(); break;
+        }
+      }
+  };
+
+  namespace {
+    constexpr auto AdvertisedModes = 200;
+    // name, description, make, model, serial number, enabled, position, transform, scale, adaptive sync and current mode
+    constexpr auto HeadEvents = 11;
+    // Each mode is announced on the head, then gets its size and refresh (one of them is also preferred)
+    constexpr auto EventsPerMode = 3;
+    constexpr auto Events        = HeadEvents + AdvertisedModes * EventsPerMode;
+
+    QSize modeSize(int index) {
+      return QSize {640 + index * 16, 480 + index * 9};
+    }
+
+    WaylandOutputHeadSnapshot makeSnapshot() {
+      auto snapshot          = WaylandOutputHeadSnapshot {};
+      snapshot.name          = "DP-benchmark";
+      snapshot.description   = "Budgie Mock benchmark";
+      snapshot.make          = "Budgie";
+      snapshot.model         = "Mock";
+      snapshot.serial        = "benchmark-typed";
+      snapshot.enabled       = true;
+      snapshot.position      = QPoint {1920, 0};
+      snapshot.transform     = 1;
+      snapshot.scale         = 1.5;
+      snapshot.adaptive_sync = 1;
+      for (auto property : {WaylandOutputMetaHeadProperty::Name, WaylandOutputMetaHeadProperty::Description, WaylandOutputMetaHeadProperty::Make,
+                            WaylandOutputMetaHeadProperty::Model, WaylandOutputMetaHeadProperty::SerialNumber, WaylandOutputMetaHeadProperty::Enabled,
+                            WaylandOutputMetaHeadProperty::Position, WaylandOutputMetaHeadProperty::Transform, WaylandOutputMetaHeadProperty::Scale,
+                            WaylandOutputMetaHeadProperty::AdaptiveSync, WaylandOutputMetaHeadProperty::Modes}) {
+        snapshot.markChanged(property);
+      }
+
+      // Without a compositor the modes have no protocol object behind them, which the mode table tolerates
+      for (auto index = 0; index < AdvertisedModes; ++index) {
+        snapshot.added_modes.append(WaylandOutputModeSnapshot {.size = modeSize(index), .refresh = 60000, .preferred = index == 0});
+      }
+      return snapshot;
+    }
+
+    MockHead makeAdvertisingHead() {
+      auto head = makeMockHead("benchmark-mock");
+      head.modes.clear();
+      for (auto index = 0; index < AdvertisedModes; ++index) head.modes.append(MockMode {modeSize(index).width(), modeSize(index).height(), 60000, index == 0});
+      head.current_mode = 0;
+      return head;
+    }
+  }
+
+  // Baseline: the QVariant-boxed propertyChanged hop for the same events, over a direct connection
+  static void BM_BoxedPropertyChanges(benchmark::State& state) {
+    for (auto _ : state) {
+      auto head      = BoxedHead {};
+      auto meta_head = BoxedMetaHead {};
+      QObject::connect(&head, &BoxedHead::propertyChanged, &meta_head, &BoxedMetaHead::applyProperty);
+      QObject::connect(&head, &BoxedHead::modePropertyChanged, &meta_head, &BoxedMetaHead::applyModeProperty);
+
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Name, QVariant(QString("DP-benchmark")));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Description, QVariant(QString("Budgie Mock benchmark")));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Make, QVariant(QString("Budgie")));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Model, QVariant(QString("Mock")));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::SerialNumber, QVariant(QString("benchmark-boxed")));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Enabled, QVariant(true));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Position, QVariant(QPoint {1920, 0}));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Transform, QVariant(1));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::Scale, QVariant(1.5));
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::AdaptiveSync, QVariant(1u));
+      for (auto index = 0; index < AdvertisedModes; ++index) {
+        emit head.modePropertyChanged(index, BoxedMetaHead::Size, QVariant(modeSize(index)));
+        emit head.modePropertyChanged(index, BoxedMetaHead::Refresh, QVariant(qulonglong {60000}));
+        emit head.modePropertyChanged(index, BoxedMetaHead::Preferred, QVariant(index == 0));
+      }
+      emit head.propertyChanged(WaylandOutputMetaHeadProperty::CurrentMode, QVariant(0));
+      benchmark::DoNotOptimize(meta_head.modes.size());
+    }
+    state.SetItemsProcessed(state.iterations() * Events);
+  }
+  BENCHMARK(BM_BoxedPropertyChanges);
+
+  // The same head recorded into a typed snapshot and committed to a meta head through its setters
+  static void BM_TypedSnapshotCommit(benchmark::State& state) {
+    for (auto _ : state) {
+      auto meta_head = WaylandOutputMetaHead(nullptr, nullptr);
+      meta_head.commit(makeSnapshot());
+      benchmark::DoNotOptimize(meta_head.getModes().size());
+    }
+    state.SetItemsProcessed(state.iterations() * Events);
+  }
+  BENCHMARK(BM_TypedSnapshotCommit);
+
+  // End to end against the mock compositor: the head and its modes are announced over the wire, recorded by the head and mode wrappers and
+  // committed on done. Unplugging the head again between iterations isn't timed.
+  static void BM_AnnounceHeadOverTheWire(benchmark::State& state) {
+    auto server     = MockOutputManagementServer {};
+    auto connection = MockOutputManagerConnection(server);
+    auto head       = makeAdvertisingHead();
+
+    for (auto _ : state) {
+      auto id = server.addHead(head);
+      if (!connection.sync()) state.SkipWithError("the manager never caught up with the mock compositor");
+
+      state.PauseTiming();
+      server.removeHead(id);
+      connection.sync();
+      state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * Events);
+  }
+  BENCHMARK(BM_AnnounceHeadOverTheWire)->Unit(benchmark::kMicrosecond);
+}
+
+#include "WaylandOutputHeadBenchmark.moc"
@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include <QStringList>
+#include <array>
+#include <memory>
+
+#include "displays/batch-system/ConfigurationBatchSystem.hpp"
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Outputs = 32;
+
+    using HeadLookup = QSharedPointer<WaylandOutputMetaHead> (*)(WaylandOutputManager& manager, OutputId id);
+
+    QSharedPointer<WaylandOutputMetaHead> indexedLookup(WaylandOutputManager& manager, OutputId id) {
+      return manager.getOutputHead(id);
+    }
+
+    // linearLookup is what getOutputHead did before heads were indexed: walk every head comparing identifiers
+    QSharedPointer<WaylandOutputMetaHead> linearLookup(WaylandOutputManager& manager, OutputId id) {
+      const auto identifier = OutputIdTable::instance().identifier(id);
+      for (auto head : manager.getHeads()) {
+        if (head->getIdentifier() == identifier) return head;
+      }
+      return nullptr;
+    }
+
+    // ConnectedOutputs is Outputs mock outputs side by side, with a mode action for each and every one but the first anchored to the right
+    // of the one before it
+    struct ConnectedOutputs {
+        MockOutputManagementServer                   server;
+        std::unique_ptr<MockOutputManagerConnection> connection;
+        QStringList                                  serials;
+        ConfigurationBatchSystem                     batch {nullptr};
+
+        ConnectedOutputs() {
+          for (auto index = 0; index < Outputs; ++index) {
+            auto serial = QString("benchmark-lookup-%1").arg(index);
+            serials.append(serial);
+            server.addHead(makeMockHead(serial, QPoint {index * 1920, 0}));
+          }
+          connection = std::make_unique<MockOutputManagerConnection>(server);
+
+          for (auto index = 0; index < Outputs; ++index) {
+            batch.addAction(ConfigurationAction::mode(serials.at(index), QSize {1920, 1080}, 60000));
+            if (index == 0) continue;
+            batch.addAction(ConfigurationAction::setPositionAnchor(serials.at(index), serials.at(index - 1), ConfigurationHorizontalAnchor::Right,
+                                                                   ConfigurationVerticalAnchor::NoVerticalAnchor));
+          }
+        }
+    };
+
+    // applyResult does what ConfigurationBatchSystem::apply does with the batch's result, finding each output's head with lookup. apply itself
+    // goes through the orchestrator's manager, so it can't be pointed at the mock. Returns whether the compositor took the configuration.
+    bool applyResult(ConnectedOutputs& outputs, HeadLookup lookup) {
+      auto manager = outputs.connection->manager();
+      auto config  = manager->configure();
+      auto result  = outputs.batch.getCalculationResult();
+
+      for (const auto& head : manager->getHeads()) {
+        if (result->getOutputState(head->getOutputId()) == nullptr) return false;
+      }
+
+      for (const auto& state : result->getOutputStates()) {
+        auto head = lookup(*manager, state.getOutputId());
+        if (head.isNull()) continue;
+
+        if (!state.isOn()) {
+          config->disable(head.data());
+          continue;
+        }
+
+        auto config_head = config->enable(head.data());
+        config_head->setPosition(state.getPosition().x(), state.getPosition().y());
+        config_head->setScale(state.getScale());
+        config_head->setTransform(state.getTransform());
+        config_head->setAdaptiveSync(state.getAdaptiveSync());
+
+        auto dimensions = state.getDimensions();
+        auto mode       = head->getModeForOutputHead(dimensions.width(), dimensions.height(), state.getRefresh());
+        if (!mode.isNull()) {
+          config_head->setMode(mode);
+        } else {
+          config_head->setCustomMode(dimensions.width(), dimensions.height(), state.getRefresh());
+        }
+      }
+
+      auto answered  = false;
+      auto succeeded = false;
+      QObject::connect(config.data(), &WaylandOutputConfiguration::succeeded, [&answered, &succeeded]() { answered = succeeded = true; });
+      QObject::connect(config.data(), &WaylandOutputConfiguration::failed, [&answered]() { answered = true; });
+      QObject::connect(config.data(), &WaylandOutputConfiguration::cancelled, [&answered]() { answered = true; });
+      config->applySelf();
+      wl_display_flush(outputs.connection->display());
+
+      outputs.connection->waitFor([&answered]() { return answered; });
+      config->release();
+      return succeeded;
+    }
+  }
+
+  // Looking up every connected output once, as apply and getMatchingGroup do
+  static void BM_LookupEveryOutput(benchmark::State& state, HeadLookup lookup) {
+    auto outputs = ConnectedOutputs {};
+    auto manager = outputs.connection->manager();
+    auto ids     = QList<OutputId> {};
+    for (const auto& serial : outputs.serials) ids.append(OutputIdTable::instance().find(serial));
+
+    for (auto _ : state) {
+      for (auto id : ids) benchmark::DoNotOptimize(lookup(*manager, id));
+    }
+    state.SetItemsProcessed(state.iterations() * Outputs);
+  }
+  BENCHMARK_CAPTURE(BM_LookupEveryOutput, Indexed, &indexedLookup);
+  BENCHMARK_CAPTURE(BM_LookupEveryOutput, Linear, &linearLookup);
+
+  // Changing the scale of the last output, calculating and applying the result until the compositor answers. The round trip to the mock is
+  // part of every iteration, as it is of every apply.
+  static void BM_CalculateAndApply(benchmark::State& state, HeadLookup lookup) {
+    auto outputs = ConnectedOutputs {};
+    auto manager = outputs.connection->manager();
+
+    const auto& serial = outputs.serials.last();
+    auto        scales = std::array {ConfigurationAction::scale(serial, 1.0), ConfigurationAction::scale(serial, 2.0)};
+    auto        next   = size_t {0};
+    for (auto _ : state) {
+      outputs.batch.addAction(scales.at(next++ % scales.size()));
+      outputs.batch.calculate(manager->getHeads());
+      if (!applyResult(outputs, lookup)) state.SkipWithError("the mock compositor didn't take the configuration");
+    }
+  }
+  BENCHMARK_CAPTURE(BM_CalculateAndApply, Indexed, &indexedLookup)->Unit(benchmark::kMicrosecond);
+  BENCHMARK_CAPTURE(BM_CalculateAndApply, Linear, &linearLookup)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <memory>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "displays/output-manager/WaylandProtocolReplay.hpp"
+#include "mock/MockRecording.hpp"
+
+namespace bd::testing {
+  namespace {
+    // A video wall node: 8 outputs advertising 150 modes each, all plugged in and unplugged again a few times
+    constexpr auto Outputs        = 8;
+    constexpr auto ModesPerOutput = 150;
+    constexpr auto HotplugCycles  = 5;
+
+    MockHead makeWallHead(int index) {
+      auto head = makeMockHead(QString("replay-wall-%1").arg(index), QPoint {index * 1920, 0});
+      head.modes.clear();
+      for (auto mode = 0; mode < ModesPerOutput; ++mode) {
+        head.modes.append(MockMode {640 + (mode / 3) * 32, 480 + (mode / 3) * 18, (mode % 3 + 1) * 60000, mode == 0});
+      }
+      head.current_mode = 0;
+      return head;
+    }
+
+    // RecordedBurst is the hotplug burst, recorded once for every benchmark in this binary
+    struct RecordedBurst {
+        QTemporaryDir directory;
+        QString       path;
+        qsizetype     events   = 0;
+        bool          recorded = false;
+
+        RecordedBurst() : path(directory.filePath("burst.bdwr")) {
+          auto server = MockOutputManagementServer {};
+          auto script = [](MockOutputManagementServer& compositor, MockOutputManagerConnection& connection) {
+            for (auto cycle = 0; cycle < HotplugCycles; ++cycle) {
+              auto ids = QList<quint32> {};
+              for (auto index = 0; index < Outputs; ++index) ids.append(compositor.addHead(makeWallHead(index)));
+              if (!connection.sync()) return false;
+              for (auto id : ids) compositor.removeHead(id);
+              if (!connection.sync()) return false;
+            }
+            return true;
+          };
+          recorded = directory.isValid() && recordAgainstMock(path, server, script);
+
+          auto file = QFile(path);
+          if (!recorded || !file.open(QIODevice::ReadOnly)) return;
+          auto stream = QDataStream(&file);
+          if (!WaylandProtocolRecorder::readHeader(stream)) return;
+          auto record = WaylandProtocolRecord {};
+          while (!stream.atEnd() && WaylandProtocolRecorder::readRecord(stream, record)) events++;
+        }
+    };
+
+    const RecordedBurst& burst() {
+      static auto recorded = RecordedBurst {};
+      return recorded;
+    }
+  }
+
+  // Replays the recorded burst into a fresh manager: every head and mode event is fed to the wrappers and every done is committed to meta heads,
+  // without the compositor or the socket in the way. Opening the log and tearing the manager down aren't timed.
+  static void BM_ReplayHotplugBurst(benchmark::State& state) {
+    const auto& recorded = burst();
+    if (!recorded.recorded) {
+      state.SkipWithError("couldn't record the hotplug burst against the mock compositor");
+      return;
+    }
+
+    for (auto _ : state) {
+      state.PauseTiming();
+      auto replay = std::make_unique<WaylandProtocolReplay>();
+      if (!replay->open(recorded.path).isNull()) {
+        state.SkipWithError("couldn't open the recorded burst");
+        break;
+      }
+      auto manager = std::unique_ptr<WaylandOutputManager>(replay->createManager());
+      state.ResumeTiming();
+
+      replay->run();
+
+      state.PauseTiming();
+      benchmark::DoNotOptimize(manager->getSerial());
+      manager.reset();
+      replay.reset();
+      state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * recorded.events);
+  }
+  BENCHMARK(BM_ReplayHotplugBurst)->Unit(benchmark::kMillisecond);
+}
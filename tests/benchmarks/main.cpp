@@ -0,0 +1,17 @@
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+
+// Like the tests, every benchmark binary gets a QCoreApplication and runs with debug logging filtered out
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  QCoreApplication app(argc, argv);
+  QLoggingCategory::setFilterRules("*.debug=false");
+
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+  return 0;
+}
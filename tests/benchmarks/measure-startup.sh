@@ -0,0 +1,127 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: Budgie Desktop Developers
+#
+# SPDX-License-Identifier: MPL-2.0
+
+# measure-startup.sh compares how long the daemon takes to become ready, and how much memory it holds once it is, when built with our own
+# wl_registry binding and with KWayland's (-DWITH_KWAYLAND=ON). Both builds are started against MockCompositor in a private D-Bus session and
+# config directory, so the desktop this is run from is left alone.
+#
+# Ready is the "Wayland connect to ready took" line the daemon logs, timed from just before the daemon is spawned so dynamic linking and
+# library initialisation are included. RSS is VmRSS at that point.
+#
+# Environment: RUNS (default 20) runs per build, HEADS (default 2) outputs on the mock compositor, WORK_DIR (default a new temporary
+# directory) where both builds and the scratch config go.
+
+set -euo pipefail
+
+# Everything runs on one private session bus, so the daemon can claim its name without touching the real one
+if [[ -z "${BUDGIE_MEASURE_STARTUP_SESSION:-}" ]]; then
+  exec env BUDGIE_MEASURE_STARTUP_SESSION=1 dbus-run-session -- "$0" "$@"
+fi
+
+source_dir=$(cd "$(dirname "$0")/../.." && pwd)
+work_dir=${WORK_DIR:-$(mktemp -d)}
+runs=${RUNS:-20}
+heads=${HEADS:-2}
+socket="budgie-measure-startup-$$"
+daemon="org.buddiesofbudgie.BudgieDaemonV2"
+
+compositor=""
+cleanup() {
+  if [[ -n "$compositor" ]]; then kill "$compositor" 2>/dev/null || true; fi
+}
+trap cleanup EXIT
+
+# build <name> <WITH_KWAYLAND>
+build() {
+  echo "Building $1 (WITH_KWAYLAND=$2) in $work_dir/$1" >&2
+  cmake -S "$source_dir" -B "$work_dir/$1" -G Ninja -DCMAKE_BUILD_TYPE=Release -DBUILD_TESTING=ON -DBUILD_BENCHMARKS=ON \
+    -DWITH_KWAYLAND="$2" >/dev/null
+  cmake --build "$work_dir/$1" --target "$daemon" MockCompositor >/dev/null
+}
+
+# start_compositor <build dir> starts MockCompositor from that build and waits for its socket
+start_compositor() {
+  coproc compositor_output { "$1/bin/MockCompositor" "$socket" "$heads"; }
+  compositor=$compositor_output_PID
+  local line
+  read -r -u "${compositor_output[0]}" line
+  if [[ "$line" != "ready" ]]; then
+    echo "MockCompositor didn't start" >&2
+    exit 1
+  fi
+}
+
+stop_compositor() {
+  kill "$compositor" 2>/dev/null || true
+  wait "$compositor" 2>/dev/null || true
+  compositor=""
+}
+
+# run_once <build dir> prints "<ms to ready> <VmRSS in kB>" for one start of the daemon
+run_once() {
+  local log="$work_dir/daemon.log"
+  rm -f "$log"
+  mkfifo "$log"
+  rm -rf "$work_dir/config"
+  mkdir -p "$work_dir/config"
+
+  local start
+  start=$(date +%s%N)
+  WAYLAND_DISPLAY="$socket" XDG_CONFIG_HOME="$work_dir/config" QT_LOGGING_RULES="*.debug=false" \
+    "$1/bin/$daemon" >/dev/null 2>"$log" &
+  local pid=$!
+
+  # Kept open until the daemon is gone, so it never writes to a closed pipe
+  exec {log_fd}<"$log"
+  local line ready=""
+  while IFS= read -r -u "$log_fd" line; do
+    if [[ "$line" == *"Wayland connect to ready took"* ]]; then
+      ready=$(date +%s%N)
+      break
+    fi
+  done
+
+  if [[ -z "$ready" ]]; then
+    echo "The daemon exited before it was ready" >&2
+    exit 1
+  fi
+
+  local rss
+  rss=$(awk '/^VmRSS:/ { print $2 }' "/proc/$pid/status")
+  kill "$pid"
+  cat <&"$log_fd" >/dev/null || true
+  wait "$pid" 2>/dev/null || true
+  exec {log_fd}<&-
+  rm -f "$log"
+
+  echo "$(((ready - start) / 1000000)) $rss"
+}
+
+# median reads one number per line
+median() {
+  sort -n | awk '{ values[NR] = $1 } END { print (NR % 2) ? values[(NR + 1) / 2] : (values[NR / 2] + values[NR / 2 + 1]) / 2 }'
+}
+
+# measure <name> <WITH_KWAYLAND>
+measure() {
+  build "$1" "$2"
+  start_compositor "$work_dir/$1"
+  run_once "$work_dir/$1" >/dev/null  # Warm the page cache
+
+  local results=()
+  for ((run = 0; run < runs; run++)); do results+=("$(run_once "$work_dir/$1")"); done
+  stop_compositor
+
+  local ms rss
+  ms=$(printf '%s\n' "${results[@]}" | cut -d' ' -f1 | median)
+  rss=$(printf '%s\n' "${results[@]}" | cut -d' ' -f2 | median)
+  printf '| %-8s | %10s | %10s |\n' "$1" "$ms" "$rss"
+}
+
+# The results are printed as a Markdown table, ready to go into the README
+printf '| %-8s | %10s | %10s |\n' "registry" "ready (ms)" "VmRSS (kB)"
+printf '|----------|-----------:|-----------:|\n'
+measure native OFF
+measure kwayland ON
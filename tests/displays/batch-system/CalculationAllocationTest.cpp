@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <QStringList>
+
+#include "CountedAllocations.hpp"
+#include "displays/batch-system/CalculationResult.hpp"
+#include "displays/batch-system/ConfigurationBatchSystem.hpp"
+#include "displays/batch-system/ConfigurationLayout.hpp"
+#include "mock/MockHeads.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Outputs = 8;
+
+    class CalculationAllocationTest : public ::testing::Test {
+      protected:
+        void SetUp() override {
+          for (auto index = 0; index < Outputs; ++index) {
+            auto serial = QString("allocation-%1").arg(index);
+            m_serials.append(serial);
+            m_heads.append(makeMetaHead(serial));
+            add(ConfigurationAction::mode(serial, QSize {1920, 1080}, 60000));
+            if (index == 0) continue;
+            add(ConfigurationAction::setPositionAnchor(serial, m_serials.at(index - 1), ConfigurationHorizontalAnchor::Right,
+                                                       ConfigurationVerticalAnchor::NoVerticalAnchor));
+          }
+          m_layout.update(m_heads, m_actions);
+          m_batch.calculate(m_heads);
+        }
+
+        // add gives the action to both the layout we drive ourselves and the batch system
+        void add(const QSharedPointer<ConfigurationAction>& action) {
+          m_actions.insert(action);
+          m_batch.addAction(action);
+        }
+
+        // readResult goes through everything a caller of the result can read
+        QRect readResult(const CalculationResult& result) {
+          auto space = result.getGlobalSpace();
+          for (const auto& state : result.getOutputStates()) {
+            auto placed = result.getOutputState(state.getOutputId());
+            if (placed != nullptr) space = space.united(QRect(placed->getPosition(), placed->getResultingDimensions()));
+          }
+          return space;
+        }
+
+        QStringList                                  m_serials;
+        QList<QSharedPointer<WaylandOutputMetaHead>> m_heads;
+        ConfigurationActionStore                     m_actions;
+        ConfigurationLayout                          m_layout;
+        ConfigurationBatchSystem                     m_batch {nullptr};
+    };
+  }
+
+  // The counters themselves have to work, or the tests below prove nothing
+  TEST_F(CalculationAllocationTest, CountsAllocations) {
+    auto counted = CountedAllocations {};
+    auto list    = QList<int> {};
+    list.append(1);
+    auto object = std::make_unique<int>(1);
+    EXPECT_GE(counted.count(), 2u);
+  }
+
+  TEST_F(CalculationAllocationTest, ChangedOutputDoesNotAllocate) {
+    auto result = CalculationResult(&m_layout);
+
+    // Changing the action and committing the head log and allocate, updating and reading the layout afterwards mustn't
+    m_actions.insert(ConfigurationAction::scale(m_serials.at(3), 1.5));
+    m_layout.markDirty(m_heads.at(3)->getOutputId());
+    moveMetaHead(*m_heads.at(5), QPoint {100, 100});
+
+    auto counted    = CountedAllocations {};
+    auto recomputed = m_layout.update(m_heads, m_actions);
+    auto space      = readResult(result);
+    EXPECT_EQ(counted.count(), 0u);
+
+    EXPECT_FALSE(result.hasErrors());
+    EXPECT_EQ(recomputed, 2);
+    EXPECT_EQ(space, QRect(0, 0, 7 * 1920 + 2880, 1620));
+  }
+
+  TEST_F(CalculationAllocationTest, UnchangedLayoutDoesNotAllocate) {
+    auto result = CalculationResult(&m_layout);
+
+    auto counted    = CountedAllocations {};
+    auto recomputed = m_layout.update(m_heads, m_actions);
+    readResult(result);
+    EXPECT_EQ(counted.count(), 0u);
+    EXPECT_EQ(recomputed, 0);
+  }
+
+  // What the daemon actually calls: the batch system checks whether its last result still holds, and if not recalculates and remembers what
+  // it calculated from. Neither may allocate once what it remembers has grown to fit.
+  TEST_F(CalculationAllocationTest, BatchSystemCalculationDoesNotAllocate) {
+    m_batch.addAction(ConfigurationAction::scale(m_serials.at(3), 1.25));
+    ASSERT_TRUE(m_batch.calculate(m_heads));
+
+    m_batch.addAction(ConfigurationAction::scale(m_serials.at(3), 1.5));
+    moveMetaHead(*m_heads.at(5), QPoint {100, 100});
+
+    auto counted    = CountedAllocations {};
+    auto calculated = m_batch.calculate(m_heads);
+    auto reused     = !m_batch.calculate(m_heads);
+    auto space      = readResult(*m_batch.getCalculationResult());
+    EXPECT_EQ(counted.count(), 0u);
+
+    EXPECT_TRUE(calculated);
+    EXPECT_TRUE(reused);
+    EXPECT_FALSE(m_batch.getCalculationResult()->hasErrors());
+    EXPECT_EQ(space, QRect(0, 0, 7 * 1920 + 2880, 1620));
+  }
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include "displays/batch-system/ConfigurationActionStore.hpp"
+#include "mock/MockHeads.hpp"
+
+namespace bd::testing {
+  namespace {
+    // describe is an action's output and type, enough to tell actions apart and check their order
+    QString describe(const ConfigurationAction& action) {
+      return QString("%1/%2").arg(static_cast<quint32>(action.getOutputId())).arg(static_cast<int>(action.getActionType()));
+    }
+
+    QStringList describe(const QList<QSharedPointer<ConfigurationAction>>& actions) {
+      auto described = QStringList {};
+      for (const auto& action : actions) described.append(describe(*action));
+      return described;
+    }
+
+    QStringList describeForEach(const ConfigurationActionStore& store) {
+      auto described = QStringList {};
+      store.forEach([&described](const ConfigurationAction& action) { described.append(describe(action)); });
+      return described;
+    }
+
+    class ConfigurationActionStoreTest : public ::testing::Test {
+      protected:
+        void SetUp() override {
+          m_heads = {makeMetaHead("store-1"), makeMetaHead("store-2"), makeMetaHead("store-3")};
+        }
+
+        OutputId outputId(qsizetype index) const { return m_heads.at(index)->getOutputId(); }
+
+        QList<QSharedPointer<WaylandOutputMetaHead>> m_heads;
+        ConfigurationActionStore                     m_store;
+    };
+  }
+
+  // Setting an action again for the same output replaces it and moves it to the back, other outputs' actions of that type are left alone
+  TEST_F(ConfigurationActionStoreTest, ReplacesActionsWithTheSameKey) {
+    auto first_mode  = ConfigurationAction::mode("store-1", QSize {1920, 1080}, 60000);
+    auto first_scale = ConfigurationAction::scale("store-1", 1.5);
+    auto second_mode = ConfigurationAction::mode("store-2", QSize {2560, 1440}, 60000);
+    m_store.insert(first_mode);
+    m_store.insert(first_scale);
+    m_store.insert(second_mode);
+
+    auto replacement = ConfigurationAction::mode("store-1", QSize {3840, 2160}, 60000);
+    m_store.insert(replacement);
+    EXPECT_EQ(m_store.size(), 3);
+    EXPECT_EQ(m_store.find(outputId(0), ConfigurationActionType::SetMode), replacement);
+    EXPECT_EQ(m_store.find(outputId(1), ConfigurationActionType::SetMode), second_mode);
+    EXPECT_EQ(m_store.actions(), (QList<QSharedPointer<ConfigurationAction>> {first_scale, second_mode, replacement}));
+
+    // Null actions (for outputs we have never seen) are never stored
+    m_store.insert(nullptr);
+    EXPECT_EQ(m_store.size(), 3);
+  }
+
+  TEST_F(ConfigurationActionStoreTest, RemovesByKey) {
+    m_store.insert(ConfigurationAction::mode("store-1", QSize {1920, 1080}, 60000));
+    m_store.insert(ConfigurationAction::scale("store-1", 1.5));
+    m_store.insert(ConfigurationAction::scale("store-2", 2.0));
+
+    EXPECT_TRUE(m_store.remove(outputId(0), ConfigurationActionType::SetScale));
+    EXPECT_FALSE(m_store.remove(outputId(0), ConfigurationActionType::SetScale));
+    EXPECT_FALSE(m_store.remove(outputId(0), ConfigurationActionType::SetTransform));
+    EXPECT_TRUE(m_store.find(outputId(0), ConfigurationActionType::SetScale).isNull());
+    EXPECT_FALSE(m_store.find(outputId(0), ConfigurationActionType::SetMode).isNull());
+    EXPECT_FALSE(m_store.find(outputId(1), ConfigurationActionType::SetScale).isNull());
+    EXPECT_EQ(m_store.size(), 2);
+    EXPECT_FALSE(m_store.isEmpty());
+  }
+
+  TEST_F(ConfigurationActionStoreTest, RemovesEveryActionForAnOutput) {
+    m_store.insert(ConfigurationAction::mode("store-1", QSize {1920, 1080}, 60000));
+    auto kept = ConfigurationAction::mode("store-2", QSize {2560, 1440}, 60000);
+    m_store.insert(kept);
+    m_store.insert(ConfigurationAction::scale("store-1", 1.5));
+    m_store.insert(ConfigurationAction::transform("store-1", 1));
+    m_store.insert(ConfigurationAction::primary("store-1"));
+
+    m_store.removeOutput(outputId(0));
+    EXPECT_EQ(m_store.actions(), QList<QSharedPointer<ConfigurationAction>> {kept});
+    EXPECT_EQ(m_store.size(), 1);
+
+    auto visited = 0;
+    m_store.forEachFor(outputId(0), [&visited](const ConfigurationAction&) { visited++; });
+    EXPECT_EQ(visited, 0);
+
+    m_store.removeOutput(outputId(1));
+    EXPECT_TRUE(m_store.isEmpty());
+    EXPECT_TRUE(m_store.actions().isEmpty());
+  }
+
+  // Removing more than half the actions compacts the holes they left, which must keep the order of the rest and leave them findable
+  TEST_F(ConfigurationActionStoreTest, CompactsHolesKeepingTheOrder) {
+    for (const auto* serial : {"store-1", "store-2", "store-3"}) {
+      m_store.insert(ConfigurationAction::mode(serial, QSize {1920, 1080}, 60000));
+      m_store.insert(ConfigurationAction::scale(serial, 1.25));
+      m_store.insert(ConfigurationAction::transform(serial, 2));
+    }
+    auto order = describe(m_store.actions());
+    ASSERT_EQ(order.size(), 9);
+
+    // Five holes outnumber the four actions left
+    m_store.remove(outputId(0), ConfigurationActionType::SetMode);
+    m_store.remove(outputId(0), ConfigurationActionType::SetTransform);
+    m_store.remove(outputId(1), ConfigurationActionType::SetScale);
+    m_store.remove(outputId(2), ConfigurationActionType::SetMode);
+    m_store.remove(outputId(2), ConfigurationActionType::SetTransform);
+
+    auto remaining = QStringList {order.at(1), order.at(3), order.at(5), order.at(7)};
+    EXPECT_EQ(describe(m_store.actions()), remaining);
+    EXPECT_EQ(describeForEach(m_store), remaining);
+    EXPECT_EQ(m_store.size(), 4);
+    EXPECT_FALSE(m_store.find(outputId(0), ConfigurationActionType::SetScale).isNull());
+    EXPECT_FALSE(m_store.find(outputId(1), ConfigurationActionType::SetMode).isNull());
+    EXPECT_FALSE(m_store.find(outputId(1), ConfigurationActionType::SetTransform).isNull());
+    EXPECT_FALSE(m_store.find(outputId(2), ConfigurationActionType::SetScale).isNull());
+
+    // Replacing and removing still find the right slots after the compaction
+    auto replacement = ConfigurationAction::mode("store-2", QSize {1280, 720}, 60000);
+    m_store.insert(replacement);
+    EXPECT_EQ(m_store.actions().last(), replacement);
+    EXPECT_TRUE(m_store.remove(outputId(1), ConfigurationActionType::SetTransform));
+    EXPECT_EQ(describe(m_store.actions()), (QStringList {order.at(1), order.at(7), describe(*replacement)}));
+
+    auto for_second = QStringList {};
+    m_store.forEachFor(outputId(1), [&for_second](const ConfigurationAction& action) { for_second.append(describe(action)); });
+    EXPECT_EQ(for_second, QStringList {describe(*replacement)});
+  }
+
+  // What GetActions reports is the order actions were last set in, across outputs and types
+  TEST_F(ConfigurationActionStoreTest, ListsActionsInTheOrderTheyWereSet) {
+    auto actions = QList<QSharedPointer<ConfigurationAction>> {
+        ConfigurationAction::scale("store-3", 2.0),
+        ConfigurationAction::mode("store-1", QSize {1920, 1080}, 60000),
+        ConfigurationAction::explicitOn("store-2"),
+        ConfigurationAction::transform("store-1", 1),
+    };
+    for (const auto& action : actions) m_store.insert(action);
+    EXPECT_EQ(m_store.actions(), actions);
+    EXPECT_EQ(describeForEach(m_store), describe(actions));
+
+    auto for_first = QList<const ConfigurationAction*> {};
+    m_store.forEachFor(outputId(0), [&for_first](const ConfigurationAction& action) { for_first.append(&action); });
+    EXPECT_EQ(for_first, (QList<const ConfigurationAction*> {actions.at(1).data(), actions.at(3).data()}));
+
+    m_store.clear();
+    EXPECT_TRUE(m_store.isEmpty());
+    EXPECT_TRUE(m_store.find(outputId(2), ConfigurationActionType::SetScale).isNull());
+  }
+}
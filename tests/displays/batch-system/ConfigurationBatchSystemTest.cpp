@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "displays/batch-system/ConfigurationBatchSystem.hpp"
+#include "mock/MockHeads.hpp"
+
+namespace bd::testing {
+  namespace {
+    class ConfigurationBatchSystemTest : public ::testing::Test {
+      protected:
+        void SetUp() override {
+          m_heads = {makeMetaHead("batch-1"), makeMetaHead("batch-2")};
+          m_batch.addAction(ConfigurationAction::mode("batch-1", QSize {1920, 1080}, 60000));
+          m_batch.addAction(ConfigurationAction::mode("batch-2", QSize {2560, 1440}, 60000));
+          ASSERT_TRUE(m_batch.calculate(m_heads));
+        }
+
+        QList<QSharedPointer<WaylandOutputMetaHead>> m_heads;
+        ConfigurationBatchSystem                     m_batch {nullptr};
+    };
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, ReusesTheResultWhenNothingChanged) {
+    auto fingerprint = m_batch.getFingerprint(m_heads);
+    auto result      = m_batch.getCalculationResult();
+
+    EXPECT_FALSE(m_batch.calculate(m_heads));
+    EXPECT_EQ(m_batch.getFingerprint(m_heads), fingerprint);
+    EXPECT_EQ(m_batch.getCalculationResult(), result);
+    EXPECT_EQ(result->getFingerprint(), fingerprint);
+  }
+
+  // The fingerprint is what the actions do, not how often they were set
+  TEST_F(ConfigurationBatchSystemTest, ReusesTheResultForAnIdenticalAction) {
+    auto fingerprint = m_batch.getFingerprint(m_heads);
+    m_batch.addAction(ConfigurationAction::mode("batch-2", QSize {2560, 1440}, 60000));
+
+    EXPECT_EQ(m_batch.getFingerprint(m_heads), fingerprint);
+    EXPECT_FALSE(m_batch.calculate(m_heads));
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenAnActionChanges) {
+    auto fingerprint = m_batch.getFingerprint(m_heads);
+    m_batch.addAction(ConfigurationAction::mode("batch-2", QSize {3840, 2160}, 60000));
+
+    EXPECT_NE(m_batch.getFingerprint(m_heads), fingerprint);
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+    EXPECT_EQ(m_batch.getCalculationResult()->getGlobalSpace(), QRect(0, 0, 1920 + 3840, 2160));
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenAnActionIsRemoved) {
+    m_batch.addAction(ConfigurationAction::scale("batch-1", 2.0));
+    ASSERT_TRUE(m_batch.calculate(m_heads));
+
+    m_batch.removeAction(m_heads.at(0)->getOutputId(), ConfigurationActionType::SetScale);
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+    EXPECT_EQ(m_batch.getCalculationResult()->getOutputState(m_heads.at(0)->getOutputId())->getScale(), 1.0);
+  }
+
+  // Setting the same actions in another order can place outputs differently, so it isn't the same calculation
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenActionsAreReordered) {
+    m_batch.addAction(ConfigurationAction::mode("batch-1", QSize {1920, 1080}, 60000));
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenAHeadChanges) {
+    auto fingerprint = m_batch.getFingerprint(m_heads);
+    moveMetaHead(*m_heads.at(1), QPoint {0, 1080});
+
+    EXPECT_NE(m_batch.getFingerprint(m_heads), fingerprint);
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenAHeadIsReplaced) {
+    // A new meta head for the same output, committed as many times as the one it replaces
+    auto replacement = makeMetaHead("batch-2");
+    ASSERT_EQ(replacement->getOutputId(), m_heads.at(1)->getOutputId());
+    ASSERT_EQ(replacement->getGeneration(), m_heads.at(1)->getGeneration());
+
+    m_heads[1] = replacement;
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+  }
+
+  TEST_F(ConfigurationBatchSystemTest, RecalculatesWhenAHeadDisconnects) {
+    m_heads.removeLast();
+    EXPECT_TRUE(m_batch.calculate(m_heads));
+    EXPECT_EQ(m_batch.getCalculationResult()->getOutputStates().size(), 1);
+  }
+
+  // Turning an output off drops every other action for that output, and only for that output. The off action itself is kept.
+  TEST_F(ConfigurationBatchSystemTest, TurningAnOutputOffOnlyDropsItsOwnActions) {
+    auto first_scale  = ConfigurationAction::scale("batch-1", 2.0);
+    auto second_scale = ConfigurationAction::scale("batch-2", 1.5);
+    m_batch.addAction(first_scale);
+    m_batch.addAction(second_scale);
+    auto second_mode = m_batch.getActions().at(1);
+    ASSERT_EQ(second_mode->getOutputId(), m_heads.at(1)->getOutputId());
+
+    auto off = ConfigurationAction::explicitOff("batch-1");
+    m_batch.addAction(off);
+    EXPECT_EQ(m_batch.getActions(), (QList<QSharedPointer<ConfigurationAction>> {second_mode, second_scale, off}));
+
+    // Turning it back on replaces the off action, without bringing back what it dropped
+    auto on = ConfigurationAction::explicitOn("batch-1");
+    m_batch.addAction(on);
+    EXPECT_EQ(m_batch.getActions(), (QList<QSharedPointer<ConfigurationAction>> {second_mode, second_scale, on}));
+  }
+
+  // Identifiers from D-Bus clients and config files are looked up, so an unknown one is dropped rather than taking a slot in the id table
+  TEST_F(ConfigurationBatchSystemTest, IgnoresActionsForUnknownOutputs) {
+    auto fingerprint = m_batch.getFingerprint(m_heads);
+
+    EXPECT_TRUE(ConfigurationAction::mode("batch-unknown", QSize {1920, 1080}, 60000).isNull());
+    EXPECT_TRUE(ConfigurationAction::setPositionAnchor("batch-1", "batch-unknown-relative", ConfigurationHorizontalAnchor::Right,
+                                                       ConfigurationVerticalAnchor::Top)
+                  .isNull());
+    EXPECT_TRUE(ConfigurationAction::mirrorOf("batch-2", "batch-unknown-relative").isNull());
+    EXPECT_EQ(OutputIdTable::instance().find("batch-unknown"), OutputId::Invalid);
+    EXPECT_EQ(OutputIdTable::instance().find("batch-unknown-relative"), OutputId::Invalid);
+
+    m_batch.addAction(ConfigurationAction::mode("batch-unknown", QSize {1920, 1080}, 60000));
+    EXPECT_EQ(m_batch.getFingerprint(m_heads), fingerprint);
+    EXPECT_FALSE(m_batch.calculate(m_heads));
+
+    // Known outputs still are
+    EXPECT_FALSE(ConfigurationAction::setPositionAnchor("batch-2", "batch-1", ConfigurationHorizontalAnchor::Right,
+                                                        ConfigurationVerticalAnchor::Top)
+                   .isNull());
+  }
+}
@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+
+#include <QStringList>
+
+#include "displays/batch-system/ConfigurationLayout.hpp"
+#include "mock/MockHeads.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto RandomOutputs = 6;
+    constexpr auto RandomSteps   = 300;
+
+    const auto Dimensions = std::array {QSize {1920, 1080}, QSize {2560, 1440}, QSize {1280, 1024}, QSize {3840, 2160}};
+    const auto Scales     = std::array {1.0, 1.25, 1.5, 2.0};
+
+    // RandomLayout drives a layout the way ConfigurationBatchSystem does, with random actions and head changes
+    class RandomLayout {
+      public:
+        explicit RandomLayout(unsigned int seed) : m_random(seed) {
+          for (auto index = 0; index < RandomOutputs; ++index) {
+            auto serial = QString("layout-random-%1").arg(index);
+            m_serials.append(serial);
+            m_heads.append(makeMetaHead(serial, QPoint {index * 1920, 0}));
+            m_connected.append(true);
+            add(ConfigurationAction::mode(serial, Dimensions.at(index % Dimensions.size()), 60000));
+          }
+        }
+
+        void step() {
+          auto index  = pick(RandomOutputs);
+          auto serial = m_serials.at(index);
+          switch (pick(9)) {
+            case 0:
+              add(ConfigurationAction::mode(serial, Dimensions.at(pick(Dimensions.size())), 60000));
+              break;
+            case 1:
+              add(ConfigurationAction::scale(serial, Scales.at(pick(Scales.size()))));
+              break;
+            case 2:
+              add(ConfigurationAction::transform(serial, static_cast<quint8>(pick(8))));
+              break;
+            case 3:
+              if (pick(2) == 0) {
+                add(ConfigurationAction::explicitOn(serial));
+              } else {
+                // Like the batch system, turning an output off drops everything else we were going to do to it
+                m_actions.removeOutput(m_heads.at(index)->getOutputId());
+                add(ConfigurationAction::explicitOff(serial));
+              }
+              break;
+            case 4:
+              add(ConfigurationAction::setPositionAnchor(serial, m_serials.at(pick(RandomOutputs)),
+                                                         static_cast<ConfigurationHorizontalAnchor>(pick(4)),
+                                                         static_cast<ConfigurationVerticalAnchor>(pick(6))));
+              break;
+            case 5:
+              add(ConfigurationAction::mirrorOf(serial, m_serials.at(pick(RandomOutputs))));
+              break;
+            case 6: {
+              auto action_type = pick(2) == 0 ? ConfigurationActionType::SetPositionAnchor : ConfigurationActionType::SetMirrorOf;
+              m_actions.remove(m_heads.at(index)->getOutputId(), action_type);
+              m_layout.markDirty(m_heads.at(index)->getOutputId());
+              break;
+            }
+            case 7:
+              moveMetaHead(*m_heads.at(index), QPoint {pick(4) * 1000, pick(4) * 500});
+              break;
+            case 8:
+              m_connected[index] = !m_connected.at(index);
+              break;
+          }
+        }
+
+        QList<QSharedPointer<WaylandOutputMetaHead>> heads() const {
+          auto heads = QList<QSharedPointer<WaylandOutputMetaHead>> {};
+          for (auto index = 0; index < RandomOutputs; ++index) {
+            if (m_connected.at(index)) heads.append(m_heads.at(index));
+          }
+          return heads;
+        }
+
+        ConfigurationLayout&            layout() { return m_layout; }
+        const ConfigurationActionStore& actions() const { return m_actions; }
+
+      private:
+        int pick(size_t count) { return std::uniform_int_distribution<int>(0, static_cast<int>(count) - 1)(m_random); }
+
+        void add(const QSharedPointer<ConfigurationAction>& action) {
+          m_actions.insert(action);
+          m_layout.markDirty(action->getOutputId());
+        }
+
+        std::mt19937                                 m_random;
+        QStringList                                  m_serials;
+        QList<QSharedPointer<WaylandOutputMetaHead>> m_heads;
+        QList<bool>                                  m_connected;
+        ConfigurationActionStore                     m_actions;
+        ConfigurationLayout                          m_layout;
+    };
+
+    QPoint positionOf(const ConfigurationLayout& layout, const QSharedPointer<WaylandOutputMetaHead>& head) {
+      auto state = layout.getOutputState(head->getOutputId());
+      return state != nullptr ? state->getPosition() : QPoint {-1, -1};
+    }
+  }
+
+  class ConfigurationLayoutRandomTest : public ::testing::TestWithParam<unsigned int> {};
+
+  TEST_P(ConfigurationLayoutRandomTest, IncrementalUpdatesMatchFullOnes) {
+    auto random = RandomLayout(GetParam());
+    random.layout().update(random.heads(), random.actions());
+
+    for (auto step = 0; step < RandomSteps; ++step) {
+      random.step();
+      auto heads = random.heads();
+      random.layout().update(heads, random.actions());
+
+      auto full = ConfigurationLayout {};
+      full.update(heads, random.actions());
+      ASSERT_TRUE(random.layout().isEquivalentTo(full)) << "seed " << GetParam() << ", step " << step;
+    }
+  }
+
+  INSTANTIATE_TEST_SUITE_P(Seeds, ConfigurationLayoutRandomTest, ::testing::Range(1u, 17u));
+
+  TEST(ConfigurationLayoutTest, ChainsOutputsLeftToRight) {
+    auto first  = makeMetaHead("layout-chain-1");
+    auto second = makeMetaHead("layout-chain-2");
+    auto heads  = QList<QSharedPointer<WaylandOutputMetaHead>> {first, second};
+
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-chain-1", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-chain-2", QSize {2560, 1440}, 60000));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-chain-2", "layout-chain-1", ConfigurationHorizontalAnchor::Right,
+                                                          ConfigurationVerticalAnchor::NoVerticalAnchor));
+
+    auto layout = ConfigurationLayout {};
+    layout.update(heads, actions);
+    EXPECT_EQ(positionOf(layout, first), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, second), QPoint(1920, 0));
+    EXPECT_EQ(layout.getGlobalSpace(), QRect(0, 0, 1920 + 2560, 1440));
+  }
+
+  // An output anchored to a mirror is placed against where the mirror ends up, not where its head was
+  TEST(ConfigurationLayoutTest, AnchorsToAMirrorAfterPlacingIt) {
+    auto source   = makeMetaHead("layout-mirror-source");
+    auto mirror   = makeMetaHead("layout-mirror-mirror", QPoint {5000, 5000});
+    auto anchored = makeMetaHead("layout-mirror-anchored");
+    auto heads    = QList<QSharedPointer<WaylandOutputMetaHead>> {source, mirror, anchored};
+
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-mirror-source", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-mirror-mirror", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-mirror-anchored", QSize {1280, 1024}, 60000));
+    actions.insert(ConfigurationAction::mirrorOf("layout-mirror-mirror", "layout-mirror-source"));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-mirror-anchored", "layout-mirror-mirror", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+
+    auto layout = ConfigurationLayout {};
+    layout.update(heads, actions);
+    EXPECT_EQ(positionOf(layout, mirror), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(0, 1080));
+
+    // Moving the mirror's head doesn't matter, it still follows its source
+    moveMetaHead(*mirror, QPoint {100, 100});
+    layout.update(heads, actions);
+    EXPECT_EQ(positionOf(layout, mirror), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(0, 1080));
+  }
+
+  // Resizing an output moves whatever is anchored below it, even though the output itself stays where it was
+  TEST(ConfigurationLayoutTest, ReplacesOutputsAnchoredToAChangedOutput) {
+    auto relative = makeMetaHead("layout-resized-relative");
+    auto anchored = makeMetaHead("layout-resized-anchored");
+    auto heads    = QList<QSharedPointer<WaylandOutputMetaHead>> {relative, anchored};
+
+    auto layout  = ConfigurationLayout {};
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-resized-relative", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-resized-anchored", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-resized-anchored", "layout-resized-relative", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    layout.update(heads, actions);
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(0, 1080));
+
+    actions.insert(ConfigurationAction::mode("layout-resized-relative", QSize {2560, 1440}, 60000));
+    layout.markDirty(relative->getOutputId());
+    layout.update(heads, actions);
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(0, 1440));
+  }
+
+  // Outputs anchored to one another in a loop can't be placed relative to each other. The cycle is reported, along with whatever is anchored
+  // to it, and all of them are left in the horizontal chain. Breaking the cycle places them by their anchors again.
+  TEST(ConfigurationLayoutTest, ReportsATwoOutputCycle) {
+    auto first     = makeMetaHead("layout-cycle2-first");
+    auto second    = makeMetaHead("layout-cycle2-second");
+    auto dependent = makeMetaHead("layout-cycle2-dependent");
+    auto heads     = QList<QSharedPointer<WaylandOutputMetaHead>> {first, second, dependent};
+
+    auto layout  = ConfigurationLayout {};
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-cycle2-first", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-cycle2-second", QSize {2560, 1440}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-cycle2-dependent", QSize {1280, 1024}, 60000));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle2-first", "layout-cycle2-second", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle2-second", "layout-cycle2-first", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle2-dependent", "layout-cycle2-first", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    layout.update(heads, actions);
+
+    auto errors = QList<CalculationError> {CalculationError {.type       = CalculationError::Type::AnchorCycle,
+                                                             .outputs    = {first->getOutputId(), second->getOutputId()},
+                                                             .dependents = {dependent->getOutputId()}}};
+    EXPECT_EQ(layout.getErrors(), errors);
+    EXPECT_EQ(positionOf(layout, first), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, second), QPoint(1920, 0));
+    EXPECT_EQ(positionOf(layout, dependent), QPoint(1920 + 2560, 0));
+    EXPECT_EQ(layout.getGlobalSpace(), QRect(0, 0, 1920 + 2560 + 1280, 1440));
+
+    actions.remove(second->getOutputId(), ConfigurationActionType::SetPositionAnchor);
+    layout.markDirty(second->getOutputId());
+    layout.update(heads, actions);
+
+    EXPECT_TRUE(layout.getErrors().isEmpty());
+    EXPECT_EQ(positionOf(layout, second), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, first), QPoint(0, 1440));
+    EXPECT_EQ(positionOf(layout, dependent), QPoint(0, 1440 + 1080));
+  }
+
+  // A cycle can also go through a mirror, here an output mirroring the one anchored below it. It is reported as well, along with whatever is
+  // anchored to it, and none of them are placed: they stay where their heads are until the cycle is broken.
+  TEST(ConfigurationLayoutTest, ReportsACycleThroughAMirror) {
+    auto mirror    = makeMetaHead("layout-mixed-mirror", QPoint {100, 0});
+    auto anchored  = makeMetaHead("layout-mixed-anchored", QPoint {5000, 0});
+    auto dependent = makeMetaHead("layout-mixed-dependent", QPoint {9000, 0});
+    auto heads     = QList<QSharedPointer<WaylandOutputMetaHead>> {mirror, anchored, dependent};
+
+    auto layout  = ConfigurationLayout {};
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-mixed-mirror", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-mixed-anchored", QSize {2560, 1440}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-mixed-dependent", QSize {1280, 1024}, 60000));
+    actions.insert(ConfigurationAction::mirrorOf("layout-mixed-mirror", "layout-mixed-anchored"));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-mixed-anchored", "layout-mixed-mirror", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-mixed-dependent", "layout-mixed-anchored", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    layout.update(heads, actions);
+
+    auto errors = QList<CalculationError> {CalculationError {.type       = CalculationError::Type::PlacementCycle,
+                                                             .outputs    = {mirror->getOutputId(), anchored->getOutputId()},
+                                                             .dependents = {dependent->getOutputId()}}};
+    EXPECT_EQ(layout.getErrors(), errors);
+    EXPECT_EQ(positionOf(layout, mirror), QPoint(100, 0));
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(5000, 0));
+    EXPECT_EQ(positionOf(layout, dependent), QPoint(9000, 0));
+
+    actions.remove(mirror->getOutputId(), ConfigurationActionType::SetMirrorOf);
+    layout.markDirty(mirror->getOutputId());
+    layout.update(heads, actions);
+
+    EXPECT_TRUE(layout.getErrors().isEmpty());
+    EXPECT_EQ(positionOf(layout, mirror), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(0, 1080));
+    EXPECT_EQ(positionOf(layout, dependent), QPoint(0, 1080 + 1440));
+  }
+
+  // A cycle doesn't stop outputs that aren't part of it from being placed by their anchors
+  TEST(ConfigurationLayoutTest, ReportsAThreeOutputCycle) {
+    auto first    = makeMetaHead("layout-cycle3-first");
+    auto second   = makeMetaHead("layout-cycle3-second");
+    auto third    = makeMetaHead("layout-cycle3-third");
+    auto chained  = makeMetaHead("layout-cycle3-chained");
+    auto anchored = makeMetaHead("layout-cycle3-anchored");
+    auto heads    = QList<QSharedPointer<WaylandOutputMetaHead>> {first, second, third, chained, anchored};
+
+    auto actions = ConfigurationActionStore {};
+    for (const auto& head : heads) actions.insert(ConfigurationAction::mode(head->getIdentifier(), QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle3-first", "layout-cycle3-second", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle3-second", "layout-cycle3-third", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle3-third", "layout-cycle3-first", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-cycle3-anchored", "layout-cycle3-chained", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+
+    auto layout = ConfigurationLayout {};
+    layout.update(heads, actions);
+
+    auto errors = QList<CalculationError> {CalculationError {.type       = CalculationError::Type::AnchorCycle,
+                                                             .outputs    = {first->getOutputId(), second->getOutputId(), third->getOutputId()},
+                                                             .dependents = {}}};
+    EXPECT_EQ(layout.getErrors(), errors);
+    EXPECT_EQ(positionOf(layout, first), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, second), QPoint(1920, 0));
+    EXPECT_EQ(positionOf(layout, third), QPoint(2 * 1920, 0));
+    EXPECT_EQ(positionOf(layout, chained), QPoint(3 * 1920, 0));
+    EXPECT_EQ(positionOf(layout, anchored), QPoint(3 * 1920, 1080));
+    EXPECT_EQ(layout.getGlobalSpace(), QRect(0, 0, 4 * 1920, 2 * 1080));
+  }
+
+  TEST(ConfigurationLayoutTest, ReportsAnOutputAnchoredToItself) {
+    auto self      = makeMetaHead("layout-self-anchor");
+    auto dependent = makeMetaHead("layout-self-dependent");
+    auto heads     = QList<QSharedPointer<WaylandOutputMetaHead>> {self, dependent};
+
+    auto actions = ConfigurationActionStore {};
+    actions.insert(ConfigurationAction::mode("layout-self-anchor", QSize {1920, 1080}, 60000));
+    actions.insert(ConfigurationAction::mode("layout-self-dependent", QSize {2560, 1440}, 60000));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-self-anchor", "layout-self-anchor", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+    actions.insert(ConfigurationAction::setPositionAnchor("layout-self-dependent", "layout-self-anchor", ConfigurationHorizontalAnchor::Left,
+                                                          ConfigurationVerticalAnchor::Below));
+
+    auto layout = ConfigurationLayout {};
+    layout.update(heads, actions);
+
+    auto errors = QList<CalculationError> {CalculationError {
+        .type = CalculationError::Type::AnchorCycle, .outputs = {self->getOutputId()}, .dependents = {dependent->getOutputId()}}};
+    EXPECT_EQ(layout.getErrors(), errors);
+    EXPECT_EQ(positionOf(layout, self), QPoint(0, 0));
+    EXPECT_EQ(positionOf(layout, dependent), QPoint(1920, 0));
+    EXPECT_EQ(layout.getGlobalSpace(), QRect(0, 0, 1920 + 2560, 1440));
+  }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+
+using namespace std::chrono_literals;
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Socket = "budgie-orchestrator-test";
+
+    // waitUntil runs the event loop (which is where the orchestrator dispatches the display) until condition holds
+    bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout = 10s) {
+      auto timer = QElapsedTimer {};
+      timer.start();
+      while (!condition()) {
+        if (timer.elapsed() > timeout.count()) return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        std::this_thread::sleep_for(1ms);
+      }
+      return true;
+    }
+
+    // startServer brings up a compositor advertising heads on the socket the orchestrator connects to
+    std::unique_ptr<MockOutputManagementServer> startServer(const QList<MockHead>& heads) {
+      auto server = std::make_unique<MockOutputManagementServer>();
+      for (const auto& head : heads) server->addHead(head);
+      if (!server->addSocket(Socket)) return nullptr;
+      return server;
+    }
+  }
+
+  // The orchestrator is a singleton that is only ever initialised once, so a single test walks it through both kinds of reconnect: one to a
+  // compositor that kept our outputs as they were, and one to a compositor that did not.
+  TEST(WaylandOrchestratorTest, ReconnectsAndOnlyReportsOutputsThatChanged) {
+    auto runtime_dir = QTemporaryDir {};
+    ASSERT_TRUE(runtime_dir.isValid());
+    qputenv("XDG_RUNTIME_DIR", runtime_dir.path().toUtf8());
+    qputenv("WAYLAND_DISPLAY", Socket);
+
+    auto heads  = QList<MockHead> {makeMockHead("orchestrator-1"), makeMockHead("orchestrator-2", QPoint {1920, 0})};
+    auto server = startServer(heads);
+    ASSERT_NE(server, nullptr);
+
+    auto& orchestrator    = WaylandOrchestrator::instance();
+    auto  ready           = false;
+    auto  done_count      = 0;
+    auto  outputs_changed = 0;
+    QObject::connect(&orchestrator, &WaylandOrchestrator::ready, [&ready]() { ready = true; });
+    QObject::connect(&orchestrator, &WaylandOrchestrator::done, [&done_count]() { done_count++; });
+    QObject::connect(&orchestrator, &WaylandOrchestrator::outputsChanged, [&outputs_changed]() { outputs_changed++; });
+
+    orchestrator.init();
+    ASSERT_TRUE(waitUntil([&ready]() { return ready; }));
+    auto manager   = orchestrator.getManager();
+    auto meta_head = manager->getOutputHead(QString("orchestrator-2"));
+    ASSERT_FALSE(meta_head.isNull());
+    auto identifier = meta_head->getIdentifier();
+
+    // The compositor goes away, and only comes back after the first reconnect attempt has failed
+    server.reset();
+    ASSERT_TRUE(waitUntil([&orchestrator]() { return orchestrator.getDisplay() == nullptr; }));
+    auto dones = done_count;
+    std::this_thread::sleep_for(400ms);
+    QCoreApplication::processEvents();
+    server = startServer(heads);
+    ASSERT_NE(server, nullptr);
+
+    ASSERT_TRUE(waitUntil([&dones, &done_count]() { return done_count > dones; }));
+    EXPECT_EQ(outputs_changed, 0);
+
+    // The same meta heads carry on, so their D-Bus paths (which are derived from the identifier) stay put
+    EXPECT_EQ(orchestrator.getManager(), manager);
+    EXPECT_EQ(manager->getOutputHead(QString("orchestrator-2")), meta_head);
+    EXPECT_EQ(meta_head->getIdentifier(), identifier);
+    EXPECT_TRUE(meta_head->isAvailable());
+    EXPECT_EQ(manager->getHeads().size(), 2);
+
+    // This time the compositor comes back with an output somewhere else, which has to be reported so the configuration is re-applied
+    server.reset();
+    ASSERT_TRUE(waitUntil([&orchestrator]() { return orchestrator.getDisplay() == nullptr; }));
+    dones = done_count;
+    heads[1].position = QPoint {0, 1080};
+    server            = startServer(heads);
+    ASSERT_NE(server, nullptr);
+
+    ASSERT_TRUE(waitUntil([&dones, &done_count]() { return done_count > dones; }));
+    EXPECT_EQ(outputs_changed, 1);
+    EXPECT_EQ(manager->getOutputHead(QString("orchestrator-2")), meta_head);
+    EXPECT_EQ(meta_head->getPosition(), QPoint(0, 1080));
+  }
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto SoakCycles = 10000;
+  }
+
+  class WaylandOutputManagerSoakTest : public ::testing::TestWithParam<bool> {};
+
+  // Plugging and unplugging the same output over and over must not leave anything behind: every head and mode proxy is released back to the
+  // compositor, the output keeps reusing the one meta head, and its meta modes are dropped along with the compositor's modes.
+  TEST_P(WaylandOutputManagerSoakTest, PlugAndUnplugFreesEverything) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("manager-soak-fixed"));
+    auto connection = MockOutputManagerConnection(server, GetParam());
+
+    auto meta_head = QSharedPointer<WaylandOutputMetaHead> {};
+    for (auto cycle = 0; cycle < SoakCycles; ++cycle) {
+      auto id = server.addHead(makeMockHead("manager-soak-plugged", QPoint {1920, 0}));
+      ASSERT_TRUE(connection.sync()) << "cycle " << cycle;
+
+      auto plugged = connection.manager()->getOutputHead(QString("manager-soak-plugged"));
+      ASSERT_FALSE(plugged.isNull()) << "cycle " << cycle;
+      if (meta_head.isNull()) meta_head = plugged;
+      ASSERT_EQ(plugged, meta_head) << "cycle " << cycle;
+      ASSERT_EQ(plugged->getModes().size(), 2) << "cycle " << cycle;
+      auto mode = plugged->getCurrentMode();
+
+      server.removeHead(id);
+      ASSERT_TRUE(connection.sync()) << "cycle " << cycle;
+      ASSERT_FALSE(meta_head->isAvailable()) << "cycle " << cycle;
+      ASSERT_TRUE(meta_head->getModes().isEmpty()) << "cycle " << cycle;
+      ASSERT_TRUE(mode.isNull()) << "cycle " << cycle;
+    }
+
+    // Only the head that stayed plugged in (and its two modes) still has resources on the compositor's side
+    EXPECT_TRUE(connection.waitFor([&server]() { return server.liveHeadResources() == 1 && server.liveModeResources() == 2; }));
+    EXPECT_EQ(server.liveHeadResources(), 1);
+    EXPECT_EQ(server.liveModeResources(), 2);
+    EXPECT_EQ(connection.manager()->getHeads().size(), 1);
+  }
+
+  INSTANTIATE_TEST_SUITE_P(Dispatch, WaylandOutputManagerSoakTest, ::testing::Values(false, true),
+                           [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "EventThread" : "MainThread"; });
+}
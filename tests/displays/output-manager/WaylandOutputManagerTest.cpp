@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+using namespace std::chrono_literals;
+
+namespace bd::testing {
+  namespace {
+    enum class ApplyResult { Pending, Succeeded, Failed, Cancelled };
+
+    // ApplyRequest moves one head and records how the compositor answered
+    struct ApplyRequest {
+        QSharedPointer<WaylandOutputConfiguration>     configuration;
+        QSharedPointer<WaylandOutputConfigurationHead> head;
+        ApplyResult                                    result = ApplyResult::Pending;
+    };
+
+    std::unique_ptr<ApplyRequest> applyPosition(MockOutputManagerConnection& connection, const QString& identifier, QPoint position) {
+      auto request           = std::make_unique<ApplyRequest>();
+      auto meta_head         = connection.manager()->getOutputHead(identifier);
+      request->configuration = connection.manager()->configure();
+      request->head          = request->configuration->enable(meta_head.data());
+      request->head->setPosition(position.x(), position.y());
+
+      auto result = &request->result;
+      QObject::connect(request->configuration.data(), &WaylandOutputConfiguration::succeeded, [result]() { *result = ApplyResult::Succeeded; });
+      QObject::connect(request->configuration.data(), &WaylandOutputConfiguration::failed, [result]() { *result = ApplyResult::Failed; });
+      QObject::connect(request->configuration.data(), &WaylandOutputConfiguration::cancelled, [result]() { *result = ApplyResult::Cancelled; });
+      request->configuration->applySelf();
+      wl_display_flush(connection.display());
+      return request;
+    }
+  }
+
+  TEST(WaylandOutputManagerTest, CommitsScriptedHeadsAndModes) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("manager-scripted-1"));
+    auto second         = makeMockHead("manager-scripted-2", QPoint {1920, 0});
+    second.modes        = {MockMode {2560, 1440, 144000, true}, MockMode {2560, 1440, 60000, false}, MockMode {1920, 1080, 60000, false}};
+    second.current_mode = 1;
+    second.scale        = 1.5;
+    second.transform    = 1;
+    server.addHead(second);
+
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+
+    auto heads = connection.manager()->getHeads();
+    ASSERT_EQ(heads.size(), 2);
+
+    auto head = connection.manager()->getOutputHead(QString("manager-scripted-2"));
+    ASSERT_FALSE(head.isNull());
+    EXPECT_TRUE(head->isAvailable());
+    EXPECT_TRUE(head->isEnabled());
+    EXPECT_EQ(head->getName(), "DP-manager-scripted-2");
+    EXPECT_EQ(head->getMake(), "Budgie");
+    EXPECT_EQ(head->getModel(), "Mock");
+    EXPECT_EQ(head->getPosition(), QPoint(1920, 0));
+    EXPECT_DOUBLE_EQ(head->getScale(), 1.5);
+    EXPECT_EQ(head->getTransform(), 1);
+    EXPECT_EQ(head->getModes().size(), 3);
+
+    auto current = head->getCurrentMode();
+    ASSERT_FALSE(current.isNull());
+    EXPECT_EQ(current.getSize().value_or(QSize {}), QSize(2560, 1440));
+    EXPECT_EQ(current.getRefresh().value_or(0), 60000u);
+    EXPECT_EQ(connection.manager()->getSerial(), server.serial());
+  }
+
+  TEST(WaylandOutputManagerTest, HotplugConnectsAndDisconnectsHeads) {
+    auto server     = MockOutputManagementServer {};
+    auto first      = server.addHead(makeMockHead("manager-hotplug-1"));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_EQ(connection.manager()->getHeads().size(), 1);
+
+    auto heads_changed = 0;
+    QObject::connect(connection.manager(), &WaylandOutputManager::headsChanged, [&heads_changed]() { heads_changed++; });
+
+    server.addHead(makeMockHead("manager-hotplug-2", QPoint {1920, 0}));
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getHeads().size(), 2);
+    EXPECT_EQ(heads_changed, 1);
+
+    server.removeHead(first);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getHeads().size(), 1);
+    EXPECT_TRUE(connection.manager()->getOutputHead(QString("manager-hotplug-1")).isNull());
+    EXPECT_EQ(heads_changed, 2);
+
+    // Released by the manager once it committed the head's removal
+    EXPECT_TRUE(connection.waitFor([&server]() { return server.liveHeadResources() == 1; }));
+  }
+
+  // Two heads can end up with one identifier, say when a compositor fills a serial in late. The head that took the identifier last keeps it,
+  // the other is tombstoned rather than left connected with no way to look it up.
+  TEST(WaylandOutputManagerTest, IdentifierCollisionsTombstoneTheOlderHead) {
+    auto server     = MockOutputManagementServer {};
+    auto first      = server.addHead(makeMockHead("manager-collide-1"));
+    auto second     = server.addHead(makeMockHead("manager-collide-2", QPoint {1920, 0}));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+
+    auto newer = connection.manager()->getOutputHead(QString("manager-collide-1"));
+    auto older = connection.manager()->getOutputHead(QString("manager-collide-2"));
+    ASSERT_FALSE(newer.isNull());
+    ASSERT_FALSE(older.isNull());
+
+    auto state   = server.head(first);
+    state.serial = "manager-collide-2";
+    server.updateHead(first, state);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getOutputHead(QString("manager-collide-2")), newer);
+    EXPECT_TRUE(connection.manager()->getOutputHead(QString("manager-collide-1")).isNull());
+    EXPECT_FALSE(older->isAvailable());
+    ASSERT_EQ(connection.manager()->getHeads().size(), 1);
+    EXPECT_EQ(connection.manager()->getHeads().first(), newer);
+
+    // Compacting the tombstone must not hand it the identifier back
+    connection.manager()->setTombstoneMaxAge(0);
+    state.position = QPoint {0, 1080};
+    server.updateHead(first, state);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getOutputHead(QString("manager-collide-2")), newer);
+    EXPECT_EQ(newer->getPosition(), QPoint(0, 1080));
+
+    // The older head's proxy is still released once the compositor is done with it
+    server.removeHead(second);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getHeads().size(), 1);
+    EXPECT_TRUE(connection.waitFor([&server]() { return server.liveHeadResources() == 1; }));
+  }
+
+  TEST(WaylandOutputManagerTest, TopologyPublishesHeadsGoingUnavailable) {
+    auto server     = MockOutputManagementServer {};
+    auto first      = server.addHead(makeMockHead("manager-topology-1"));
+    auto connection = MockOutputManagerConnection(server);
+    server.addHead(makeMockHead("manager-topology-2", QPoint {1920, 0}));
+    ASSERT_TRUE(connection.sync());
+
+    auto first_id  = OutputIdTable::instance().find("manager-topology-1");
+    auto second_id = OutputIdTable::instance().find("manager-topology-2");
+    auto before    = connection.manager()->getTopology();
+    ASSERT_TRUE(before->getHead(first_id)->available);
+
+    // The head's finished arrives without any other change to it
+    server.removeHead(first);
+    ASSERT_TRUE(connection.sync());
+    auto unplugged = connection.manager()->getTopology();
+    EXPECT_GT(unplugged->getGeneration(), before->getGeneration());
+    EXPECT_FALSE(unplugged->getHead(first_id)->available);
+    EXPECT_TRUE(unplugged->getHead(second_id)->available);
+
+    // Losing the connection leaves every head unavailable
+    connection.manager()->unbind();
+    auto unbound = connection.manager()->getTopology();
+    EXPECT_GT(unbound->getGeneration(), unplugged->getGeneration());
+    EXPECT_FALSE(unbound->getHead(second_id)->available);
+  }
+
+  TEST(WaylandOutputManagerTest, ModeChangesReplaceFinishedModes) {
+    auto server     = MockOutputManagementServer {};
+    auto id         = server.addHead(makeMockHead("manager-modes"));
+    auto connection = MockOutputManagerConnection(server);
+
+    auto state         = server.head(id);
+    state.modes        = {MockMode {3840, 2160, 60000, true}};
+    state.current_mode = 0;
+    server.updateHead(id, state);
+    ASSERT_TRUE(connection.sync());
+
+    auto head = connection.manager()->getOutputHead(QString("manager-modes"));
+    ASSERT_FALSE(head.isNull());
+    ASSERT_EQ(head->getModes().size(), 1);
+    EXPECT_EQ(head->getCurrentMode().getSize().value_or(QSize {}), QSize(3840, 2160));
+    EXPECT_EQ(connection.manager()->getTopology()->getHead(head->getOutputId())->mode_ids, QStringList {"3840_2160_60000"});
+    EXPECT_TRUE(connection.waitFor([&server]() { return server.liveModeResources() == 1; }));
+  }
+
+  class WaylandOutputManagerApplyTest : public ::testing::TestWithParam<MockApplyOutcome> {};
+
+  TEST_P(WaylandOutputManagerApplyTest, ReportsTheCompositorsAnswer) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("manager-apply"));
+    server.setApplyOutcome(GetParam());
+    auto connection = MockOutputManagerConnection(server);
+
+    auto request = applyPosition(connection, "manager-apply", QPoint {100, 200});
+    ASSERT_TRUE(connection.waitFor([&request]() { return request->result != ApplyResult::Pending; }));
+    ASSERT_TRUE(connection.sync());
+
+    auto head = connection.manager()->getOutputHead(QString("manager-apply"));
+    switch (GetParam()) {
+      case MockApplyOutcome::Succeeded:
+        EXPECT_EQ(request->result, ApplyResult::Succeeded);
+        EXPECT_EQ(head->getPosition(), QPoint(100, 200));
+        break;
+      case MockApplyOutcome::Failed:
+        EXPECT_EQ(request->result, ApplyResult::Failed);
+        EXPECT_EQ(head->getPosition(), QPoint(0, 0));
+        break;
+      case MockApplyOutcome::Cancelled:
+        EXPECT_EQ(request->result, ApplyResult::Cancelled);
+        EXPECT_EQ(head->getPosition(), QPoint(0, 0));
+        break;
+    }
+    EXPECT_EQ(server.applyCount(), 1);
+  }
+
+  INSTANTIATE_TEST_SUITE_P(Outcomes, WaylandOutputManagerApplyTest,
+                           ::testing::Values(MockApplyOutcome::Succeeded, MockApplyOutcome::Failed, MockApplyOutcome::Cancelled));
+
+  TEST(WaylandOutputManagerTest, ApplyLatencyDelaysTheAnswer) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("manager-latency"));
+    server.setApplyLatency(150ms);
+    auto connection = MockOutputManagerConnection(server);
+
+    auto timer = QElapsedTimer {};
+    timer.start();
+    auto request = applyPosition(connection, "manager-latency", QPoint {10, 10});
+
+    // The apply has reached the server, but its answer is still being held back
+    wl_display_roundtrip(connection.display());
+    EXPECT_EQ(request->result, ApplyResult::Pending);
+
+    ASSERT_TRUE(connection.waitFor([&request]() { return request->result != ApplyResult::Pending; }));
+    EXPECT_EQ(request->result, ApplyResult::Succeeded);
+    EXPECT_GE(timer.elapsed(), 150);
+  }
+
+  TEST(WaylandOutputManagerTest, ApplyAgainstAnOutdatedSerialIsCancelled) {
+    auto server     = MockOutputManagementServer {};
+    auto id         = server.addHead(makeMockHead("manager-outdated"));
+    auto connection = MockOutputManagerConnection(server);
+
+    // The head changes on the server after the configuration was created, but before it is applied
+    auto configuration = connection.manager()->configure();
+    auto state         = server.head(id);
+    state.scale        = 2.0;
+    server.updateHead(id, state);
+
+    auto meta_head = connection.manager()->getOutputHead(QString("manager-outdated"));
+    auto head      = configuration->enable(meta_head.data());
+    head->setPosition(50, 50);
+
+    auto result = ApplyResult::Pending;
+    QObject::connect(configuration.data(), &WaylandOutputConfiguration::succeeded, [&result]() { result = ApplyResult::Succeeded; });
+    QObject::connect(configuration.data(), &WaylandOutputConfiguration::cancelled, [&result]() { result = ApplyResult::Cancelled; });
+    configuration->applySelf();
+    wl_display_flush(connection.display());
+
+    ASSERT_TRUE(connection.waitFor([&result]() { return result != ApplyResult::Pending; }));
+    EXPECT_EQ(result, ApplyResult::Cancelled);
+  }
+
+  TEST(WaylandOutputManagerTest, EventThreadCommitsOnTheMainThread) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("manager-threaded-1"));
+    auto connection = MockOutputManagerConnection(server, true);
+    ASSERT_EQ(connection.manager()->getHeads().size(), 1);
+
+    server.addHead(makeMockHead("manager-threaded-2", QPoint {1920, 0}));
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getHeads().size(), 2);
+
+    // Head wrappers are created on the event thread, but belong to the main thread that commits and destroys them
+    auto head = connection.manager()->getOutputHead(QString("manager-threaded-2"));
+    EXPECT_EQ(head->getHead()->thread(), QThread::currentThread());
+
+    // The configuration is answered on the main thread, from the default queue
+    auto request          = applyPosition(connection, "manager-threaded-2", QPoint {3840, 0});
+    auto answering_thread = static_cast<QThread*>(nullptr);
+    QObject::connect(request->configuration.data(), &WaylandOutputConfiguration::succeeded,
+                     [&answering_thread]() { answering_thread = QThread::currentThread(); });
+    ASSERT_TRUE(connection.waitFor([&request]() { return request->result != ApplyResult::Pending; }));
+    EXPECT_EQ(request->result, ApplyResult::Succeeded);
+    EXPECT_EQ(answering_thread, QThread::currentThread());
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(head->getPosition(), QPoint(3840, 0));
+  }
+
+  // More transactions than the event thread can hand over while the main thread isn't looking. The event thread waits for room rather than
+  // dropping or spinning, and every transaction is committed once the main thread catches up.
+  TEST(WaylandOutputManagerTest, EventThreadWaitsForTheMainThreadToCatchUp) {
+    auto server     = MockOutputManagementServer {};
+    auto id         = server.addHead(makeMockHead("manager-backlog"));
+    auto connection = MockOutputManagerConnection(server, true);
+    auto done_count = connection.doneCount();
+
+    auto state = server.head(id);
+    for (auto x = 1; x <= 64; ++x) {
+      state.position = QPoint {x, 0};
+      server.updateHead(id, state);
+    }
+
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getOutputHead(QString("manager-backlog"))->getPosition(), QPoint(64, 0));
+    EXPECT_GT(connection.doneCount(), done_count);
+  }
+}
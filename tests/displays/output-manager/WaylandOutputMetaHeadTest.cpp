@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <QStringList>
+
+#include "displays/output-manager/head/WaylandOutputMetaHead.hpp"
+
+namespace bd::testing {
+  namespace {
+    // identify returns a snapshot announcing these identifying properties, as the first transaction for a head without a serial does
+    WaylandOutputHeadSnapshot identify(const QString& name, const QString& make, const QString& model) {
+      auto snapshot  = WaylandOutputHeadSnapshot {};
+      snapshot.name  = name;
+      snapshot.make  = make;
+      snapshot.model = model;
+      snapshot.markChanged(WaylandOutputMetaHeadProperty::Name);
+      snapshot.markChanged(WaylandOutputMetaHeadProperty::Make);
+      snapshot.markChanged(WaylandOutputMetaHeadProperty::Model);
+      return snapshot;
+    }
+
+    // IdentifierChanges records every identifierChanged a head emits
+    struct IdentifierChanges {
+        QStringList previous;
+        QStringList current;
+
+        explicit IdentifierChanges(WaylandOutputMetaHead& head) {
+          QObject::connect(&head, &WaylandOutputMetaHead::identifierChanged, [this](const QString& from, const QString& to) {
+            previous.append(from);
+            current.append(to);
+          });
+        }
+    };
+  }
+
+  TEST(WaylandOutputMetaHeadTest, BuildsTheIdentifierFromTheFirstCommit) {
+    auto head    = WaylandOutputMetaHead(nullptr, nullptr);
+    auto changes = IdentifierChanges(head);
+    head.commit(identify("DP-meta-first", "Budgie", "Mock"));
+
+    EXPECT_EQ(head.getIdentifier(), WaylandOutputMetaHead::generateIdentifier(QString(), "Budgie", "Mock", "DP-meta-first"));
+    EXPECT_EQ(head.getOutputId(), OutputIdTable::instance().find(head.getIdentifier()));
+    EXPECT_TRUE(changes.current.isEmpty());
+  }
+
+  // The compositor can re-announce a property with the value it already had, which mustn't count as a change
+  TEST(WaylandOutputMetaHeadTest, KeepsTheIdentifierWhenPropertiesAreReannounced) {
+    auto head = WaylandOutputMetaHead(nullptr, nullptr);
+    head.commit(identify("DP-meta-same", "Budgie", "Mock"));
+    auto identifier = head.getIdentifier();
+    auto changes    = IdentifierChanges(head);
+
+    head.commit(identify("DP-meta-same", "Budgie", "Mock"));
+    EXPECT_EQ(head.getIdentifier(), identifier);
+    EXPECT_TRUE(changes.current.isEmpty());
+  }
+
+  TEST(WaylandOutputMetaHeadTest, RebuildsTheIdentifierWhenAPropertyChanges) {
+    auto head = WaylandOutputMetaHead(nullptr, nullptr);
+    head.commit(identify("DP-meta-changed", "Budgie", "Mock"));
+    auto previous = head.getIdentifier();
+    auto changes  = IdentifierChanges(head);
+
+    auto snapshot  = WaylandOutputHeadSnapshot {};
+    snapshot.model = "Mock II";
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::Model);
+    head.commit(snapshot);
+
+    auto current = WaylandOutputMetaHead::generateIdentifier(QString(), "Budgie", "Mock II", "DP-meta-changed");
+    EXPECT_EQ(head.getIdentifier(), current);
+    EXPECT_EQ(head.getOutputId(), OutputIdTable::instance().find(current));
+    EXPECT_EQ(changes.previous, QStringList {previous});
+    EXPECT_EQ(changes.current, QStringList {current});
+
+    // A serial takes over from everything else
+    snapshot        = WaylandOutputHeadSnapshot {};
+    snapshot.serial = "meta-changed-serial";
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::SerialNumber);
+    head.commit(snapshot);
+    EXPECT_EQ(head.getIdentifier(), "meta-changed-serial");
+    EXPECT_EQ(changes.current, (QStringList {current, "meta-changed-serial"}));
+  }
+
+  // The output manager works out a new head's identifier to look for an existing meta head, then hands it over rather than have the new one
+  // generate it again
+  TEST(WaylandOutputMetaHeadTest, UsesTheIdentifierItIsGiven) {
+    auto head       = WaylandOutputMetaHead(nullptr, nullptr);
+    auto snapshot   = identify("DP-meta-given", "Budgie", "Mock");
+    auto identifier = WaylandOutputMetaHead::generateIdentifier(QString(), snapshot.make, snapshot.model, snapshot.name);
+    head.commit(snapshot, identifier);
+    EXPECT_EQ(head.getIdentifier(), identifier);
+
+    // Once we have one, a commit that doesn't change what it is derived from leaves it alone whatever it is given
+    head.commit(snapshot, "meta-given-ignored");
+    EXPECT_EQ(head.getIdentifier(), identifier);
+  }
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "displays/output-manager/head/WaylandOutputHeadSnapshot.hpp"
+#include "displays/output-manager/mode/WaylandOutputModeIndex.hpp"
+#include "displays/output-manager/mode/WaylandOutputModeTable.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Tolerance = WaylandOutputMetaHead::MaxRefreshDelta;
+
+    WaylandOutputModeKey key(int width, int height, qulonglong refresh) {
+      return WaylandOutputModeKey {width, height, refresh};
+    }
+  }
+
+  TEST(WaylandOutputModeIndexTest, FindsExactKeysOnly) {
+    auto index = WaylandOutputModeIndex {};
+    ASSERT_TRUE(index.insert(key(1920, 1080, 60000), 0));
+    ASSERT_TRUE(index.insert(key(1920, 1080, 144000), 1));
+    ASSERT_TRUE(index.insert(key(2560, 1440, 60000), 2));
+
+    EXPECT_EQ(index.find(key(1920, 1080, 60000)), 0u);
+    EXPECT_EQ(index.find(key(1920, 1080, 144000)), 1u);
+    EXPECT_EQ(index.find(key(2560, 1440, 60000)), 2u);
+    EXPECT_FALSE(index.find(key(1920, 1080, 59940)).has_value());
+    EXPECT_FALSE(index.find(key(1080, 1920, 60000)).has_value());
+  }
+
+  // A config written as 60 Hz asks for 60000 mHz, which panels commonly advertise as 59940
+  TEST(WaylandOutputModeIndexTest, FindsA59940ModeForA60HzConfig) {
+    auto index = WaylandOutputModeIndex {};
+    index.insert(key(1920, 1080, 59940), 0);
+    index.insert(key(1920, 1080, 50000), 1);
+
+    EXPECT_FALSE(index.find(key(1920, 1080, 60000)).has_value());
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 0u);
+    // Nothing of another size comes close
+    EXPECT_FALSE(index.findNearest(2560, 1440, 60000, Tolerance).has_value());
+  }
+
+  TEST(WaylandOutputModeIndexTest, TolerancesAreInclusive) {
+    auto index = WaylandOutputModeIndex {};
+    index.insert(key(1920, 1080, 59000), 0);
+    index.insert(key(1920, 1080, 75001), 1);
+
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, 1000), 0u);
+    EXPECT_FALSE(index.findNearest(1920, 1080, 60001, 1000).has_value());
+    EXPECT_FALSE(index.findNearest(1920, 1080, 74000, 1000).has_value());
+    EXPECT_EQ(index.findNearest(1920, 1080, 74001, 1000), 1u);
+    EXPECT_FALSE(index.findNearest(1920, 1080, 60000, 0).has_value());
+  }
+
+  // When two refreshes are just as far from the one asked for, the higher wins
+  TEST(WaylandOutputModeIndexTest, TiesGoToTheHigherRefresh) {
+    auto index = WaylandOutputModeIndex {};
+    index.insert(key(1920, 1080, 59000), 0);
+    index.insert(key(1920, 1080, 61000), 1);
+    index.insert(key(1920, 1080, 59500), 2);
+
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 2u);
+    index.remove(key(1920, 1080, 59500), 2);
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 1u);
+  }
+
+  // Refreshes either side of every mode, which only have a neighbour on one side
+  TEST(WaylandOutputModeIndexTest, FindsNeighboursAtEitherEnd) {
+    auto index = WaylandOutputModeIndex {};
+    index.insert(key(1920, 1080, 60000), 0);
+    index.insert(key(1920, 1080, 144000), 1);
+
+    EXPECT_EQ(index.findNearest(1920, 1080, 59500, Tolerance), 0u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 144900, Tolerance), 1u);
+    EXPECT_FALSE(index.findNearest(1920, 1080, 100000, Tolerance).has_value());
+  }
+
+  TEST(WaylandOutputModeIndexTest, KeepsUpAsModesComeAndGo) {
+    auto index = WaylandOutputModeIndex {};
+    index.insert(key(1920, 1080, 59940), 0);
+    index.insert(key(1920, 1080, 120000), 1);
+
+    index.remove(key(1920, 1080, 59940), 0);
+    EXPECT_FALSE(index.find(key(1920, 1080, 59940)).has_value());
+    EXPECT_FALSE(index.findNearest(1920, 1080, 60000, Tolerance).has_value());
+    EXPECT_EQ(index.find(key(1920, 1080, 120000)), 1u);
+
+    // Back in another slot, as a row freed earlier would be reused
+    ASSERT_TRUE(index.insert(key(1920, 1080, 59940), 4));
+    EXPECT_EQ(index.find(key(1920, 1080, 59940)), 4u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 4u);
+
+    // Emptying a size entirely leaves nothing behind to match against
+    index.remove(key(1920, 1080, 59940), 4);
+    index.remove(key(1920, 1080, 120000), 1);
+    EXPECT_FALSE(index.findNearest(1920, 1080, 120000, Tolerance).has_value());
+
+    index.insert(key(1280, 720, 60000), 5);
+    index.clear();
+    EXPECT_FALSE(index.find(key(1280, 720, 60000)).has_value());
+  }
+
+  // A compositor can advertise two modes that look the same. The first stays the one found until it goes, then the other takes over.
+  TEST(WaylandOutputModeIndexTest, KeepsTrackOfSlotsSharingAKey) {
+    auto index = WaylandOutputModeIndex {};
+    ASSERT_TRUE(index.insert(key(1920, 1080, 60000), 0));
+    EXPECT_FALSE(index.insert(key(1920, 1080, 60000), 1));
+    index.insert(key(1920, 1080, 59000), 2);
+    index.insert(key(1920, 1080, 59000), 3);
+    EXPECT_EQ(index.find(key(1920, 1080, 60000)), 0u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 0u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 59500, Tolerance), 0u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 59400, Tolerance), 2u);
+
+    index.remove(key(1920, 1080, 60000), 0);
+    EXPECT_EQ(index.find(key(1920, 1080, 60000)), 1u);
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 1u);
+
+    // Removing the one that isn't found leaves the one that is
+    index.remove(key(1920, 1080, 59000), 3);
+    EXPECT_EQ(index.find(key(1920, 1080, 59000)), 2u);
+    index.remove(key(1920, 1080, 60000), 1);
+    EXPECT_FALSE(index.find(key(1920, 1080, 60000)).has_value());
+    EXPECT_EQ(index.findNearest(1920, 1080, 60000, Tolerance), 2u);
+  }
+
+  // Rows left without a protocol object (as after a reconnect) are taken over by a mode that looks the same, which brings its own flags along
+  TEST(WaylandOutputModeIndexTest, TableReusesRowsLeftWithoutAMode) {
+    auto table   = WaylandOutputModeTable {};
+    auto first   = table.add(WaylandOutputModeSnapshot {.size = QSize {1920, 1080}, .refresh = 60000, .preferred = true});
+    table.unsetModes();
+    auto readded = table.add(WaylandOutputModeSnapshot {.size = QSize {1920, 1080}, .refresh = 60000, .preferred = false});
+    EXPECT_EQ(readded, first);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_FALSE(readded.isPreferred());
+  }
+
+  // The same through a meta head fed by the mock compositor, whose index has to keep up as modes are finished and advertised again
+  TEST(WaylandOutputModeIndexTest, MetaHeadMatchesConfiguredModesAsTheyChange) {
+    auto server        = MockOutputManagementServer {};
+    auto state         = makeMockHead("mode-index");
+    state.modes        = {MockMode {1920, 1080, 59940, true}, MockMode {1280, 720, 60000, false}};
+    state.current_mode = 0;
+    auto id            = server.addHead(state);
+    auto connection    = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+
+    auto head = connection.manager()->getOutputHead(QString("mode-index"));
+    ASSERT_FALSE(head.isNull());
+    auto mode = head->getModeForOutputHead(1920, 1080, 60000);
+    ASSERT_FALSE(mode.isNull());
+    EXPECT_EQ(mode.getRefresh().value_or(0), 59940u);
+    EXPECT_EQ(head->getModeForOutputHead(1280, 720, 60000).getSize().value_or(QSize {}), QSize(1280, 720));
+    EXPECT_TRUE(head->getModeForOutputHead(1920, 1080, 61000).isNull());
+
+    // The compositor drops the 1920x1080 mode, re-advertising the other
+    state.modes        = {MockMode {1280, 720, 60000, true}};
+    state.current_mode = 0;
+    server.updateHead(id, state);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_TRUE(mode.isNull());
+    EXPECT_TRUE(head->getModeForOutputHead(1920, 1080, 60000).isNull());
+    EXPECT_EQ(head->getModeForOutputHead(1280, 720, 60000).getSize().value_or(QSize {}), QSize(1280, 720));
+    EXPECT_EQ(head->getModes().size(), 1);
+
+    // And brings it back
+    state.modes        = {MockMode {1920, 1080, 59940, true}, MockMode {1280, 720, 60000, false}};
+    state.current_mode = 0;
+    server.updateHead(id, state);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(head->getModeForOutputHead(1920, 1080, 60000).getRefresh().value_or(0), 59940u);
+    EXPECT_EQ(head->getModeForOutputHead(1280, 720, 60000).getSize().value_or(QSize {}), QSize(1280, 720));
+    EXPECT_EQ(head->getModes().size(), 2);
+  }
+
+  // Two modes that look the same are both kept while the compositor advertises both, rather than one taking over the other's row
+  TEST(WaylandOutputModeIndexTest, MetaHeadKeepsModesThatLookTheSameApart) {
+    auto server        = MockOutputManagementServer {};
+    auto state         = makeMockHead("mode-twins");
+    state.modes        = {MockMode {1920, 1080, 60000, true}, MockMode {1920, 1080, 60000, false}};
+    state.current_mode = 1;
+    auto id            = server.addHead(state);
+    auto connection    = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+
+    auto head = connection.manager()->getOutputHead(QString("mode-twins"));
+    ASSERT_FALSE(head.isNull());
+    ASSERT_EQ(head->getModes().size(), 2);
+    auto current = head->getCurrentMode();
+    ASSERT_FALSE(current.isNull());
+    EXPECT_FALSE(current.isPreferred());
+    EXPECT_FALSE(head->getModeForOutputHead(1920, 1080, 60000).isNull());
+
+    // Finishing both and advertising one again leaves just that one, still found by what it looks like
+    state.modes        = {MockMode {1920, 1080, 60000, true}};
+    state.current_mode = 0;
+    server.updateHead(id, state);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(head->getModes().size(), 1);
+    EXPECT_TRUE(head->getModeForOutputHead(1920, 1080, 60000).isPreferred());
+    EXPECT_EQ(head->getCurrentMode(), head->getModeForOutputHead(1920, 1080, 60000));
+    EXPECT_TRUE(connection.waitFor([&server]() { return server.liveModeResources() == 1; }));
+  }
+}
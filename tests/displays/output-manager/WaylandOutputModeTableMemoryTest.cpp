@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <QObject>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+#include "CountedAllocations.hpp"
+#include "displays/output-manager/head/WaylandOutputHeadSnapshot.hpp"
+#include "displays/output-manager/mode/WaylandOutputModeTable.hpp"
+
+namespace bd::testing {
+  // BoxedMetaMode and BoxedModeList rebuild how a head stored its modes before the mode table: a QObject per mode, parented to the head and
+  // shared through a QSharedPointer, with its id formatted up front and the mode index holding shared pointers. They only exist as a baseline.
+  class BoxedMetaMode : public QObject {
+      Q_OBJECT
+
+    public:
+      BoxedMetaMode(QObject* parent, const WaylandOutputModeSnapshot& mode)
+          : QObject(parent), m_mode(mode.mode), m_size(mode.size), m_refresh(mode.refresh), m_preferred(mode.preferred), m_is_available(true) {
+        m_id = QString("%1_%2_%3").arg(m_size.width()).arg(m_size.height()).arg(m_refresh);
+      }
+
+    signals:
+      void modeNoLongerAvailable();
+
+    private:
+      QSharedPointer<WaylandOutputMode> m_mode;
+      QString                           m_id;
+      QSize                             m_size;
+      qulonglong                        m_refresh;
+      std::optional<bool>               m_preferred;
+      std::optional<bool>               m_is_available;
+  };
+
+  class BoxedModeList {
+    public:
+      explicit BoxedModeList(QObject* head) : m_head(head) {}
+
+      void add(const WaylandOutputModeSnapshot& mode) {
+        auto meta_mode = QSharedPointer<BoxedMetaMode>(new BoxedMetaMode(m_head, mode));
+        m_modes.append(meta_mode);
+        m_index.insert(WaylandOutputModeKey {mode.size.width(), mode.size.height(), mode.refresh}, meta_mode);
+        auto size_key = (static_cast<quint64>(static_cast<quint32>(mode.size.width())) << 32) | static_cast<quint32>(mode.size.height());
+        m_refreshes_by_size[size_key].append(RefreshEntry {mode.refresh, meta_mode});
+      }
+
+    private:
+      struct RefreshEntry {
+          qulonglong                    refresh;
+          QSharedPointer<BoxedMetaMode> mode;
+      };
+
+      QObject*                                                   m_head;
+      QList<QSharedPointer<BoxedMetaMode>>                       m_modes;
+      QHash<WaylandOutputModeKey, QSharedPointer<BoxedMetaMode>> m_index;
+      QHash<quint64, QList<RefreshEntry>>                        m_refreshes_by_size;
+  };
+
+  namespace {
+    // A video wall node: 8 outputs advertising 150 modes each, 50 sizes at 3 refresh rates
+    constexpr auto Outputs        = 8;
+    constexpr auto Sizes          = 50;
+    constexpr auto RefreshRates   = std::array {60000ull, 120000ull, 144000ull};
+    constexpr auto ModesPerOutput = Sizes * static_cast<int>(RefreshRates.size());
+
+    // The modes one output advertises. Without a compositor they have no protocol object behind them, which both sides tolerate.
+    QList<WaylandOutputModeSnapshot> advertisedModes() {
+      auto modes = QList<WaylandOutputModeSnapshot> {};
+      for (auto index = 0; index < Sizes; ++index) {
+        for (auto refresh : RefreshRates) {
+          modes.append(WaylandOutputModeSnapshot {.size = QSize {640 + index * 32, 480 + index * 18}, .refresh = refresh, .preferred = index == 0});
+        }
+      }
+      return modes;
+    }
+
+    struct Footprint {
+        size_t allocations;
+        qint64 bytes;
+    };
+
+    void report(const char* name, const Footprint& footprint) {
+      constexpr auto Modes = Outputs * ModesPerOutput;
+      std::cout << name << ": " << footprint.allocations << " allocations and " << footprint.bytes << " bytes for " << Modes << " modes ("
+                << footprint.bytes / Modes << " bytes per mode)" << std::endl;
+      ::testing::Test::RecordProperty(std::string(name) + "Allocations", static_cast<int>(footprint.allocations));
+      ::testing::Test::RecordProperty(std::string(name) + "Bytes", static_cast<int>(footprint.bytes));
+    }
+  }
+
+  // Measures what it takes to hold every mode of a video wall node, in the mode table and in a QObject per mode. The figures are printed and
+  // recorded as test properties, the assertions only check the table is the smaller of the two.
+  TEST(WaylandOutputModeTableMemoryTest, TableIsSmallerThanAQObjectPerMode) {
+    if (!CountedAllocations::isTrackingBytes()) GTEST_SKIP() << "heap growth is only tracked on glibc";
+
+    auto modes = advertisedModes();
+    auto heads = std::array<QObject, Outputs> {};
+
+    auto table = Footprint {};
+    {
+      auto tables  = std::make_unique<std::array<WaylandOutputModeTable, Outputs>>();
+      auto counted = CountedAllocations {};
+      for (auto& output : *tables) {
+        for (const auto& mode : modes) output.add(mode);
+      }
+      table = Footprint {counted.count(), counted.liveBytes()};
+      ASSERT_EQ(tables->front().size(), ModesPerOutput);
+    }
+
+    auto boxed = Footprint {};
+    {
+      auto lists = QList<BoxedModeList> {};
+      lists.reserve(Outputs);
+      for (auto& head : heads) lists.append(BoxedModeList(&head));
+
+      auto counted = CountedAllocations {};
+      for (auto& list : lists) {
+        for (const auto& mode : modes) list.add(mode);
+      }
+      boxed = Footprint {counted.count(), counted.liveBytes()};
+    }
+
+    report("ModeTable", table);
+    report("QObjectPerMode", boxed);
+    EXPECT_LT(table.allocations, boxed.allocations);
+    EXPECT_LT(table.bytes, boxed.bytes);
+  }
+}
+
+#include "WaylandOutputModeTableMemoryTest.moc"
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "config/display.hpp"
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+using namespace std::chrono_literals;
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Socket = "budgie-tombstone-test";
+
+    // moveHead has the compositor move a head, which is enough to have it send a done
+    void moveHead(MockOutputManagementServer& server, quint32 id, QPoint position) {
+      auto state     = server.head(id);
+      state.position = position;
+      server.updateHead(id, state);
+    }
+
+    // waitUntil runs the event loop (which is where the orchestrator dispatches the display) until condition holds
+    bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout = 10s) {
+      auto timer = QElapsedTimer {};
+      timer.start();
+      while (!condition()) {
+        if (timer.elapsed() > timeout.count()) return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        std::this_thread::sleep_for(1ms);
+      }
+      return true;
+    }
+
+    // MatchingConfig is a display config with groups of our own instead of whatever display-config.toml holds
+    class MatchingConfig : public DisplayConfig {
+      public:
+        MatchingConfig() : DisplayConfig(nullptr) {}
+
+        DisplayGroup* addGroup(const QStringList& identifiers) {
+          auto group = new DisplayGroup(this);
+          group->setOutputIdentifiers(identifiers);
+          group->setPreferred(true);
+          m_groups.append(group);
+          return group;
+        }
+    };
+  }
+
+  // An output that is unplugged and plugged back in comes back as the meta head it was, with what we set on it outside of the protocol
+  TEST(WaylandOutputTombstoneTest, RevivesTheSameHeadWhenItComesBack) {
+    auto server     = MockOutputManagementServer {};
+    auto id         = server.addHead(makeMockHead("tombstone-revive"));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+
+    auto head = connection.manager()->getOutputHead(QString("tombstone-revive"));
+    ASSERT_FALSE(head.isNull());
+    head->setPrimary(true);
+    auto output_id = head->getOutputId();
+
+    server.removeHead(id);
+    ASSERT_TRUE(connection.sync());
+    EXPECT_FALSE(head->isAvailable());
+    EXPECT_TRUE(connection.manager()->getOutputHead(output_id).isNull());
+    EXPECT_TRUE(connection.manager()->getHeads().isEmpty());
+    ASSERT_NE(connection.manager()->getTopology()->getHead(output_id), nullptr);
+    EXPECT_FALSE(connection.manager()->getTopology()->getHead(output_id)->available);
+
+    server.addHead(makeMockHead("tombstone-revive"));
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getOutputHead(output_id), head);
+    EXPECT_TRUE(head->isAvailable());
+    EXPECT_EQ(head->getUnavailableFor(), -1);
+    EXPECT_TRUE(head->isPrimary());
+    EXPECT_EQ(head->getModes().size(), 2);
+    EXPECT_EQ(head->getCurrentMode().getSize().value_or(QSize {}), QSize(1920, 1080));
+    EXPECT_EQ(connection.manager()->getHeads().size(), 1);
+  }
+
+  // A tombstone is only forgotten once it is older than the configured age, and the heads after it are still found where they moved to
+  TEST(WaylandOutputTombstoneTest, CompactsTombstonesOnceTheyAreOldEnough) {
+    auto server     = MockOutputManagementServer {};
+    auto first      = server.addHead(makeMockHead("tombstone-compact-1"));
+    auto second     = server.addHead(makeMockHead("tombstone-compact-2", QPoint {1920, 0}));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+    connection.manager()->setTombstoneMaxAge(1000);
+
+    auto first_id  = OutputIdTable::instance().find("tombstone-compact-1");
+    auto second_id = OutputIdTable::instance().find("tombstone-compact-2");
+    auto tombstone = connection.manager()->getOutputHead(first_id);
+    auto survivor  = connection.manager()->getOutputHead(second_id);
+    ASSERT_FALSE(tombstone.isNull());
+    ASSERT_FALSE(survivor.isNull());
+
+    server.removeHead(first);
+    moveHead(server, second, QPoint {0, 0});
+    ASSERT_TRUE(connection.sync());
+    EXPECT_NE(connection.manager()->getTopology()->getHead(first_id), nullptr);
+
+    std::this_thread::sleep_for(1100ms);
+    moveHead(server, second, QPoint {1920, 0});
+    ASSERT_TRUE(connection.sync());
+    EXPECT_EQ(connection.manager()->getTopology()->getHead(first_id), nullptr);
+    EXPECT_EQ(connection.manager()->getTopology()->getHeads().size(), 1);
+    EXPECT_EQ(connection.manager()->getOutputHead(second_id), survivor);
+    EXPECT_EQ(survivor->getPosition(), QPoint(1920, 0));
+
+    // Once forgotten, the output coming back is a head we have never seen
+    server.addHead(makeMockHead("tombstone-compact-1"));
+    ASSERT_TRUE(connection.sync());
+    auto returned = connection.manager()->getOutputHead(first_id);
+    ASSERT_FALSE(returned.isNull());
+    EXPECT_NE(returned, tombstone);
+    EXPECT_EQ(connection.manager()->getOutputHead(second_id), survivor);
+    EXPECT_EQ(connection.manager()->getHeads().size(), 2);
+  }
+
+  // Group matching goes through the orchestrator's manager, so this one connects it to the mock compositor like the daemon would
+  TEST(WaylandOutputTombstoneTest, GroupMatchingIgnoresTombstones) {
+    auto runtime_dir = QTemporaryDir {};
+    ASSERT_TRUE(runtime_dir.isValid());
+    qputenv("XDG_RUNTIME_DIR", runtime_dir.path().toUtf8());
+    qputenv("WAYLAND_DISPLAY", Socket);
+
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("tombstone-group-1"));
+    auto second = server.addHead(makeMockHead("tombstone-group-2", QPoint {1920, 0}));
+    ASSERT_TRUE(server.addSocket(Socket));
+
+    auto& orchestrator = WaylandOrchestrator::instance();
+    auto  ready        = false;
+    auto  dones        = 0;
+    QObject::connect(&orchestrator, &WaylandOrchestrator::ready, [&ready]() { ready = true; });
+    QObject::connect(&orchestrator, &WaylandOrchestrator::done, [&dones]() { dones++; });
+    orchestrator.init();
+    ASSERT_TRUE(waitUntil([&ready]() { return ready; }));
+
+    auto config = MatchingConfig {};
+    auto both   = config.addGroup({"tombstone-group-1", "tombstone-group-2"});
+    auto alone  = config.addGroup({"tombstone-group-1"});
+    EXPECT_EQ(config.getMatchingGroup(), std::optional<DisplayGroup*> {both});
+
+    auto before = dones;
+    server.removeHead(second);
+    ASSERT_TRUE(waitUntil([&before, &dones]() { return dones > before; }));
+    EXPECT_EQ(config.getMatchingGroup(), std::optional<DisplayGroup*> {alone});
+  }
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  namespace {
+    constexpr auto Min = std::numeric_limits<int>::min();
+    constexpr auto Max = std::numeric_limits<int>::max();
+
+    // identifiersIn lists the identifiers of the heads the topology finds in rect, in the order it returns them
+    QStringList identifiersIn(const WaylandOutputTopology& topology, const QRect& rect) {
+      auto identifiers = QStringList {};
+      for (const auto& head : topology.getHeadsIn(rect)) identifiers.append(head->identifier);
+      return identifiers;
+    }
+
+    QString identifierAt(const WaylandOutputTopology& topology, const QPoint& point) {
+      auto head = topology.getHeadAt(point);
+      return head ? head->identifier : QString();
+    }
+  }
+
+  // Geometry is inclusive of its last column and row, and nothing past them
+  TEST(WaylandOutputTopologyTest, FindsHeadsUpToTheirEdgePixels) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("topology-left"));
+    server.addHead(makeMockHead("topology-right", QPoint {1920, 0}));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+    auto topology = connection.manager()->getTopology();
+
+    EXPECT_EQ(identifierAt(*topology, QPoint(0, 0)), "topology-left");
+    EXPECT_EQ(identifierAt(*topology, QPoint(1919, 1079)), "topology-left");
+    EXPECT_EQ(identifierAt(*topology, QPoint(1920, 0)), "topology-right");
+    EXPECT_EQ(identifierAt(*topology, QPoint(3839, 1079)), "topology-right");
+    EXPECT_TRUE(identifierAt(*topology, QPoint(3840, 0)).isNull());
+    EXPECT_TRUE(identifierAt(*topology, QPoint(0, 1080)).isNull());
+    EXPECT_TRUE(identifierAt(*topology, QPoint(-1, 0)).isNull());
+
+    EXPECT_EQ(identifiersIn(*topology, QRect(1919, 0, 2, 1)), (QStringList {"topology-left", "topology-right"}));
+    EXPECT_EQ(identifiersIn(*topology, QRect(1920, 1079, 1, 1)), QStringList {"topology-right"});
+    EXPECT_TRUE(identifiersIn(*topology, QRect(0, 1080, 3840, 10)).isEmpty());
+    EXPECT_TRUE(identifiersIn(*topology, QRect(0, 0, 0, 0)).isEmpty());
+  }
+
+  // A head's logical size is its mode scaled down, turned on its side by the transforms that rotate by 90 or 270 degrees
+  TEST(WaylandOutputTopologyTest, ScalesAndRotatesGeometry) {
+    auto server       = MockOutputManagementServer {};
+    auto scaled       = makeMockHead("topology-scaled");
+    scaled.modes      = {MockMode {3840, 2160, 60000, true}};
+    scaled.scale      = 2.0;
+    auto rotated      = makeMockHead("topology-rotated", QPoint {1920, 0});
+    rotated.transform = 3;
+    auto flipped      = makeMockHead("topology-flipped", QPoint {3000, 0});
+    flipped.transform = 6;
+    flipped.scale     = 1.5;
+    server.addHead(scaled);
+    server.addHead(rotated);
+    server.addHead(flipped);
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+    auto topology = connection.manager()->getTopology();
+
+    auto geometryOf = [&topology](const char* identifier) { return topology->getHead(OutputIdTable::instance().find(identifier))->geometry; };
+    EXPECT_EQ(geometryOf("topology-scaled"), QRect(0, 0, 1920, 1080));
+    EXPECT_EQ(geometryOf("topology-rotated"), QRect(1920, 0, 1080, 1920));
+    EXPECT_EQ(geometryOf("topology-flipped"), QRect(3000, 0, 1280, 720));
+
+    EXPECT_EQ(identifierAt(*topology, QPoint(1919, 1079)), "topology-scaled");
+    EXPECT_TRUE(identifierAt(*topology, QPoint(1919, 1080)).isNull());
+    EXPECT_EQ(identifierAt(*topology, QPoint(2999, 1919)), "topology-rotated");
+    EXPECT_TRUE(identifierAt(*topology, QPoint(2999, 1920)).isNull());
+    EXPECT_EQ(identifierAt(*topology, QPoint(4279, 719)), "topology-flipped");
+    EXPECT_TRUE(identifierAt(*topology, QPoint(4280, 0)).isNull());
+    EXPECT_EQ(identifiersIn(*topology, QRect(2000, 1000, 2000, 10)), QStringList {"topology-rotated"});
+  }
+
+  // Mirrored heads cover the same area. A point in it belongs to the one we saw first, a rect over it finds both.
+  TEST(WaylandOutputTopologyTest, MirroredHeadsOverlap) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("topology-mirror-1"));
+    server.addHead(makeMockHead("topology-mirror-2"));
+    server.addHead(makeMockHead("topology-mirror-3", QPoint {960, 0}));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+    auto topology = connection.manager()->getTopology();
+
+    EXPECT_EQ(identifierAt(*topology, QPoint(100, 100)), "topology-mirror-1");
+    EXPECT_EQ(identifierAt(*topology, QPoint(1919, 1079)), "topology-mirror-1");
+    EXPECT_EQ(identifierAt(*topology, QPoint(1920, 0)), "topology-mirror-3");
+    EXPECT_EQ(identifiersIn(*topology, QRect(0, 0, 10, 10)), (QStringList {"topology-mirror-1", "topology-mirror-2"}));
+    EXPECT_EQ(identifiersIn(*topology, QRect(1000, 0, 10, 10)), (QStringList {"topology-mirror-1", "topology-mirror-2", "topology-mirror-3"}));
+  }
+
+  // Heads and queries at the very ends of the coordinate space must neither overflow nor wrap around to the other end
+  TEST(WaylandOutputTopologyTest, HandlesExtremeCoordinates) {
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("topology-far-left", QPoint {Min, Min}));
+    server.addHead(makeMockHead("topology-far-right", QPoint {Max - 999, Max - 99}));
+    auto connection = MockOutputManagerConnection(server);
+    ASSERT_TRUE(connection.sync());
+    auto topology = connection.manager()->getTopology();
+
+    // The head at the far end is cut off at the edge of the coordinate space
+    auto far_right = topology->getHead(OutputIdTable::instance().find("topology-far-right"));
+    ASSERT_NE(far_right, nullptr);
+    EXPECT_EQ(far_right->geometry.topLeft(), QPoint(Max - 999, Max - 99));
+    EXPECT_EQ(far_right->geometry.bottomRight(), QPoint(Max, Max));
+
+    EXPECT_EQ(identifierAt(*topology, QPoint(Min, Min)), "topology-far-left");
+    EXPECT_EQ(identifierAt(*topology, QPoint(Max, Max)), "topology-far-right");
+    EXPECT_TRUE(identifierAt(*topology, QPoint(Max, Min)).isNull());
+    EXPECT_TRUE(identifierAt(*topology, QPoint(Min, Max)).isNull());
+    EXPECT_TRUE(identifierAt(*topology, QPoint(0, 0)).isNull());
+
+    auto everything = QRect(QPoint(Min, Min), QPoint(Max, Max));
+    EXPECT_EQ(identifiersIn(*topology, everything), (QStringList {"topology-far-left", "topology-far-right"}));
+    EXPECT_EQ(identifiersIn(*topology, QRect(QPoint(Max, Max), QPoint(Max, Max))), QStringList {"topology-far-right"});
+    EXPECT_EQ(identifiersIn(*topology, QRect(QPoint(Min, Min), QPoint(Min, Min))), QStringList {"topology-far-left"});
+    EXPECT_TRUE(identifiersIn(*topology, QRect(QPoint(Min + 1920, Min), QPoint(Max - 1000, Max))).isEmpty());
+  }
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <memory>
+
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "displays/output-manager/WaylandProtocolReplay.hpp"
+#include "mock/MockRecording.hpp"
+
+namespace bd::testing {
+  namespace {
+    // HeadSummary is what a head looks like to the rest of the daemon, enough to tell a replay apart from the session it was recorded from
+    struct HeadSummary {
+        QString    identifier;
+        QString    name;
+        bool       available = false;
+        bool       enabled   = false;
+        QPoint     position;
+        double     scale     = 0;
+        int        transform = 0;
+        qsizetype  modes     = 0;
+        QSize      current_size;
+        qulonglong current_refresh = 0;
+
+        bool operator==(const HeadSummary&) const = default;
+    };
+
+    QList<HeadSummary> summarize(WaylandOutputManager& manager) {
+      auto summaries = QList<HeadSummary> {};
+      for (const auto& head : manager.getHeads()) {
+        auto current = head->getCurrentMode();
+        summaries.append(HeadSummary {
+            .identifier      = head->getIdentifier(),
+            .name            = head->getName(),
+            .available       = head->isAvailable(),
+            .enabled         = head->isEnabled(),
+            .position        = head->getPosition(),
+            .scale           = head->getScale(),
+            .transform       = head->getTransform(),
+            .modes           = head->getModes().size(),
+            .current_size    = current.getSize().value_or(QSize {}),
+            .current_refresh = current.getRefresh().value_or(0),
+        });
+      }
+      return summaries;
+    }
+
+    // Replayed owns a replay of a log and the manager it replays into. The manager is declared last so it goes before the display its proxies
+    // live on.
+    struct Replayed {
+        std::unique_ptr<WaylandProtocolReplay> replay = std::make_unique<WaylandProtocolReplay>();
+        std::unique_ptr<WaylandOutputManager>  manager;
+    };
+
+    std::unique_ptr<Replayed> replay(const QString& path) {
+      auto replayed = std::make_unique<Replayed>();
+      if (!replayed->replay->open(path).isNull()) return nullptr;
+      replayed->manager.reset(replayed->replay->createManager());
+      replayed->replay->run();
+      return replayed;
+    }
+
+    // appendRecords writes records to the end of a log, in the format WaylandProtocolRecorder writes them
+    void appendRecords(const QString& path, const QList<WaylandProtocolRecord>& records) {
+      auto file = QFile(path);
+      ASSERT_TRUE(file.open(QIODevice::Append));
+      auto stream = QDataStream(&file);
+      stream.setByteOrder(QDataStream::LittleEndian);
+      for (const auto& record : records) {
+        stream << record.timestamp << static_cast<quint8>(record.event) << record.object << record.args[0];
+      }
+    }
+
+    QList<WaylandProtocolRecord> readRecords(const QString& path) {
+      auto records = QList<WaylandProtocolRecord> {};
+      auto file    = QFile(path);
+      if (!file.open(QIODevice::ReadOnly)) return records;
+
+      auto stream = QDataStream(&file);
+      if (!WaylandProtocolRecorder::readHeader(stream)) return records;
+      auto record = WaylandProtocolRecord {};
+      while (!stream.atEnd() && WaylandProtocolRecorder::readRecord(stream, record)) records.append(record);
+      return records;
+    }
+  }
+
+  // A session against the mock compositor, with a hotplug, a mode change and a move, replays into the same heads it left the live manager with
+  TEST(WaylandProtocolReplayTest, ReplaysWhatWasRecorded) {
+    auto directory = QTemporaryDir {};
+    ASSERT_TRUE(directory.isValid());
+    auto path = directory.filePath("session.bdwr");
+
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("replay-1"));
+    auto live = QList<HeadSummary> {};
+
+    ASSERT_TRUE(recordAgainstMock(path, server, [&live](MockOutputManagementServer& compositor, MockOutputManagerConnection& connection) {
+      auto id            = compositor.addHead(makeMockHead("replay-2", QPoint {1920, 0}));
+      auto state         = compositor.head(id);
+      state.modes        = {MockMode {2560, 1440, 144000, true}, MockMode {2560, 1440, 59940, false}};
+      state.current_mode = 1;
+      state.scale        = 1.25;
+      state.transform    = 1;
+      compositor.updateHead(id, state);
+
+      auto unplugged = compositor.addHead(makeMockHead("replay-3", QPoint {0, 1080}));
+      compositor.removeHead(unplugged);
+      if (!connection.sync()) return false;
+
+      live = summarize(*connection.manager());
+      return true;
+    }));
+    ASSERT_EQ(live.size(), 2);
+
+    auto replayed = replay(path);
+    ASSERT_NE(replayed, nullptr);
+    EXPECT_EQ(summarize(*replayed->manager), live);
+    EXPECT_EQ(replayed->manager->getSerial(), server.serial());
+  }
+
+  // Production traces can be cut short or refer to modes we never saw announced, which must not take the replay down
+  TEST(WaylandProtocolReplayTest, SkipsACurrentModeItDoesNotKnow) {
+    auto directory = QTemporaryDir {};
+    ASSERT_TRUE(directory.isValid());
+    auto path = directory.filePath("unknown-mode.bdwr");
+
+    auto server = MockOutputManagementServer {};
+    server.addHead(makeMockHead("replay-unknown-mode"));
+    ASSERT_TRUE(recordAgainstMock(path, server, [](MockOutputManagementServer&, MockOutputManagerConnection&) { return true; }));
+
+    auto records = readRecords(path);
+    auto head    = std::find_if(records.cbegin(), records.cend(), [](const auto& record) { return record.event == WaylandProtocolEvent::HeadName; });
+    ASSERT_NE(head, records.cend());
+    auto done = std::find_if(records.cbegin(), records.cend(), [](const auto& record) { return record.event == WaylandProtocolEvent::ManagerDone; });
+    ASSERT_NE(done, records.cend());
+
+    // The head is told its current mode is one that was never announced, then the transaction is done
+    auto unknown_mode    = WaylandProtocolRecord {.event = WaylandProtocolEvent::HeadCurrentMode, .object = head->object};
+    unknown_mode.args[0] = 0xffff;
+    auto next_done       = WaylandProtocolRecord {.event = WaylandProtocolEvent::ManagerDone, .object = done->object};
+    next_done.args[0]    = static_cast<qint32>(server.serial()) + 1;
+    appendRecords(path, {unknown_mode, next_done});
+
+    auto replayed = replay(path);
+    ASSERT_NE(replayed, nullptr);
+    auto meta_head = replayed->manager->getOutputHead(QString("replay-unknown-mode"));
+    ASSERT_FALSE(meta_head.isNull());
+    EXPECT_EQ(meta_head->getCurrentMode().getSize().value_or(QSize {}), QSize(1920, 1080));
+    EXPECT_EQ(replayed->manager->getSerial(), static_cast<uint32_t>(next_done.args[0]));
+  }
+}
@@ -0,0 +1,14 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+
+// Every test binary gets a QCoreApplication, so queued calls and timers behave like they do in the daemon
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  QCoreApplication app(argc, argv);
+
+  // The daemon logs every protocol event at debug level, which would bury the test output
+  QLoggingCategory::setFilterRules("*.debug=false");
+  return RUN_ALL_TESTS();
+}
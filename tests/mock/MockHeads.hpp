@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QPoint>
+#include <QSharedPointer>
+
+#include "displays/output-manager/head/WaylandOutputMetaHead.hpp"
+
+namespace bd::testing {
+  // makeMetaHead builds a meta head without a compositor behind it, committed as if serial was announced enabled at position. It has no
+  // modes, so whatever uses it gets its dimensions from mode actions.
+  inline QSharedPointer<WaylandOutputMetaHead> makeMetaHead(const QString& serial, QPoint position = QPoint {0, 0}) {
+    auto head     = QSharedPointer<WaylandOutputMetaHead>(new WaylandOutputMetaHead(nullptr, nullptr));
+    auto snapshot = WaylandOutputHeadSnapshot {};
+    snapshot.name     = "DP-" + serial;
+    snapshot.serial   = serial;
+    snapshot.enabled  = true;
+    snapshot.position = position;
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::Name);
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::SerialNumber);
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::Enabled);
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::Position);
+    head->commit(snapshot);
+    return head;
+  }
+
+  // moveMetaHead commits a new position for head, as the compositor would after it was moved
+  inline void moveMetaHead(WaylandOutputMetaHead& head, QPoint position) {
+    auto snapshot     = WaylandOutputHeadSnapshot {};
+    snapshot.position = position;
+    snapshot.markChanged(WaylandOutputMetaHeadProperty::Position);
+    head.commit(snapshot);
+  }
+}
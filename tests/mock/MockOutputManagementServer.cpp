@@ -0,0 +1,575 @@
+#include "MockOutputManagementServer.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wayland-server.h>
+
+#include <future>
+
+#include "wayland-wlr-output-management-unstable-v1-server-protocol.h"
+
+namespace bd::testing {
+  const struct zwlr_output_manager_v1_interface MockOutputManagementServer::s_manager_implementation = {
+      .create_configuration = MockOutputManagementServer::managerCreateConfiguration,
+      .stop                 = MockOutputManagementServer::managerStop,
+  };
+
+  const struct zwlr_output_head_v1_interface MockOutputManagementServer::s_head_implementation = {
+      .release = MockOutputManagementServer::release,
+  };
+
+  const struct zwlr_output_mode_v1_interface MockOutputManagementServer::s_mode_implementation = {
+      .release = MockOutputManagementServer::release,
+  };
+
+  const struct zwlr_output_configuration_v1_interface MockOutputManagementServer::s_configuration_implementation = {
+      .enable_head  = MockOutputManagementServer::configurationEnableHead,
+      .disable_head = MockOutputManagementServer::configurationDisableHead,
+      .apply        = MockOutputManagementServer::configurationApply,
+      .test         = MockOutputManagementServer::configurationTest,
+      .destroy      = MockOutputManagementServer::release,
+  };
+
+  const struct zwlr_output_configuration_head_v1_interface MockOutputManagementServer::s_configuration_head_implementation = {
+      .set_mode          = MockOutputManagementServer::configurationHeadSetMode,
+      .set_custom_mode   = MockOutputManagementServer::configurationHeadSetCustomMode,
+      .set_position      = MockOutputManagementServer::configurationHeadSetPosition,
+      .set_transform     = MockOutputManagementServer::configurationHeadSetTransform,
+      .set_scale         = MockOutputManagementServer::configurationHeadSetScale,
+      .set_adaptive_sync = MockOutputManagementServer::configurationHeadSetAdaptiveSync,
+  };
+
+  MockOutputManagementServer::MockOutputManagementServer()
+      : m_display(wl_display_create()),
+        m_loop(wl_display_get_event_loop(m_display)),
+        m_global(nullptr),
+        m_wake_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+        m_running(true),
+        m_next_head_id(1),
+        m_serial(1),
+        m_apply_latency(0),
+        m_apply_outcome(MockApplyOutcome::Succeeded),
+        m_apply_count(0),
+        m_live_heads(0),
+        m_live_modes(0) {
+    m_global = wl_global_create(m_display, &zwlr_output_manager_v1_interface, Version, this, bindManager);
+    wl_event_loop_add_fd(m_loop, m_wake_fd, WL_EVENT_READABLE, handleWake, this);
+    m_thread = std::thread(&MockOutputManagementServer::loop, this);
+  }
+
+  MockOutputManagementServer::~MockOutputManagementServer() {
+    m_running.store(false);
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(m_wake_fd, &one, sizeof(one));
+    m_thread.join();
+
+    wl_display_destroy_clients(m_display);
+    wl_display_destroy(m_display);
+    close(m_wake_fd);
+  }
+
+  void MockOutputManagementServer::loop() {
+    while (m_running.load()) {
+      wl_display_flush_clients(m_display);
+      wl_event_loop_dispatch(m_loop, -1);
+    }
+  }
+
+  // run executes task on the server thread and waits for it to have finished
+  void MockOutputManagementServer::run(const std::function<void()>& task) {
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+      task();
+      return;
+    }
+
+    auto done     = std::promise<void> {};
+    auto finished = done.get_future();
+    {
+      auto lock = std::lock_guard {m_tasks_mutex};
+      m_tasks.append([&task, &done]() {
+        task();
+        done.set_value();
+      });
+    }
+
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(m_wake_fd, &one, sizeof(one));
+    finished.wait();
+  }
+
+  int MockOutputManagementServer::handleWake(int fd, uint32_t, void* data) {
+    auto server = static_cast<MockOutputManagementServer*>(data);
+    uint64_t count = 0;
+    [[maybe_unused]] auto got = read(fd, &count, sizeof(count));
+
+    auto tasks = QList<std::function<void()>> {};
+    {
+      auto lock = std::lock_guard {server->m_tasks_mutex};
+      tasks.swap(server->m_tasks);
+    }
+
+    for (const auto& task : tasks) task();
+    wl_display_flush_clients(server->m_display);
+    return 0;
+  }
+
+  wl_display* MockOutputManagementServer::connectClient() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) return nullptr;
+
+    run([this, &fds]() { wl_client_create(m_display, fds[0]); });
+    return wl_display_connect_to_fd(fds[1]);
+  }
+
+  bool MockOutputManagementServer::addSocket(const QString& name) {
+    auto added = false;
+    run([this, &name, &added]() { added = wl_display_add_socket(m_display, name.toUtf8().constData()) == 0; });
+    return added;
+  }
+
+  // Scripting
+
+  quint32 MockOutputManagementServer::addHead(const MockHead& state) {
+    auto id = quint32 {0};
+    run([this, &state, &id]() {
+      id = m_next_head_id++;
+      m_heads.append(Head {.id = id, .state = state});
+      for (const auto& manager : m_managers) advertiseHead(m_heads.last(), manager);
+      sendDone();
+    });
+    return id;
+  }
+
+  void MockOutputManagementServer::updateHead(quint32 id, const MockHead& state) {
+    run([this, id, &state]() {
+      auto head = findHead(id);
+      if (head == nullptr) return;
+
+      auto previous = head->state;
+      head->state   = state;
+      sendChanges(*head, previous);
+      sendDone();
+    });
+  }
+
+  void MockOutputManagementServer::removeHead(quint32 id) {
+    run([this, id]() {
+      auto head = findHead(id);
+      if (head == nullptr) return;
+
+      finishHead(*head);
+      m_heads.removeIf([id](const Head& head) { return head.id == id; });
+      sendDone();
+    });
+  }
+
+  MockHead MockOutputManagementServer::head(quint32 id) {
+    auto state = MockHead {};
+    run([this, id, &state]() {
+      auto head = findHead(id);
+      if (head != nullptr) state = head->state;
+    });
+    return state;
+  }
+
+  void MockOutputManagementServer::setApplyLatency(std::chrono::milliseconds latency) {
+    run([this, latency]() { m_apply_latency = latency; });
+  }
+
+  void MockOutputManagementServer::setApplyOutcome(MockApplyOutcome outcome) {
+    run([this, outcome]() { m_apply_outcome = outcome; });
+  }
+
+  uint32_t MockOutputManagementServer::serial() {
+    auto serial = uint32_t {0};
+    run([this, &serial]() { serial = m_serial; });
+    return serial;
+  }
+
+  int MockOutputManagementServer::applyCount() {
+    auto count = 0;
+    run([this, &count]() { count = m_apply_count; });
+    return count;
+  }
+
+  int MockOutputManagementServer::liveHeadResources() {
+    auto count = 0;
+    run([this, &count]() { count = m_live_heads; });
+    return count;
+  }
+
+  int MockOutputManagementServer::liveModeResources() {
+    auto count = 0;
+    run([this, &count]() { count = m_live_modes; });
+    return count;
+  }
+
+  // Protocol
+
+  void MockOutputManagementServer::bindManager(wl_client* client, void* data, uint32_t version, uint32_t id) {
+    auto server   = static_cast<MockOutputManagementServer*>(data);
+    auto resource = wl_resource_create(client, &zwlr_output_manager_v1_interface, static_cast<int>(version), id);
+    if (resource == nullptr) {
+      wl_client_post_no_memory(client);
+      return;
+    }
+
+    wl_resource_set_implementation(resource, &s_manager_implementation, server, destroyManager);
+    server->m_managers.append(resource);
+    for (auto& head : server->m_heads) server->advertiseHead(head, resource);
+    zwlr_output_manager_v1_send_done(resource, server->m_serial);
+  }
+
+  void MockOutputManagementServer::managerStop(wl_client*, wl_resource* resource) {
+    zwlr_output_manager_v1_send_finished(resource);
+    wl_resource_destroy(resource);
+  }
+
+  // destroyManager stops sending anything to the heads bound through a manager that has gone, they stay alive until the client releases them
+  void MockOutputManagementServer::destroyManager(wl_resource* resource) {
+    auto server = static_cast<MockOutputManagementServer*>(wl_resource_get_user_data(resource));
+    server->m_managers.removeAll(resource);
+    for (auto& head : server->m_heads) {
+      head.bindings.removeIf([resource](const HeadBinding& binding) { return binding.manager == resource; });
+    }
+  }
+
+  void MockOutputManagementServer::release(wl_client*, wl_resource* resource) {
+    wl_resource_destroy(resource);
+  }
+
+  void MockOutputManagementServer::destroyHead(wl_resource* resource) {
+    auto server = static_cast<MockOutputManagementServer*>(wl_resource_get_user_data(resource));
+    server->m_live_heads--;
+    for (auto& head : server->m_heads) {
+      head.bindings.removeIf([resource](const HeadBinding& binding) { return binding.head == resource; });
+    }
+  }
+
+  void MockOutputManagementServer::destroyMode(wl_resource* resource) {
+    auto server = static_cast<MockOutputManagementServer*>(wl_resource_get_user_data(resource));
+    server->m_live_modes--;
+    for (auto& head : server->m_heads) {
+      for (auto& binding : head.bindings) {
+        auto index = binding.modes.indexOf(resource);
+        if (index >= 0) binding.modes[index] = nullptr;
+      }
+    }
+  }
+
+  void MockOutputManagementServer::advertiseHead(Head& head, wl_resource* manager) {
+    auto client   = wl_resource_get_client(manager);
+    auto version  = wl_resource_get_version(manager);
+    auto resource = wl_resource_create(client, &zwlr_output_head_v1_interface, version, 0);
+    if (resource == nullptr) {
+      wl_client_post_no_memory(client);
+      return;
+    }
+
+    wl_resource_set_implementation(resource, &s_head_implementation, this, destroyHead);
+    m_live_heads++;
+    head.bindings.append(HeadBinding {.manager = manager, .head = resource});
+    zwlr_output_manager_v1_send_head(manager, resource);
+
+    // Everything differs from a default constructed head with nothing set
+    auto& binding = head.bindings.last();
+    auto  state   = head.state;
+    zwlr_output_head_v1_send_name(resource, state.name.toUtf8().constData());
+    zwlr_output_head_v1_send_description(resource, state.description.toUtf8().constData());
+    sendModes(head, binding);
+    zwlr_output_head_v1_send_enabled(resource, state.enabled ? 1 : 0);
+    if (state.enabled) {
+      if (state.current_mode >= 0 && state.current_mode < binding.modes.size()) {
+        zwlr_output_head_v1_send_current_mode(resource, binding.modes.at(state.current_mode));
+      }
+      zwlr_output_head_v1_send_position(resource, state.position.x(), state.position.y());
+      zwlr_output_head_v1_send_transform(resource, state.transform);
+      zwlr_output_head_v1_send_scale(resource, wl_fixed_from_double(state.scale));
+    }
+
+    if (version >= ZWLR_OUTPUT_HEAD_V1_MAKE_SINCE_VERSION) {
+      if (!state.make.isEmpty()) zwlr_output_head_v1_send_make(resource, state.make.toUtf8().constData());
+      if (!state.model.isEmpty()) zwlr_output_head_v1_send_model(resource, state.model.toUtf8().constData());
+      if (!state.serial.isEmpty()) zwlr_output_head_v1_send_serial_number(resource, state.serial.toUtf8().constData());
+    }
+
+    if (state.enabled && version >= ZWLR_OUTPUT_HEAD_V1_ADAPTIVE_SYNC_SINCE_VERSION) {
+      zwlr_output_head_v1_send_adaptive_sync(resource, state.adaptive_sync);
+    }
+  }
+
+  void MockOutputManagementServer::sendModes(Head& head, HeadBinding& binding) {
+    auto client = wl_resource_get_client(binding.head);
+    binding.modes.clear();
+
+    for (const auto& mode : head.state.modes) {
+      auto resource = wl_resource_create(client, &zwlr_output_mode_v1_interface, wl_resource_get_version(binding.head), 0);
+      if (resource == nullptr) {
+        wl_client_post_no_memory(client);
+        return;
+      }
+
+      wl_resource_set_implementation(resource, &s_mode_implementation, this, destroyMode);
+      m_live_modes++;
+      binding.modes.append(resource);
+      zwlr_output_head_v1_send_mode(binding.head, resource);
+      zwlr_output_mode_v1_send_size(resource, mode.width, mode.height);
+      if (mode.refresh > 0) zwlr_output_mode_v1_send_refresh(resource, mode.refresh);
+      if (mode.preferred) zwlr_output_mode_v1_send_preferred(resource);
+    }
+  }
+
+  // sendChanges sends every bound client the events for whatever differs between previous and the head's current state
+  void MockOutputManagementServer::sendChanges(Head& head, const MockHead& previous) {
+    const auto& state = head.state;
+    for (auto& binding : head.bindings) {
+      auto resource = binding.head;
+      auto version  = wl_resource_get_version(resource);
+
+      if (state.name != previous.name) zwlr_output_head_v1_send_name(resource, state.name.toUtf8().constData());
+      if (state.description != previous.description) {
+        zwlr_output_head_v1_send_description(resource, state.description.toUtf8().constData());
+      }
+
+      auto modes_changed = state.modes != previous.modes;
+      if (modes_changed) {
+        for (const auto& mode : binding.modes) {
+          if (mode != nullptr) zwlr_output_mode_v1_send_finished(mode);
+        }
+        sendModes(head, binding);
+      }
+
+      if (state.enabled != previous.enabled) zwlr_output_head_v1_send_enabled(resource, state.enabled ? 1 : 0);
+      if (state.enabled) {
+        auto current_changed = modes_changed || state.current_mode != previous.current_mode || !previous.enabled;
+        if (current_changed && state.current_mode >= 0 && state.current_mode < binding.modes.size()) {
+          zwlr_output_head_v1_send_current_mode(resource, binding.modes.at(state.current_mode));
+        }
+        if (state.position != previous.position || !previous.enabled) {
+          zwlr_output_head_v1_send_position(resource, state.position.x(), state.position.y());
+        }
+        if (state.transform != previous.transform || !previous.enabled) zwlr_output_head_v1_send_transform(resource, state.transform);
+        if (state.scale != previous.scale || !previous.enabled) zwlr_output_head_v1_send_scale(resource, wl_fixed_from_double(state.scale));
+        if ((state.adaptive_sync != previous.adaptive_sync || !previous.enabled) && version >= ZWLR_OUTPUT_HEAD_V1_ADAPTIVE_SYNC_SINCE_VERSION) {
+          zwlr_output_head_v1_send_adaptive_sync(resource, state.adaptive_sync);
+        }
+      }
+
+      if (version >= ZWLR_OUTPUT_HEAD_V1_MAKE_SINCE_VERSION) {
+        if (state.make != previous.make) zwlr_output_head_v1_send_make(resource, state.make.toUtf8().constData());
+        if (state.model != previous.model) zwlr_output_head_v1_send_model(resource, state.model.toUtf8().constData());
+        if (state.serial != previous.serial) zwlr_output_head_v1_send_serial_number(resource, state.serial.toUtf8().constData());
+      }
+    }
+  }
+
+  // finishHead finishes a head and its modes for every client. The resources themselves live on until the client releases them.
+  void MockOutputManagementServer::finishHead(Head& head) {
+    for (const auto& binding : head.bindings) {
+      for (const auto& mode : binding.modes) {
+        if (mode != nullptr) zwlr_output_mode_v1_send_finished(mode);
+      }
+      zwlr_output_head_v1_send_finished(binding.head);
+    }
+    head.bindings.clear();
+  }
+
+  void MockOutputManagementServer::sendDone() {
+    m_serial++;
+    for (const auto& manager : m_managers) zwlr_output_manager_v1_send_done(manager, m_serial);
+  }
+
+  MockOutputManagementServer::Head* MockOutputManagementServer::findHead(quint32 id) {
+    for (auto& head : m_heads) {
+      if (head.id == id) return &head;
+    }
+    return nullptr;
+  }
+
+  MockOutputManagementServer::Head* MockOutputManagementServer::findHeadByResource(wl_resource* resource) {
+    for (auto& head : m_heads) {
+      for (const auto& binding : head.bindings) {
+        if (binding.head == resource) return &head;
+      }
+    }
+    return nullptr;
+  }
+
+  MockOutputManagementServer::Head* MockOutputManagementServer::findHeadByMode(wl_resource* mode, qsizetype* index) {
+    for (auto& head : m_heads) {
+      for (const auto& binding : head.bindings) {
+        auto position = binding.modes.indexOf(mode);
+        if (position < 0) continue;
+        *index = position;
+        return &head;
+      }
+    }
+    return nullptr;
+  }
+
+  // Configuration
+
+  void MockOutputManagementServer::managerCreateConfiguration(wl_client* client, wl_resource* manager, uint32_t id, uint32_t serial) {
+    auto server   = static_cast<MockOutputManagementServer*>(wl_resource_get_user_data(manager));
+    auto resource = wl_resource_create(client, &zwlr_output_configuration_v1_interface, wl_resource_get_version(manager), id);
+    if (resource == nullptr) {
+      wl_client_post_no_memory(client);
+      return;
+    }
+
+    auto configuration = new Configuration {.server = server, .resource = resource, .serial = serial};
+    wl_resource_set_implementation(resource, &s_configuration_implementation, configuration, destroyConfiguration);
+  }
+
+  void MockOutputManagementServer::destroyConfiguration(wl_resource* resource) {
+    auto configuration = static_cast<Configuration*>(wl_resource_get_user_data(resource));
+    if (configuration->timer != nullptr) wl_event_source_remove(configuration->timer);
+    delete configuration;
+  }
+
+  void MockOutputManagementServer::configurationEnableHead(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* head_resource) {
+    auto configuration = static_cast<Configuration*>(wl_resource_get_user_data(resource));
+    auto head          = configuration->server->findHeadByResource(head_resource);
+
+    auto config_head = wl_resource_create(client, &zwlr_output_configuration_head_v1_interface, wl_resource_get_version(resource), id);
+    if (config_head == nullptr) {
+      wl_client_post_no_memory(client);
+      return;
+    }
+
+    auto state    = head != nullptr ? head->state : MockHead {};
+    state.enabled = true;
+    configuration->heads.append(HeadConfiguration {.head_id = head != nullptr ? head->id : 0, .state = state});
+
+    auto data = new ConfigurationHead {.configuration = configuration, .index = configuration->heads.size() - 1};
+    wl_resource_set_implementation(config_head, &s_configuration_head_implementation, data, destroyConfigurationHead);
+  }
+
+  void MockOutputManagementServer::configurationDisableHead(wl_client*, wl_resource* resource, wl_resource* head_resource) {
+    auto configuration = static_cast<Configuration*>(wl_resource_get_user_data(resource));
+    auto head          = configuration->server->findHeadByResource(head_resource);
+    if (head == nullptr) return;
+
+    auto state    = head->state;
+    state.enabled = false;
+    configuration->heads.append(HeadConfiguration {.head_id = head->id, .state = state});
+  }
+
+  void MockOutputManagementServer::configurationApply(wl_client*, wl_resource* resource) {
+    auto configuration = static_cast<Configuration*>(wl_resource_get_user_data(resource));
+    if (configuration->used) {
+      wl_resource_post_error(resource, ZWLR_OUTPUT_CONFIGURATION_V1_ERROR_ALREADY_USED, "configuration has already been used");
+      return;
+    }
+    configuration->used = true;
+
+    auto server = configuration->server;
+    if (server->m_apply_latency.count() <= 0) {
+      server->finishApply(configuration);
+      return;
+    }
+
+    configuration->timer = wl_event_loop_add_timer(server->m_loop, handleApplyTimer, configuration);
+    wl_event_source_timer_update(configuration->timer, static_cast<int>(server->m_apply_latency.count()));
+  }
+
+  // test reports whether the configuration would apply without applying it, which for us is whatever the next apply would do
+  void MockOutputManagementServer::configurationTest(wl_client*, wl_resource* resource) {
+    auto configuration = static_cast<Configuration*>(wl_resource_get_user_data(resource));
+    configuration->used = true;
+
+    auto server = configuration->server;
+    if (configuration->serial != server->m_serial || server->m_apply_outcome == MockApplyOutcome::Cancelled) {
+      zwlr_output_configuration_v1_send_cancelled(resource);
+    } else if (server->m_apply_outcome == MockApplyOutcome::Failed) {
+      zwlr_output_configuration_v1_send_failed(resource);
+    } else {
+      zwlr_output_configuration_v1_send_succeeded(resource);
+    }
+  }
+
+  int MockOutputManagementServer::handleApplyTimer(void* data) {
+    auto configuration = static_cast<Configuration*>(data);
+    wl_event_source_remove(configuration->timer);
+    configuration->timer = nullptr;
+    configuration->server->finishApply(configuration);
+    return 0;
+  }
+
+  void MockOutputManagementServer::finishApply(Configuration* configuration) {
+    m_apply_count++;
+
+    // Something changed since the client created this configuration, it was built against state that no longer exists
+    if (configuration->serial != m_serial || m_apply_outcome == MockApplyOutcome::Cancelled) {
+      zwlr_output_configuration_v1_send_cancelled(configuration->resource);
+      return;
+    }
+
+    if (m_apply_outcome == MockApplyOutcome::Failed) {
+      zwlr_output_configuration_v1_send_failed(configuration->resource);
+      return;
+    }
+
+    for (const auto& configured : configuration->heads) {
+      auto head = findHead(configured.head_id);
+      if (head == nullptr) continue;
+
+      auto previous = head->state;
+      head->state   = configured.state;
+      sendChanges(*head, previous);
+    }
+    sendDone();
+    zwlr_output_configuration_v1_send_succeeded(configuration->resource);
+  }
+
+  MockOutputManagementServer::HeadConfiguration* MockOutputManagementServer::configuredHead(wl_resource* resource) {
+    auto data = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    return &data->configuration->heads[data->index];
+  }
+
+  void MockOutputManagementServer::destroyConfigurationHead(wl_resource* resource) {
+    delete static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+  }
+
+  void MockOutputManagementServer::configurationHeadSetMode(wl_client*, wl_resource* resource, wl_resource* mode) {
+    auto data   = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    auto server = data->configuration->server;
+    auto index  = qsizetype {-1};
+    if (server->findHeadByMode(mode, &index) == nullptr) return;
+    server->configuredHead(resource)->state.current_mode = static_cast<int>(index);
+  }
+
+  // set_custom_mode is recorded as a mode of its own, which is advertised along with the head's other modes once applied
+  void MockOutputManagementServer::configurationHeadSetCustomMode(wl_client*, wl_resource* resource, int32_t width, int32_t height, int32_t refresh) {
+    auto  data     = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    auto& state    = data->configuration->server->configuredHead(resource)->state;
+    auto  custom   = MockMode {.width = width, .height = height, .refresh = refresh};
+    auto  existing = state.modes.indexOf(custom);
+    if (existing < 0) {
+      state.modes.append(custom);
+      existing = state.modes.size() - 1;
+    }
+    state.current_mode = static_cast<int>(existing);
+  }
+
+  void MockOutputManagementServer::configurationHeadSetPosition(wl_client*, wl_resource* resource, int32_t x, int32_t y) {
+    auto data = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    data->configuration->server->configuredHead(resource)->state.position = QPoint {x, y};
+  }
+
+  void MockOutputManagementServer::configurationHeadSetTransform(wl_client*, wl_resource* resource, int32_t transform) {
+    auto data = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    data->configuration->server->configuredHead(resource)->state.transform = transform;
+  }
+
+  void MockOutputManagementServer::configurationHeadSetScale(wl_client*, wl_resource* resource, wl_fixed_t scale) {
+    auto data = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    data->configuration->server->configuredHead(resource)->state.scale = wl_fixed_to_double(scale);
+  }
+
+  void MockOutputManagementServer::configurationHeadSetAdaptiveSync(wl_client*, wl_resource* resource, uint32_t state) {
+    auto data = static_cast<ConfigurationHead*>(wl_resource_get_user_data(resource));
+    data->configuration->server->configuredHead(resource)->state.adaptive_sync = state;
+  }
+}
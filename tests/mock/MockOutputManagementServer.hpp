@@ -0,0 +1,203 @@
+#pragma once
+
+#include <wayland-util.h>
+
+#include <QList>
+#include <QPoint>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct wl_client;
+struct wl_display;
+struct wl_event_loop;
+struct wl_event_source;
+struct wl_global;
+struct wl_resource;
+struct zwlr_output_configuration_head_v1_interface;
+struct zwlr_output_configuration_v1_interface;
+struct zwlr_output_head_v1_interface;
+struct zwlr_output_manager_v1_interface;
+struct zwlr_output_mode_v1_interface;
+
+namespace bd::testing {
+  struct MockMode {
+      int  width     = 0;
+      int  height    = 0;
+      int  refresh   = 0;  // mHz
+      bool preferred = false;
+
+      bool operator==(const MockMode&) const = default;
+  };
+
+  // MockHead is everything the mock compositor advertises for one output. Updating a head only sends the events for what differs, a change to
+  // its modes finishes every old mode and advertises the new ones.
+  struct MockHead {
+      QString         name;
+      QString         description;
+      QString         make;
+      QString         model;
+      QString         serial;
+      QList<MockMode> modes;
+      int             current_mode  = -1;  // Index into modes, -1 for none
+      bool            enabled       = true;
+      QPoint          position      = QPoint {0, 0};
+      int             transform     = 0;
+      double          scale         = 1.0;
+      uint32_t        adaptive_sync = 0;
+
+      bool operator==(const MockHead&) const = default;
+  };
+
+  // makeMockHead returns an enabled 1920x1080 head with a second, smaller mode, identified by serial
+  inline MockHead makeMockHead(const QString& serial, QPoint position = QPoint {0, 0}) {
+    return MockHead {
+        .name         = QString("DP-%1").arg(serial),
+        .description  = QString("Mock output %1").arg(serial),
+        .make         = "Budgie",
+        .model        = "Mock",
+        .serial       = serial,
+        .modes        = {MockMode {1920, 1080, 60000, true}, MockMode {1280, 720, 60000, false}},
+        .current_mode = 0,
+        .position     = position,
+    };
+  }
+
+  enum class MockApplyOutcome { Succeeded, Failed, Cancelled };
+
+  // MockOutputManagementServer is a compositor that only implements zwlr_output_manager_v1 (version 4), running its own wl_display on a thread
+  // of its own. Tests script its heads and modes, choose how an apply turns out and how long it takes, and connect clients to it over a
+  // socketpair. Every public method may be called from any thread, it runs on the server thread and returns once it has been handled there.
+  //
+  // An apply whose serial is older than the last done is always cancelled, like a real compositor would. Otherwise the configured outcome is
+  // sent once the apply latency has passed, and a successful apply first commits the new state of every head it configured (and a done).
+  class MockOutputManagementServer {
+    public:
+      static constexpr uint32_t Version = 4;
+
+      MockOutputManagementServer();
+      ~MockOutputManagementServer();
+
+      // connectClient returns a new client connection to this server, owned by the caller
+      wl_display* connectClient();
+      // addSocket also listens on a named socket in XDG_RUNTIME_DIR, so clients can find us through WAYLAND_DISPLAY. Returns false if it
+      // couldn't be created.
+      bool        addSocket(const QString& name);
+
+      // addHead advertises a head to every bound manager followed by a done, returning the id to update or remove it with
+      quint32  addHead(const MockHead& head);
+      void     updateHead(quint32 id, const MockHead& head);
+      void     removeHead(quint32 id);
+      MockHead head(quint32 id);
+
+      void setApplyLatency(std::chrono::milliseconds latency);
+      void setApplyOutcome(MockApplyOutcome outcome);
+
+      uint32_t serial();
+      int      applyCount();
+      // How many head and mode objects clients still hold, finished objects count until the client releases them
+      int      liveHeadResources();
+      int      liveModeResources();
+
+    private:
+      struct HeadBinding {
+          wl_resource*        manager = nullptr;
+          wl_resource*        head    = nullptr;
+          QList<wl_resource*> modes;  // Parallel to the head's modes, nullptr once the client released one
+      };
+
+      struct Head {
+          quint32            id = 0;
+          MockHead           state;
+          QList<HeadBinding> bindings;
+      };
+
+      struct HeadConfiguration {
+          quint32  head_id = 0;
+          MockHead state;
+      };
+
+      struct Configuration {
+          MockOutputManagementServer* server = nullptr;
+          wl_resource*                resource = nullptr;
+          uint32_t                    serial   = 0;
+          bool                        used     = false;
+          QList<HeadConfiguration>    heads;
+          wl_event_source*            timer = nullptr;
+      };
+
+      struct ConfigurationHead {
+          Configuration* configuration = nullptr;
+          qsizetype      index         = 0;
+      };
+
+      static const struct zwlr_output_manager_v1_interface            s_manager_implementation;
+      static const struct zwlr_output_head_v1_interface               s_head_implementation;
+      static const struct zwlr_output_mode_v1_interface               s_mode_implementation;
+      static const struct zwlr_output_configuration_v1_interface      s_configuration_implementation;
+      static const struct zwlr_output_configuration_head_v1_interface s_configuration_head_implementation;
+
+      static void bindManager(wl_client* client, void* data, uint32_t version, uint32_t id);
+      static int  handleWake(int fd, uint32_t mask, void* data);
+      static int  handleApplyTimer(void* data);
+
+      static void managerCreateConfiguration(wl_client* client, wl_resource* resource, uint32_t id, uint32_t serial);
+      static void managerStop(wl_client* client, wl_resource* resource);
+      static void destroyManager(wl_resource* resource);
+      static void release(wl_client* client, wl_resource* resource);
+      static void destroyHead(wl_resource* resource);
+      static void destroyMode(wl_resource* resource);
+
+      static void configurationEnableHead(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* head);
+      static void configurationDisableHead(wl_client* client, wl_resource* resource, wl_resource* head);
+      static void configurationApply(wl_client* client, wl_resource* resource);
+      static void configurationTest(wl_client* client, wl_resource* resource);
+      static void destroyConfiguration(wl_resource* resource);
+
+      static void configurationHeadSetMode(wl_client* client, wl_resource* resource, wl_resource* mode);
+      static void configurationHeadSetCustomMode(wl_client* client, wl_resource* resource, int32_t width, int32_t height, int32_t refresh);
+      static void configurationHeadSetPosition(wl_client* client, wl_resource* resource, int32_t x, int32_t y);
+      static void configurationHeadSetTransform(wl_client* client, wl_resource* resource, int32_t transform);
+      static void configurationHeadSetScale(wl_client* client, wl_resource* resource, wl_fixed_t scale);
+      static void configurationHeadSetAdaptiveSync(wl_client* client, wl_resource* resource, uint32_t state);
+      static void destroyConfigurationHead(wl_resource* resource);
+
+      void run(const std::function<void()>& task);
+      void loop();
+
+      Head*              findHead(quint32 id);
+      Head*              findHeadByResource(wl_resource* head);
+      Head*              findHeadByMode(wl_resource* mode, qsizetype* index);
+      HeadConfiguration* configuredHead(wl_resource* configuration_head);
+      void               advertiseHead(Head& head, wl_resource* manager);
+      void               sendModes(Head& head, HeadBinding& binding);
+      void               sendChanges(Head& head, const MockHead& previous);
+      void               finishHead(Head& head);
+      void               sendDone();
+      void               finishApply(Configuration* configuration);
+
+      wl_display*      m_display;
+      wl_event_loop*   m_loop;
+      wl_global*       m_global;
+      int              m_wake_fd;
+      std::atomic_bool m_running;
+      std::thread      m_thread;
+
+      std::mutex                   m_tasks_mutex;
+      QList<std::function<void()>> m_tasks;
+
+      // Only touched on the server thread
+      QList<wl_resource*>       m_managers;
+      QList<Head>               m_heads;
+      quint32                   m_next_head_id;
+      uint32_t                  m_serial;
+      std::chrono::milliseconds m_apply_latency;
+      MockApplyOutcome          m_apply_outcome;
+      int                       m_apply_count;
+      int                       m_live_heads;
+      int                       m_live_modes;
+  };
+}
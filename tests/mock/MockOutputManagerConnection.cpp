@@ -0,0 +1,81 @@
+#include "MockOutputManagerConnection.hpp"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cstring>
+#include <thread>
+
+namespace bd::testing {
+  MockOutputManagerConnection::MockOutputManagerConnection(MockOutputManagementServer& server, bool threaded)
+      : m_server(server), m_display(server.connectClient()), m_queue(nullptr), m_event_thread(nullptr), m_done_count(0) {
+    if (threaded) m_queue = wl_display_create_queue(m_display);
+
+    QObject::connect(&m_registry, &WaylandRegistry::interfaceAnnounced, [this](const QByteArray& interface, quint32 name, quint32 version) {
+      if (std::strcmp(interface, QtWayland::zwlr_output_manager_v1::interface()->name) != 0) return;
+      auto bind_version = qMin(version, static_cast<quint32>(QtWayland::zwlr_output_manager_v1::interface()->version));
+      m_manager         = std::make_unique<WaylandOutputManager>(nullptr, &m_registry, name, bind_version, m_queue);
+      QObject::connect(m_manager.get(), &WaylandOutputManager::done, [this]() { m_done_count++; });
+    });
+
+    m_registry.create(m_display);
+    m_registry.setup();
+    wl_display_roundtrip(m_display);
+
+    if (m_queue != nullptr) {
+      m_event_thread = new WaylandEventThread(m_display, m_queue);
+      m_event_thread->start();
+    }
+
+    waitFor([this]() { return m_done_count > 0; });
+  }
+
+  MockOutputManagerConnection::~MockOutputManagerConnection() {
+    if (m_event_thread != nullptr) {
+      m_event_thread->stop();
+      delete m_event_thread;
+    }
+
+    if (m_manager) {
+      m_manager->unbind();
+      m_manager.reset();
+    }
+
+    m_registry.release();
+    if (m_queue != nullptr) wl_event_queue_destroy(m_queue);
+    wl_display_disconnect(m_display);
+  }
+
+  WaylandOutputManager* MockOutputManagerConnection::manager() {
+    return m_manager.get();
+  }
+
+  wl_display* MockOutputManagerConnection::display() {
+    return m_display;
+  }
+
+  int MockOutputManagerConnection::doneCount() const {
+    return m_done_count;
+  }
+
+  bool MockOutputManagerConnection::sync() {
+    wl_display_roundtrip(m_display);
+    auto serial = m_server.serial();
+    return waitFor([this, serial]() { return m_manager && m_manager->getSerial() == serial; });
+  }
+
+  bool MockOutputManagerConnection::waitFor(const std::function<bool()>& condition, std::chrono::milliseconds timeout) {
+    auto timer = QElapsedTimer {};
+    timer.start();
+
+    while (!condition()) {
+      if (timer.elapsed() > timeout.count()) return false;
+
+      // Dispatches the default queue, the event thread (if any) dispatches the manager's queue and hands transactions over to us as queued calls
+      if (wl_display_roundtrip(m_display) < 0) return false;
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+  }
+}
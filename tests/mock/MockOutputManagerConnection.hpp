@@ -0,0 +1,42 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "displays/output-manager/WaylandEventThread.hpp"
+#include "displays/output-manager/WaylandOutputManager.hpp"
+#include "displays/output-manager/WaylandRegistry.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+
+namespace bd::testing {
+  // MockOutputManagerConnection connects a WaylandOutputManager to a MockOutputManagementServer the way the orchestrator connects one to the
+  // compositor, optionally dispatching it on its own queue and thread like BUDGIE_DAEMON_WAYLAND_EVENT_THREAD does. The constructor returns
+  // once the manager has committed the server's initial set of heads.
+  class MockOutputManagerConnection {
+    public:
+      explicit MockOutputManagerConnection(MockOutputManagementServer& server, bool threaded = false);
+      ~MockOutputManagerConnection();
+
+      WaylandOutputManager* manager();
+      wl_display*           display();
+      int                   doneCount() const;
+
+      // sync makes sure the server has handled everything we sent, and that the manager has committed every transaction it sent back. Returns
+      // false if the manager never caught up with the server's serial.
+      bool sync();
+      // waitFor keeps dispatching until condition holds, returning false if it still doesn't after timeout
+      bool waitFor(const std::function<bool()>& condition, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    private:
+      MockOutputManagementServer&           m_server;
+      wl_display*                           m_display;
+      wl_event_queue*                       m_queue;
+      WaylandEventThread*                   m_event_thread;
+      WaylandRegistry                       m_registry;
+      std::unique_ptr<WaylandOutputManager> m_manager;
+      int                                   m_done_count;
+  };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QString>
+#include <functional>
+
+#include "displays/output-manager/WaylandProtocolRecorder.hpp"
+#include "mock/MockOutputManagementServer.hpp"
+#include "mock/MockOutputManagerConnection.hpp"
+
+namespace bd::testing {
+  // recordAgainstMock records everything a manager connected to server receives into a protocol log at path: the initial heads, then whatever
+  // script makes the server send. Returns false if the log couldn't be opened or the manager lost track of the server.
+  inline bool recordAgainstMock(const QString& path, MockOutputManagementServer& server,
+                                const std::function<bool(MockOutputManagementServer&, MockOutputManagerConnection&)>& script) {
+    auto& recorder = WaylandProtocolRecorder::instance();
+    if (!recorder.start(path)) return false;
+
+    auto recorded = false;
+    {
+      auto connection = MockOutputManagerConnection(server);
+      recorded        = script(server, connection) && connection.sync();
+    }
+
+    recorder.stop();
+    return recorded;
+  }
+}